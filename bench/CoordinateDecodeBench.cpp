@@ -0,0 +1,96 @@
+// Compares decoding a flood area polygon through the DOM with scanning its text directly.
+//
+// Runs on a synthetic area by default, or on a recorded polygon body:
+//   coordinate_decode_bench [fixtures/N.body] [iterations]
+#include "CoordinateDecoder.hpp"
+#include "Warning.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// A feature collection shaped like the flood area API's, with one large ring per polygon
+std::string syntheticArea(int polygons, int pointsPerRing) {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> jitter(-0.01, 0.01);
+  std::ostringstream out;
+  out.precision(15);
+  out << R"({"type": "FeatureCollection", "features": [{"type": "Feature", "properties": {},)"
+      << R"( "geometry": {"type": "MultiPolygon", "coordinates": [)";
+  for (int p = 0; p < polygons; ++p) {
+    out << (p > 0 ? ", " : "") << "[[";
+    for (int i = 0; i < pointsPerRing; ++i) {
+      out << (i > 0 ? ", " : "") << '[' << -1.5 + jitter(rng) << ", " << 52.5 + jitter(rng)
+          << ']';
+    }
+    out << "]]";
+  }
+  out << "]}}]}";
+  return out.str();
+}
+
+template <typename Decode> double bestMs(size_t iterations, size_t& points, Decode decode) {
+  double best = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    points = decode();
+    double ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (i == 0 || ms < best) {
+      best = ms;
+    }
+  }
+  return best;
+}
+
+void report(const char* label, double ms, size_t points, size_t bytes) {
+  double mbPerSecond = static_cast<double>(bytes) / 1e6 / (ms / 1000.0);
+  std::cout << label << ": " << ms << " ms, " << mbPerSecond << " MB/s, " << points
+            << " points\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::string body;
+  if (argc > 1) {
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+      std::cerr << "Cannot read " << argv[1] << '\n';
+      return 1;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    body = contents.str();
+  } else {
+    body = syntheticArea(20, 10000);
+  }
+
+  // Padded like a fetched body so the DOM parser does not have to copy it
+  body.reserve(body.size() + simdjson::SIMDJSON_PADDING);
+  size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+  std::cout << body.size() << " bytes, best of " << iterations << "\n";
+
+  size_t points = 0;
+  simdjson::dom::parser domParser;
+  double domMs = bestMs(iterations, points, [&]() -> size_t {
+    simdjson::dom::element geometry;
+    if (domParser.parse(body)["features"].at(0)["geometry"].get(geometry) != simdjson::SUCCESS) {
+      return 0;
+    }
+    return Warning::parseGeoJsonPolygon(geometry).pointCount();
+  });
+  report("dom", domMs, points, body.size());
+
+  double scanMs = bestMs(iterations, points, [&]() -> size_t {
+    FlatMultiPolygon polygon;
+    return decodeFeatureGeometry(body, polygon) ? polygon.pointCount() : 0;
+  });
+  report("scanner", scanMs, points, body.size());
+  return 0;
+}
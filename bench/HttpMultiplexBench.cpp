@@ -0,0 +1,104 @@
+// Compares fetchUrls with and without HTTP/2 multiplexing against a local stand-in server.
+//
+// Serve polygon-sized files named 0..N-1 over HTTP/2, for example with nghttp2 and a
+// self-signed certificate for 127.0.0.1:
+//   mkdir -p polygons
+//   for i in $(seq 0 499); do head -c 15000 /dev/urandom | base64 > polygons/$i; done
+//   nghttpd -d polygons 8443 key.pem cert.pem
+// then run:
+//   CURL_CA_BUNDLE=cert.pem http_multiplex_bench https://127.0.0.1:8443/ 500
+// The URL prefix can also come from FLOODWATCHER_BENCH_H2_URL, which is how the CTest entry
+// finds it. Without a server the bench reports why and exits with SKIPPED.
+#include "HttpClient.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <curl/curl.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Exit code CTest counts as a skip rather than a failure
+constexpr int SKIPPED = 77;
+
+// Why the bench cannot run against prefix, empty if it can
+std::string skipReason(const std::string& prefix) {
+  const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+  if ((info->features & CURL_VERSION_HTTP2) == 0) {
+    return "libcurl was built without HTTP/2";
+  }
+  HttpClient client;
+  if (!client.fetchUrl(prefix + "0")) {
+    return "nothing is served at " + prefix + "0";
+  }
+  return {};
+}
+
+struct RunStats {
+    double wallMs = 0;
+    size_t connections = 0;
+    size_t failures = 0;
+};
+
+RunStats run(const std::vector<std::string>& urls, const FetchOptions& options) {
+  // Fresh client per run so neither mode starts with warm connections
+  HttpClient client;
+
+  RunStats stats;
+  auto start = std::chrono::steady_clock::now();
+  client.fetchUrls(
+      urls,
+      [&stats](size_t /*index*/, std::optional<std::string> body) {
+        if (!body) {
+          stats.failures++;
+        }
+      },
+      options);
+  stats.wallMs =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  stats.connections = client.getConnectionsOpened();
+  return stats;
+}
+
+void report(const char* label, const RunStats& stats) {
+  std::cout << label << ": " << stats.wallMs << " ms, " << stats.connections << " connections, "
+            << stats.failures << " failures\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const char* fromEnv = std::getenv("FLOODWATCHER_BENCH_H2_URL"); // NOLINT(concurrency-mt-unsafe)
+  if (argc < 2 && (fromEnv == nullptr || *fromEnv == '\0')) {
+    std::cerr << "Skipping: no HTTP/2 server given, pass a URL prefix or set "
+                 "FLOODWATCHER_BENCH_H2_URL (see the top of HttpMultiplexBench.cpp)\n"
+              << "Usage: " << argv[0] << " <url-prefix> [count] [streams]\n";
+    return SKIPPED;
+  }
+
+  std::string prefix = argc > 1 ? argv[1] : fromEnv;
+  std::string reason = skipReason(prefix);
+  if (!reason.empty()) {
+    std::cerr << "Skipping: " << reason << '\n';
+    return SKIPPED;
+  }
+  size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 500;
+  long streams = argc > 3 ? std::strtol(argv[3], nullptr, 10) : 0;
+
+  std::vector<std::string> urls;
+  urls.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    urls.push_back(prefix + std::to_string(i));
+  }
+
+  FetchOptions current;
+  report("current", run(urls, current));
+
+  FetchOptions multiplexed;
+  multiplexed.http2Multiplex = true;
+  multiplexed.maxConcurrentStreams = streams;
+  report("http2 multiplex", run(urls, multiplexed));
+
+  return 0;
+}
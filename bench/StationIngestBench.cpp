@@ -0,0 +1,77 @@
+// Compares the DOM and On-Demand stations parsers on a recorded full-catalogue response.
+//
+// Record one with FLOODWATCHER_RECORD_DIR, find the stations body in its index.tsv, then run:
+//   station_ingest_bench fixtures/0.body [iterations]
+#include "MonitoringData.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+struct RunStats {
+    double bestMs = 0;
+    size_t stations = 0;
+};
+
+template <typename Parse> RunStats run(size_t iterations, Parse parse) {
+  RunStats stats;
+  for (size_t i = 0; i < iterations; ++i) {
+    MonitoringData data;
+    auto start = std::chrono::steady_clock::now();
+    parse(data);
+    double ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (i == 0 || ms < stats.bestMs) {
+      stats.bestMs = ms;
+    }
+    stats.stations = data.getStations().size();
+  }
+  return stats;
+}
+
+void report(const char* label, const RunStats& stats, size_t bytes) {
+  double mbPerSecond = static_cast<double>(bytes) / 1e6 / (stats.bestMs / 1000.0);
+  std::cout << label << ": " << stats.bestMs << " ms, " << mbPerSecond << " MB/s, "
+            << stats.stations << " stations\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <stations-body> [iterations]\n";
+    return 1;
+  }
+
+  std::ifstream file(argv[1], std::ios::binary);
+  if (!file) {
+    std::cerr << "Cannot read " << argv[1] << '\n';
+    return 1;
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+
+  // Padded like a fetched body so neither parser has to copy it
+  std::string body = contents.str();
+  body.reserve(body.size() + simdjson::SIMDJSON_PADDING);
+  size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+
+  std::cout << body.size() << " bytes, best of " << iterations << "\n";
+
+  simdjson::dom::parser parser;
+  report("dom", run(iterations, [&](MonitoringData& data) {
+           simdjson::dom::element root;
+           if (parser.parse(body).get(root) == simdjson::SUCCESS) {
+             data.parseStations(root);
+           }
+         }),
+         body.size());
+  report("on-demand",
+         run(iterations, [&](MonitoringData& data) { data.parseStationsOnDemand(body); }),
+         body.size());
+  return 0;
+}
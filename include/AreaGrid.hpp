@@ -0,0 +1,44 @@
+#pragma once
+#include "AreaMesh.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Coarse uniform grid over the bounds of a set of areas, so a point lookup only tests the few
+// areas whose bounds overlap the point's cell rather than all of them
+class AreaGrid {
+  public:
+    static constexpr int CELLS = 32; // Per side, over the extent of all the bounds
+
+    AreaGrid() = default;
+    // Area i has bounds[i], null for one with nothing to hit
+    explicit AreaGrid(const std::vector<const AreaMesh::Bounds*>& bounds);
+
+    // Lowest area index under the point for which hit(index) holds, -1 if there is none. Only
+    // areas whose bounds hold the point are offered to hit.
+    template <typename Hit> int find(double x, double y, Hit&& hit) const {
+      auto [first, last] = cell(x, y);
+      for (uint32_t i = first; i < last; ++i) {
+        uint32_t area = cellAreas_[i];
+        if (bounds_[area].contains(x, y) && hit(area)) {
+          return static_cast<int>(area);
+        }
+      }
+      return -1;
+    }
+
+  private:
+    AreaMesh::Bounds extent_;
+    double cellWidth_ = 0.0;
+    double cellHeight_ = 0.0;
+    std::vector<AreaMesh::Bounds> bounds_;
+    // Areas of cell c are cellAreas_[cellStarts_[c]] up to cellAreas_[cellStarts_[c + 1]], each
+    // list ascending
+    std::vector<uint32_t> cellStarts_;
+    std::vector<uint32_t> cellAreas_;
+
+    // Range of cellAreas_ for the cell under a point, empty outside the grid
+    std::pair<uint32_t, uint32_t> cell(double x, double y) const;
+    // Cells covered between two coordinates along one axis, clamped to the grid
+    static std::pair<int, int> cellSpan(double from, double to, double origin, double cellSize);
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include "GeometryLod.hpp"
+#include "GeometryTypes.hpp"
+#include "PolygonStore.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A flood area as the map layer draws it: projected to Web Mercator pixels at zoom 0 around a
+// fixed origin, then triangulated and outlined at every level of detail. Built off the GUI
+// thread once per geometry, so a model update on the GUI thread only merges areas into meshes.
+class AreaMesh {
+  public:
+    struct Bounds {
+        double minX = 0.0;
+        double minY = 0.0;
+        double maxX = 0.0;
+        double maxY = 0.0;
+
+        bool contains(double x, double y) const {
+          return x >= minX && x <= maxX && y >= minY && y <= maxY;
+        }
+    };
+
+    // The area at one level of detail, indices count the shape's points ring after ring
+    struct Level {
+        FlatMultiPolygon shape;
+        Bounds bounds;
+        std::vector<uint32_t> triangles; // Three corners each
+        std::vector<uint32_t> outlines;  // Two ends of each ring edge
+    };
+
+    // Without simplified levels every zoom shares one full detail level
+    explicit AreaMesh(SharedGeometry source);
+
+    const SharedGeometry& source() const {
+      return source_;
+    }
+    // Level index as GeometryLod::levelForZoom counts them
+    const Level& level(int level) const {
+      return levels_.size() == 1 ? levels_[0] : levels_[level];
+    }
+    // Even-odd test at a level, in projected pixels, so points in holes are outside
+    bool contains(int level, double x, double y) const;
+
+    // Pixels at zoom 0 from the origin, y growing southwards like the screen
+    static std::pair<double, double> project(double lon, double lat);
+
+  private:
+    SharedGeometry source_; // Held, so the polygon's address cannot pass to another area
+    std::vector<Level> levels_;
+
+    static Level buildLevel(const FlatMultiPolygon& geometry);
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include "GeometryTypes.hpp"
+#include <cstdint>
+#include <string_view>
+
+// How deeply a GeoJSON geometry nests its positions
+enum class GeometryKind : uint8_t { POLYGON, MULTI_POLYGON };
+
+// Decodes features[0].geometry of a FeatureCollection straight from its raw text in one pass,
+// never materialising JSON values or reading past the coordinates. Returns false when the
+// document has another shape, is not well formed along the way, or the geometry is not a
+// Polygon or MultiPolygon whose type comes before its coordinates. Callers then discard out and
+// fall back to a full parser for the verdict.
+bool decodeFeatureGeometry(std::string_view document, FlatMultiPolygon& out);
+// As above for the text of a geometry object on its own
+bool decodeGeometry(std::string_view object, FlatMultiPolygon& out);
+
+// Decodes the text of a coordinates array straight into flat geometry, never materialising
+// JSON values. Like the DOM parser it skips rings and polygons that are not arrays and
+// positions that do not start with two numbers. Returns false if the text is not well formed,
+// out is then incomplete.
+bool decodeCoordinates(std::string_view json, GeometryKind kind, FlatMultiPolygon& out);
@@ -0,0 +1,37 @@
+#pragma once
+#include "GeometryTypes.hpp"
+#include <array>
+
+// Simplified copies of a flood area for each whole map zoom, so the map is never handed detail
+// finer than half a pixel. Built once per polygon, off the GUI thread.
+class GeometryLod {
+  public:
+    // The zoom range of MapArea.qml, minZoom 6.125 to maxZoom 15
+    static constexpr int MIN_ZOOM = 6;
+    static constexpr int MAX_ZOOM = 15;
+    static constexpr int LEVELS = MAX_ZOOM - MIN_ZOOM + 1;
+
+    explicit GeometryLod(const FlatMultiPolygon& source);
+
+    const FlatMultiPolygon& forZoom(double zoom) const {
+      return levels_[levelForZoom(zoom)];
+    }
+
+    // Index into the levels for a fractional zoom, clamped to the range
+    static int levelForZoom(double zoom);
+    // Longitude degrees spanned by half a 256 px tile pixel at the zoom
+    static double toleranceForZoom(int zoom);
+
+    // Douglas-Peucker on every ring, with latitude stretched as Mercator does locally. Geometry
+    // whose simplified edges would cross, or touch where the source's do not, is retried at
+    // finer tolerances, then kept as it was.
+    static FlatMultiPolygon simplify(const FlatMultiPolygon& source, double tolerance);
+    // True if two non-adjacent edges anywhere in the geometry, parts included, touch or cross
+    static bool hasCrossings(const FlatMultiPolygon& geometry);
+    // True if simplified has edges that cross, or that touch at a point where no two of the
+    // source's non-adjacent edges do, such as a hole meeting its shell at a shared vertex
+    static bool addsContacts(const FlatMultiPolygon& simplified, const FlatMultiPolygon& source);
+
+  private:
+    std::array<FlatMultiPolygon, LEVELS> levels_;
+};
@@ -1,5 +1,10 @@
 #pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -12,5 +17,275 @@ using LinearRing = std::vector<Coordinate>;
 // A polygon can have multiple rings (exterior ring + interior holes)
 using MyPolygon = std::vector<LinearRing>;
 
-// MultiPolygon for complex flood areas with multiple disconnected polygons
+// MultiPolygon for complex flood areas with multiple disconnected polygons. Nested, so handy for
+// literals, but stored geometry uses the flat form below.
 using MultiPolygon = std::vector<MyPolygon>;
+
+// How a coordinate in degrees is held in a flat geometry's buffer
+template <typename Scalar> struct CoordinateCodec {
+    static Scalar encode(double degrees) {
+      return static_cast<Scalar>(degrees);
+    }
+    static double decode(Scalar stored) {
+      return static_cast<double>(stored);
+    }
+};
+
+// Fixed point in 1e-7 degree steps (about 1 cm), +-180 degrees still fits in 32 bits
+template <> struct CoordinateCodec<int32_t> {
+    static constexpr double SCALE = 1e7;
+
+    static int32_t encode(double degrees) {
+      return static_cast<int32_t>(std::lround(degrees * SCALE));
+    }
+    static double decode(int32_t stored) {
+      return static_cast<double>(stored) / SCALE;
+    }
+};
+
+// Random access over a view's elements by index, dereferencing builds the element on the fly.
+// Container is held by value, a small view or a pointer, so iterators outlive temporary views.
+template <typename Container, typename Value> class IndexIterator {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Value;
+
+    IndexIterator() = default;
+    IndexIterator(Container container, size_t index) : container_(container), index_(index) {}
+
+    Value operator*() const {
+      return at(index_);
+    }
+    Value operator[](difference_type offset) const {
+      return at(index_ + offset);
+    }
+    IndexIterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    IndexIterator operator++(int) {
+      IndexIterator old = *this;
+      ++index_;
+      return old;
+    }
+    IndexIterator& operator--() {
+      --index_;
+      return *this;
+    }
+    IndexIterator operator--(int) {
+      IndexIterator old = *this;
+      --index_;
+      return old;
+    }
+    IndexIterator& operator+=(difference_type offset) {
+      index_ += offset;
+      return *this;
+    }
+    IndexIterator& operator-=(difference_type offset) {
+      index_ -= offset;
+      return *this;
+    }
+    friend IndexIterator operator+(IndexIterator it, difference_type offset) {
+      return it += offset;
+    }
+    friend IndexIterator operator-(IndexIterator it, difference_type offset) {
+      return it -= offset;
+    }
+    friend difference_type operator-(const IndexIterator& a, const IndexIterator& b) {
+      return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+    }
+    friend bool operator==(const IndexIterator& a, const IndexIterator& b) {
+      return a.index_ == b.index_;
+    }
+    friend bool operator!=(const IndexIterator& a, const IndexIterator& b) {
+      return a.index_ != b.index_;
+    }
+    friend bool operator<(const IndexIterator& a, const IndexIterator& b) {
+      return a.index_ < b.index_;
+    }
+
+  private:
+    Container container_{};
+    size_t index_ = 0;
+
+    Value at(size_t index) const {
+      if constexpr (std::is_pointer_v<Container>) {
+        return (*container_)[index];
+      } else {
+        return container_[index];
+      }
+    }
+};
+
+// A multipolygon in three arrays instead of nested vectors: every coordinate in one interleaved
+// lon/lat buffer, each ring as an offset into it and each polygon as an offset into the rings.
+// Empty rings and polygons are dropped as they are closed, like the GeoJSON parser always did.
+template <typename Scalar> class BasicFlatMultiPolygon {
+    using Codec = CoordinateCodec<Scalar>;
+
+  public:
+    class Ring {
+      public:
+        using iterator = IndexIterator<Ring, Coordinate>;
+
+        Ring() = default;
+        Ring(const BasicFlatMultiPolygon* owner, size_t begin, size_t end)
+            : owner_(owner), begin_(begin), end_(end) {}
+
+        size_t size() const {
+          return end_ - begin_;
+        }
+        bool empty() const {
+          return begin_ == end_;
+        }
+        Coordinate operator[](size_t i) const {
+          return owner_->point(begin_ + i);
+        }
+        iterator begin() const {
+          return {*this, 0};
+        }
+        iterator end() const {
+          return {*this, size()};
+        }
+        // Interleaved lon/lat values, 2 * size() of them
+        const Scalar* data() const {
+          return owner_->coords_.data() + (2 * begin_);
+        }
+
+      private:
+        const BasicFlatMultiPolygon* owner_ = nullptr;
+        size_t begin_ = 0;
+        size_t end_ = 0;
+    };
+
+    class Polygon {
+      public:
+        using iterator = IndexIterator<Polygon, Ring>;
+
+        Polygon() = default;
+        Polygon(const BasicFlatMultiPolygon* owner, size_t begin, size_t end)
+            : owner_(owner), begin_(begin), end_(end) {}
+
+        size_t size() const {
+          return end_ - begin_;
+        }
+        bool empty() const {
+          return begin_ == end_;
+        }
+        // Ring 0 is the exterior, the rest are holes
+        Ring operator[](size_t i) const {
+          return owner_->ring(begin_ + i);
+        }
+        iterator begin() const {
+          return {*this, 0};
+        }
+        iterator end() const {
+          return {*this, size()};
+        }
+
+      private:
+        const BasicFlatMultiPolygon* owner_ = nullptr;
+        size_t begin_ = 0;
+        size_t end_ = 0;
+    };
+
+    using iterator = IndexIterator<const BasicFlatMultiPolygon*, Polygon>;
+
+    BasicFlatMultiPolygon() = default;
+
+    // Implicit, so nested literals can be used wherever flat geometry is expected
+    BasicFlatMultiPolygon(const MultiPolygon& nested) { // NOLINT(google-explicit-constructor)
+      for (const auto& polygon : nested) {
+        for (const auto& ring : polygon) {
+          for (const auto& [lon, lat] : ring) {
+            addPoint(lon, lat);
+          }
+          closeRing();
+        }
+        closePolygon();
+      }
+    }
+
+    // Building: add a ring's points, close the ring, and close the polygon after its last ring
+    void addPoint(double lon, double lat) {
+      coords_.push_back(Codec::encode(lon));
+      coords_.push_back(Codec::encode(lat));
+    }
+    void closeRing() {
+      if (pointCount() > ringOffsets_.back()) {
+        ringOffsets_.push_back(static_cast<uint32_t>(pointCount()));
+      }
+    }
+    void closePolygon() {
+      if (ringCount() > polygonOffsets_.back()) {
+        polygonOffsets_.push_back(static_cast<uint32_t>(ringCount()));
+      }
+    }
+    void reservePoints(size_t points) {
+      coords_.reserve(2 * points);
+    }
+    void reserveRings(size_t rings) {
+      ringOffsets_.reserve(rings + 1);
+    }
+    void reservePolygons(size_t polygons) {
+      polygonOffsets_.reserve(polygons + 1);
+    }
+
+    size_t size() const {
+      return polygonOffsets_.size() - 1;
+    }
+    bool empty() const {
+      return size() == 0;
+    }
+    Polygon operator[](size_t i) const {
+      return {this, polygonOffsets_[i], polygonOffsets_[i + 1]};
+    }
+    iterator begin() const {
+      return {this, 0};
+    }
+    iterator end() const {
+      return {this, size()};
+    }
+
+    size_t ringCount() const {
+      return ringOffsets_.size() - 1;
+    }
+    size_t pointCount() const {
+      return coords_.size() / 2;
+    }
+    Ring ring(size_t i) const {
+      return {this, ringOffsets_[i], ringOffsets_[i + 1]};
+    }
+    Coordinate point(size_t i) const {
+      return {Codec::decode(coords_[2 * i]), Codec::decode(coords_[(2 * i) + 1])};
+    }
+
+    // Heap bytes held by the three buffers
+    size_t memoryBytes() const {
+      return (coords_.capacity() * sizeof(Scalar)) +
+             ((ringOffsets_.capacity() + polygonOffsets_.capacity()) * sizeof(uint32_t));
+    }
+
+    friend bool operator==(const BasicFlatMultiPolygon& a, const BasicFlatMultiPolygon& b) {
+      return a.coords_ == b.coords_ && a.ringOffsets_ == b.ringOffsets_ &&
+             a.polygonOffsets_ == b.polygonOffsets_;
+    }
+    friend bool operator!=(const BasicFlatMultiPolygon& a, const BasicFlatMultiPolygon& b) {
+      return !(a == b);
+    }
+
+  private:
+    std::vector<Scalar> coords_;
+    std::vector<uint32_t> ringOffsets_{0};    // Ring i spans points [i], [i + 1]
+    std::vector<uint32_t> polygonOffsets_{0}; // Polygon i spans rings [i], [i + 1]
+};
+
+// Full precision, what warnings store
+using FlatMultiPolygon = BasicFlatMultiPolygon<double>;
+// Half the memory, better than half a metre of precision at UK latitudes
+using FlatMultiPolygonF = BasicFlatMultiPolygon<float>;
+// Half the memory at uniform centimetre precision
+using FixedMultiPolygon = BasicFlatMultiPolygon<int32_t>;
@@ -1,11 +1,18 @@
 #pragma once
+#include "HttpMetrics.hpp"
 #include "IHttpClient.hpp"
+#include "ResponseBuffer.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <curl/curl.h>
 #include <deque>
 #include <mutex>
 #include <optional>
+#include <random>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -21,21 +28,47 @@ class HttpClient : public IHttpClient {
     // Fetch URL using connection reuse
     std::optional<std::string> fetchUrl(const std::string& url) override;
 
+    // Conditional GET using the ETag/Last-Modified remembered for this URL
+    FetchResult fetchUrlIfModified(const std::string& url) override;
+
     // Fetch multiple URLs concurrently using multi interface
-    std::vector<std::optional<std::string>> fetchUrls(const std::vector<std::string>& urls);
+    std::vector<std::optional<std::string>>
+    fetchUrls(const std::vector<std::string>& urls) override;
+
+    // As above, but hands each result to onComplete as soon as its transfer finishes
+    void fetchUrls(const std::vector<std::string>& urls, const CompletionHandler& onComplete,
+                   const FetchOptions& options) override;
+
+    // Queue a fetch on the shared network thread, started on first use
+    void fetchAsync(const std::string& url, bool ifModified, ResultHandler onComplete) override;
+    void fetchAsync(const std::string& url, const CacheValidators& validators,
+                    ResultHandler onComplete) override;
+
+    // Delay before the retry that follows `attempt` tries, jitter in [0, 1) picks a point in
+    // the upper half of the exponential window
+    static std::chrono::milliseconds backoffDelay(const RetryPolicy& policy, int attempt,
+                                                  double jitter);
+
+    // New connections opened by finished transfers since construction
+    size_t getConnectionsOpened() const {
+      return connectionsOpened_;
+    }
 
     // Get singleton instance
     static IHttpClient& getInstance();
     static void setInstance(IHttpClient* instance);
 
   private:
-    // RAII wrapper for CURL handle with automatic return to pool
+    // RAII wrapper for CURL handle with automatic return to pool, handles without a client
+    // are not pooled and are cleaned up instead
     class CurlHandle {
       public:
         CurlHandle(CURL* handle, HttpClient* client) : handle_(handle), client_(client) {}
         ~CurlHandle() {
           if (handle_ && client_) {
             client_->returnHandle(handle_);
+          } else if (handle_) {
+            curl_easy_cleanup(handle_);
           }
         }
 
@@ -55,12 +88,33 @@ class HttpClient : public IHttpClient {
         HttpClient* client_;
     };
 
+    // A borrowed pool handle that fetchUrls reuses for successive URLs
     struct MultiRequest {
-        CURL* handle;
-        std::string buffer;
-        size_t index;
+        CurlHandle handle;
+        ResponseBuffer buffer;
+        size_t index = 0;
+        bool active = false;
+        std::chrono::steady_clock::time_point started;
+    };
+
+    // A transfer owned by the network thread
+    struct AsyncRequest {
+        std::string url;
+        bool ifModified = false;
+        CacheValidators sent; // Used when ifModified is set
+        ResultHandler onComplete;
+        ResponseBuffer buffer;
+        CacheValidators received;
+        curl_slist* headers = nullptr;
     };
 
+    // Matches libcurl's own default stream limit
+    static constexpr long DEFAULT_CONCURRENT_STREAMS = 100;
+
+    // Hedging thresholds come from this many recent batch transfers, once there are enough
+    static constexpr size_t LATENCY_SAMPLES = 256;
+    static constexpr size_t MIN_LATENCY_SAMPLES = 20;
+
     // Pool management
     std::deque<CURL*> availableHandles_;
     std::mutex poolMutex_;
@@ -69,15 +123,79 @@ class HttpClient : public IHttpClient {
     size_t createdHandles_;
     size_t inUseHandles_;
 
+    // DNS and TLS session caches shared by every handle of this client
+    CURLSH* share_;
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> shareMutexes_;
+
+    // Cache validators from the last 200 response per URL
+    std::unordered_map<std::string, CacheValidators> validators_;
+    std::mutex validatorsMutex_;
+
+    std::atomic<size_t> connectionsOpened_;
+    std::string caBundle_;
+
+    // Long-lived multi handle so fetchUrls keeps its connection cache between batches
+    CURLM* multiHandle_;
+    std::mutex multiMutex_;
+
+    // Batch latency history and retry jitter, guarded by multiMutex_
+    std::vector<std::chrono::milliseconds> latencies_;
+    size_t nextLatency_ = 0;
+    std::mt19937 jitterRng_;
+    void recordLatency(std::chrono::milliseconds latency);
+    std::optional<std::chrono::milliseconds> latencyPercentile(double percentile) const;
+
+    // Network thread multiplexing every asynchronous request on one multi handle
+    std::thread loopThread_;
+    CURLM* loopMulti_;
+    std::deque<std::unique_ptr<AsyncRequest>> loopQueue_;
+    std::mutex loopMutex_;
+    std::once_flag loopStartFlag_;
+    bool loopStopping_;
+
+    void runEventLoop();
+    void stopEventLoop();
+
     // Get handle from pool
     CurlHandle acquireHandle();
+    std::optional<CurlHandle> tryAcquireHandle();
+    CURL* createHandle();
     void returnHandle(CURL* handle);
 
     // Set common options that persist across requests
-    static void applyPersistentOptions(CURL* curl);
+    void applyPersistentOptions(CURL* curl) const;
+
+    // Transport errors, 408, 429 and 5xx are worth retrying, anything else will fail again
+    static bool isTransientFailure(CURL* curl, CURLcode result);
+
+    // Count connections and feed the timing breakdown into HttpMetrics
+    void recordTransfer(CURL* curl, CURLcode result, const std::string& url);
+
+    // Turn a finished transfer into a body, logging failures
+    std::optional<std::string> finishTransfer(CURL* curl, CURLcode result, const std::string& url,
+                                              ResponseBuffer& buffer);
+
+    // Hand a request to the network thread, starting it on first use
+    void queueAsync(std::unique_ptr<AsyncRequest> request);
+
+    // Conditional GET helpers shared by the blocking and asynchronous paths
+    CacheValidators rememberedValidators(const std::string& url);
+    static curl_slist* conditionalHeaders(const CacheValidators& validators);
+    FetchResult finishConditional(CURL* curl, CURLcode result, const std::string& url,
+                                  ResponseBuffer& buffer, CacheValidators& received);
+    static void clearConditionalOptions(CURL* curl);
+
+    // Share lock callbacks
+    static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access,
+                          void* userptr);
+    static void unlockShare(CURL* handle, curl_lock_data data, void* userptr);
 
     // Write callback as member function
-    static size_t writeCallback(void* contents, size_t size, size_t nmemb, std::string* userp);
+    static size_t writeCallback(void* contents, size_t size, size_t nmemb, ResponseBuffer* userp);
+
+    // Header callback that picks out ETag and Last-Modified
+    static size_t headerCallback(char* buffer, size_t size, size_t nitems,
+                                 CacheValidators* userp);
 
     // Global curl initialization
     static void initCurl();
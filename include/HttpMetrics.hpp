@@ -0,0 +1,107 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+
+// Endpoints we talk to, each gets its own set of histograms
+enum class UrlClass : uint8_t { STATIONS, FLOODS, POLYGON, MEASURES, OTHER, COUNT };
+
+// Where a request spent its time, derived from libcurl's cumulative timers
+enum class TimingPhase : uint8_t { DNS, CONNECT, TLS, FIRST_BYTE, TRANSFER, TOTAL, COUNT };
+
+// Timing breakdown and sizes of one finished request, times in microseconds
+struct RequestTiming {
+    std::array<uint64_t, static_cast<size_t>(TimingPhase::COUNT)> phases{};
+    bool tls = false; // TLS phase is only meaningful for a new HTTPS connection
+    uint64_t bytesDown = 0;
+    uint64_t bytesUp = 0;
+    bool failed = false;
+};
+
+// Log2 bucketed histogram that writers update with relaxed atomics, no locks
+class LatencyHistogram {
+  public:
+    // Bucket i counts values below 2^i microseconds, the last one also takes everything above
+    static constexpr size_t BUCKETS = 32;
+
+    void record(uint64_t micros);
+
+    uint64_t count() const {
+      return count_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t mean() const;
+
+    // Upper bound of the bucket holding the given quantile, 0 when empty
+    uint64_t percentile(double quantile) const;
+
+  private:
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+};
+
+class HttpMetrics {
+  public:
+    struct PhaseSummary {
+        uint64_t count = 0;
+        uint64_t mean = 0;
+        uint64_t p50 = 0;
+        uint64_t p90 = 0;
+        uint64_t p99 = 0;
+    };
+
+    struct ClassSummary {
+        uint64_t requests = 0;
+        uint64_t failures = 0;
+        uint64_t bytesDown = 0;
+        uint64_t bytesUp = 0;
+        std::array<PhaseSummary, static_cast<size_t>(TimingPhase::COUNT)> phases{};
+    };
+
+    HttpMetrics() = default;
+    ~HttpMetrics();
+    HttpMetrics(const HttpMetrics&) = delete;
+    HttpMetrics& operator=(const HttpMetrics&) = delete;
+    HttpMetrics(HttpMetrics&&) = delete;
+    HttpMetrics& operator=(HttpMetrics&&) = delete;
+
+    void record(std::string_view url, const RequestTiming& timing);
+    ClassSummary summary(UrlClass urlClass) const;
+
+    // Write a table of every class with traffic
+    void dump(std::ostream& out) const;
+
+    // Dump to out every interval on a background thread until stopped
+    void startPeriodicDump(std::chrono::seconds interval, std::ostream& out);
+    void stopPeriodicDump();
+
+    static UrlClass classify(std::string_view url);
+    static const char* className(UrlClass urlClass);
+    static const char* phaseName(TimingPhase phase);
+
+    // Get singleton instance
+    static HttpMetrics& getInstance();
+
+  private:
+    struct ClassMetrics {
+        std::array<LatencyHistogram, static_cast<size_t>(TimingPhase::COUNT)> phases;
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> failures{0};
+        std::atomic<uint64_t> bytesDown{0};
+        std::atomic<uint64_t> bytesUp{0};
+    };
+
+    std::array<ClassMetrics, static_cast<size_t>(UrlClass::COUNT)> classes_;
+
+    std::thread dumpThread_;
+    std::mutex dumpMutex_;
+    std::condition_variable dumpCond_;
+    bool dumpStopping_ = false;
+};
@@ -1,8 +1,64 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
+// Retry transfers that fail with a transport error, 408, 429 or 5xx
+struct RetryPolicy {
+    int maxAttempts = 1; // Including the first try, 1 disables retries
+    std::chrono::milliseconds baseDelay{200};
+    std::chrono::milliseconds maxDelay{5000};
+};
+
+// Duplicate a transfer once it runs past this percentile of recent transfer times, the first
+// copy to succeed is used
+struct HedgePolicy {
+    double percentile = 0;                   // e.g. 0.95, zero disables hedging
+    std::chrono::milliseconds minDelay{100}; // Never hedge sooner than this
+    size_t maxHedges = 2;                    // Duplicates in flight at once
+};
+
+// Limits for a batch fetch, zero leaves the limit off
+struct FetchOptions {
+    size_t maxInFlight = 0; // Concurrent transfers, capped by the handle pool unless multiplexing
+    long maxPerHost = 0;    // Concurrent connections to any one host
+    // Negotiate HTTP/2 and multiplex transfers to the same origin over one connection
+    bool http2Multiplex = false;
+    long maxConcurrentStreams = 0; // Streams per HTTP/2 connection, also sets the batch window
+    RetryPolicy retry;
+    HedgePolicy hedge;
+};
+
+// Called once per URL as its transfer finishes, with std::nullopt on failure
+using CompletionHandler = std::function<void(size_t index, std::optional<std::string> body)>;
+
+enum class FetchStatus : uint8_t { OK, NOT_MODIFIED, FAILED };
+
+// ETag and Last-Modified of a response, either may be empty
+struct CacheValidators {
+    std::string etag;
+    std::string lastModified;
+
+    bool empty() const {
+      return etag.empty() && lastModified.empty();
+    }
+};
+
+// Outcome of a conditional fetch, body and validators are only set when the status is OK
+struct FetchResult {
+    FetchStatus status = FetchStatus::FAILED;
+    std::optional<std::string> body;
+    CacheValidators validators;
+};
+
+// Called once with the outcome of an asynchronous fetch
+using ResultHandler = std::function<void(FetchResult result)>;
+
 class IHttpClient {
   public:
     IHttpClient() = default;
@@ -14,6 +70,42 @@ class IHttpClient {
     IHttpClient& operator=(IHttpClient&&) = delete;
 
     virtual std::optional<std::string> fetchUrl(const std::string& url) = 0;
+    // Fetch url, sending the validators from its last successful response
+    virtual FetchResult fetchUrlIfModified(const std::string& url) = 0;
     virtual std::vector<std::optional<std::string>>
     fetchUrls(const std::vector<std::string>& urls) = 0;
+    virtual void fetchUrls(const std::vector<std::string>& urls,
+                           const CompletionHandler& onComplete, const FetchOptions& options) = 0;
+
+    // Queue a fetch and return at once. onComplete may run on another thread, so keep it short
+    // and hand heavy work elsewhere. ifModified behaves as fetchUrlIfModified.
+    virtual void fetchAsync(const std::string& url, bool ifModified, ResultHandler onComplete) = 0;
+    // As above, conditional on validators the caller kept itself, e.g. beside a cached body
+    virtual void fetchAsync(const std::string& url, const CacheValidators& validators,
+                            ResultHandler onComplete) = 0;
+
+    std::future<std::optional<std::string>> fetchUrlAsync(const std::string& url) {
+      auto promise = std::make_shared<std::promise<std::optional<std::string>>>();
+      auto future = promise->get_future();
+      fetchAsync(url, false,
+                 [promise](FetchResult result) { promise->set_value(std::move(result.body)); });
+      return future;
+    }
+
+    std::future<FetchResult> fetchUrlIfModifiedAsync(const std::string& url) {
+      auto promise = std::make_shared<std::promise<FetchResult>>();
+      auto future = promise->get_future();
+      fetchAsync(url, true,
+                 [promise](FetchResult result) { promise->set_value(std::move(result)); });
+      return future;
+    }
+
+    std::future<FetchResult> fetchUrlIfModifiedAsync(const std::string& url,
+                                                     const CacheValidators& validators) {
+      auto promise = std::make_shared<std::promise<FetchResult>>();
+      auto future = promise->get_future();
+      fetchAsync(url, validators,
+                 [promise](FetchResult result) { promise->set_value(std::move(result)); });
+      return future;
+    }
 };
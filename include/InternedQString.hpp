@@ -0,0 +1,22 @@
+#pragma once
+#include "StringPool.hpp"
+#include <QString>
+#include <vector>
+
+// QString for an interned value, converted from UTF-8 once per distinct string and then shared.
+// Model data() calls run on the GUI thread, which is the only thread allowed to use this.
+inline QString toQString(const InternedString& value) {
+  static std::vector<QString> cache;
+  static std::vector<bool> converted;
+
+  uint32_t id = value.id();
+  if (id >= cache.size()) {
+    cache.resize(id + 1);
+    converted.resize(id + 1, false);
+  }
+  if (!converted[id]) {
+    cache[id] = QString::fromStdString(value.str());
+    converted[id] = true;
+  }
+  return cache[id];
+}
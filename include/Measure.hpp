@@ -1,27 +1,30 @@
 #pragma once
+#include "TypeUtils.hpp"
 #include <simdjson.h>
 #include <string>
 
 class Measure {
   public:
     static Measure fromJson(const simdjson::dom::element& jsonObj);
+    // Non-throwing form of fromJson, out is only complete on NONE
+    static ParseError decode(const simdjson::dom::element& jsonObj, Measure& out);
 
     const std::string& getId() const {
       return id;
     }
-    const std::string& getParameter() const {
+    const InternedString& getParameter() const {
       return parameter;
     }
-    const std::string& getParameterName() const {
+    const InternedString& getParameterName() const {
       return parameterName;
     }
     double getPeriod() const {
       return period;
     }
-    const std::string& getQualifier() const {
+    const InternedString& getQualifier() const {
       return qualifier;
     }
-    const std::string& getUnitName() const {
+    const InternedString& getUnitName() const {
       return unitName;
     }
     double getLatestReading() const {
@@ -29,11 +32,13 @@ class Measure {
     }
 
   private:
+    static const FieldSchema<Measure> SCHEMA;
+
     std::string id;
-    std::string parameter;
-    std::string parameterName;
+    InternedString parameter;
+    InternedString parameterName;
     double period = 0.0;
-    std::string qualifier;
-    std::string unitName;
+    InternedString qualifier;
+    InternedString unitName;
     double latestReading = 0.0;
 };
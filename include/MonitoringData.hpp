@@ -1,16 +1,45 @@
 #pragma once
+#include "ParseReport.hpp"
 #include "Station.hpp"
 #include "Warning.hpp"
 #include <simdjson.h>
+#include <chrono>
+#include <ostream>
+#include <string>
 #include <vector>
 
+// Where fetchAllPolygonsAsync spent its time. Download is wall time, the decode stages are
+// summed over the decode workers, so together they can exceed the wall time of the fetch.
+struct PolygonTimings {
+    using Duration = std::chrono::microseconds;
+
+    size_t polygons = 0; // Warnings with a polygon URL
+    size_t shared = 0;   // Took geometry a live warning already held, nothing fetched
+    size_t cached = 0;   // Served from the disk cache
+    size_t failed = 0;   // Neither cached nor fetched and decoded
+    Duration download{0};
+    Duration parse{0};    // JSON parse and geometry lookup
+    Duration geometry{0}; // Building the MultiPolygon from coordinates
+    Duration simplify{0}; // Building the per-zoom level of detail
+
+    // One line summary, "polygons: N (S shared, C cached, F failed), download X ms, ..."
+    void log(std::ostream& out) const;
+};
+
 class MonitoringData {
     friend class MonitoringDataTest;
 
   public:
-    void parseWarnings(const simdjson::dom::element& apiResponse);
-    void parseStations(const simdjson::dom::element& apiResponse);
-    void fetchAllPolygonsAsync();
+    // Bad items are skipped and tallied in the report rather than logged one by one
+    ParseReport parseWarnings(const simdjson::dom::element& apiResponse);
+    ParseReport parseStations(const simdjson::dom::element& apiResponse);
+    // Stream the stations response with On-Demand instead of building a DOM, the report's
+    // document error is set if the document itself is unusable
+    ParseReport parseStationsOnDemand(const std::string& json);
+    // Downloads run concurrently and each polygon is decoded on the shared pool as it arrives.
+    // Areas already decoded for a live warning, here or elsewhere, are reused from the
+    // PolygonStore, and each area is fetched once however many warnings name it.
+    PolygonTimings fetchAllPolygonsAsync();
 
     const std::vector<Warning>& getWarnings() const {
       return warnings;
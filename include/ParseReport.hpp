@@ -0,0 +1,42 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Why an item could not be decoded. Decoders return these instead of throwing, so a feed full
+// of bad records costs no more to parse than a clean one.
+enum class ParseError : uint8_t {
+  NONE,
+  WRONG_TYPE,   // A field holds a different JSON type than its member
+  BAD_ELEMENT,  // The active element of an array field is missing or of the wrong type
+  MALFORMED,    // The item or document is not valid JSON
+  COUNT
+};
+
+const char* parseErrorName(ParseError error);
+
+// Outcome of decoding an items array, meant to be logged once per parse
+struct ParseReport {
+    static constexpr size_t MAX_SAMPLES = 8;
+
+    size_t items = 0;   // Entries in the array, nulls included
+    size_t decoded = 0; // Entries that became objects
+    ParseError document = ParseError::NONE; // Set when the document as a whole was unusable
+    std::array<size_t, static_cast<size_t>(ParseError::COUNT)> errors{};
+    std::vector<size_t> samples; // Indices of the first MAX_SAMPLES failed items
+
+    void recordFailure(size_t index, ParseError error);
+
+    size_t failed() const;
+    bool ok() const {
+      return document == ParseError::NONE;
+    }
+    bool clean() const {
+      return ok() && failed() == 0;
+    }
+
+    // One line summary, "kind: decoded N of M, K failed (wrong type: ...), first at [...]"
+    void log(std::ostream& out, const char* kind) const;
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <simdjson.h>
+#include <utility>
+#include <vector>
+
+// Idle simdjson parsers kept for reuse, so each parse starts with the tape and string buffers
+// the last one grew instead of allocating fresh ones. A parser that grew past maxCapacity is
+// freed when returned, so one huge document does not pin its buffers for the process lifetime.
+template <typename Parser> class BasicParserPool {
+  public:
+    static constexpr size_t DEFAULT_MAX_CAPACITY = 32ULL * 1024 * 1024;
+    static constexpr size_t DEFAULT_MAX_IDLE = 4;
+
+    // A checked-out parser, returned to its pool when the lease goes out of scope. Anything
+    // parsed with it is only valid while the lease is held.
+    class Lease {
+      public:
+        Lease(BasicParserPool& pool, std::unique_ptr<Parser> parser)
+            : pool_(&pool), parser_(std::move(parser)) {}
+        ~Lease() {
+          if (parser_) {
+            pool_->release(std::move(parser_));
+          }
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&& other) noexcept = default;
+        Lease& operator=(Lease&&) = delete;
+
+        Parser& operator*() const {
+          return *parser_;
+        }
+        Parser* operator->() const {
+          return parser_.get();
+        }
+
+      private:
+        BasicParserPool* pool_;
+        std::unique_ptr<Parser> parser_;
+    };
+
+    explicit BasicParserPool(size_t maxCapacity = DEFAULT_MAX_CAPACITY,
+                             size_t maxIdle = DEFAULT_MAX_IDLE)
+        : maxCapacity_(maxCapacity), maxIdle_(maxIdle) {}
+
+    Lease acquire() {
+      std::unique_ptr<Parser> parser;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty()) {
+          parser = std::move(idle_.back());
+          idle_.pop_back();
+        }
+      }
+      if (!parser) {
+        parser = std::make_unique<Parser>();
+      }
+      return Lease(*this, std::move(parser));
+    }
+
+    // Parsers waiting to be reused
+    size_t idle() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return idle_.size();
+    }
+
+    // Get singleton instance
+    static BasicParserPool& getInstance() {
+      static BasicParserPool instance;
+      return instance;
+    }
+
+  private:
+    size_t maxCapacity_;
+    size_t maxIdle_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Parser>> idle_;
+
+    void release(std::unique_ptr<Parser> parser) {
+      if (parser->capacity() > maxCapacity_) {
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (idle_.size() < maxIdle_) {
+        idle_.push_back(std::move(parser));
+      }
+    }
+};
+
+using ParserPool = BasicParserPool<simdjson::dom::parser>;
+using OnDemandParserPool = BasicParserPool<simdjson::ondemand::parser>;
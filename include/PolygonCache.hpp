@@ -0,0 +1,78 @@
+#pragma once
+#include "IHttpClient.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Disk-backed store of flood area GeoJSON, keyed by polygon URL
+class PolygonCache {
+  public:
+    struct Entry {
+        std::string body;
+        bool stale; // Older than maxAge, still usable but due a refresh
+        CacheValidators validators;
+    };
+
+    // An entry due a refresh, with the validators to send so an unchanged body is not resent
+    struct StaleEntry {
+        std::string url;
+        CacheValidators validators;
+    };
+
+    static constexpr uintmax_t DEFAULT_MAX_BYTES = 256ULL * 1024 * 1024;
+    static constexpr std::chrono::hours DEFAULT_MAX_AGE{24 * 7};
+
+    explicit PolygonCache(std::filesystem::path directory, uintmax_t maxBytes = DEFAULT_MAX_BYTES,
+                          std::chrono::seconds maxAge = DEFAULT_MAX_AGE);
+    ~PolygonCache();
+    PolygonCache(const PolygonCache&) = delete;
+    PolygonCache& operator=(const PolygonCache&) = delete;
+    PolygonCache(PolygonCache&&) = delete;
+    PolygonCache& operator=(PolygonCache&&) = delete;
+
+    // Returns the cached body if present and intact, corrupt entries are removed
+    std::optional<Entry> load(const std::string& url);
+    void store(const std::string& url, std::string_view body,
+               const CacheValidators& validators = {});
+    // Restart an entry's age without rewriting it, for when the server reports it unchanged
+    void renew(const std::string& url);
+
+    // Drop least recently used entries until the cache fits in maxBytes
+    void enforceSizeLimit();
+
+    // Conditionally refetch the given entries on a background thread. Unchanged ones are
+    // renewed, changed ones rewritten if the new body still holds a geometry.
+    void revalidateAsync(std::vector<StaleEntry> entries);
+
+    const std::filesystem::path& getDirectory() const {
+      return directory_;
+    }
+
+    // Get singleton instance
+    static PolygonCache& getInstance();
+    static void setInstance(PolygonCache* instance);
+
+  private:
+    std::filesystem::path directory_;
+    uintmax_t maxBytes_;
+    std::chrono::seconds maxAge_;
+
+    std::mutex writeMutex_;
+    std::thread revalidator_;
+    std::atomic<bool> revalidating_{false};
+
+    std::filesystem::path pathFor(const std::string& url) const;
+    static uint64_t checksum(std::string_view data);
+    // True if the body is a feature collection with a geometry to decode
+    static bool hasGeometry(const std::string& body);
+    static std::filesystem::path defaultDirectory();
+
+    static PolygonCache* testInstance;
+};
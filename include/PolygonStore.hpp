@@ -0,0 +1,56 @@
+#pragma once
+#include "GeometryLod.hpp"
+#include "GeometryTypes.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// A flood area's decoded polygon and its levels of detail. Both are immutable once built, so
+// any number of warnings and threads can hold them.
+struct SharedGeometry {
+    std::shared_ptr<const FlatMultiPolygon> polygon;
+    std::shared_ptr<const GeometryLod> lod; // Null until the levels have been built
+};
+
+// Process-wide index of the geometry live warnings hold, keyed by flood area and polygon URL,
+// so a refresh reuses what the previous one decoded instead of fetching it again. Entries are
+// weak, an area is forgotten once the last warning referring to it is gone.
+class PolygonStore {
+  public:
+    PolygonStore() = default;
+    PolygonStore(const PolygonStore&) = delete;
+    PolygonStore& operator=(const PolygonStore&) = delete;
+    PolygonStore(PolygonStore&&) = delete;
+    PolygonStore& operator=(PolygonStore&&) = delete;
+
+    // Geometry still held for the area, an empty polygon pointer if there is none
+    SharedGeometry find(std::string_view floodAreaId, std::string_view url);
+    // Publishes geometry for the area. If a live copy is already there, that one is returned
+    // for the caller to use instead, so each area is only held once.
+    SharedGeometry insert(std::string_view floodAreaId, std::string_view url,
+                          SharedGeometry geometry);
+
+    // Entries, live or expired, not yet swept
+    size_t size() const;
+
+    // Get singleton instance
+    static PolygonStore& getInstance();
+
+  private:
+    // Smallest map size that triggers a sweep, so a handful of warnings never pay for one
+    static constexpr size_t MIN_SWEEP_SIZE = 256;
+
+    struct Entry {
+        std::weak_ptr<const FlatMultiPolygon> polygon;
+        std::weak_ptr<const GeometryLod> lod;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    size_t sweepAt_ = MIN_SWEEP_SIZE; // Expired entries are swept when the map reaches this
+
+    static std::string key(std::string_view floodAreaId, std::string_view url);
+    static SharedGeometry liveGeometry(const Entry& entry);
+};
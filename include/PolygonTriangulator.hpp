@@ -0,0 +1,16 @@
+#pragma once
+#include "GeometryTypes.hpp"
+#include <cstdint>
+#include <vector>
+
+// Ear clipping for flat polygons with holes, so the map can fill warning areas as plain
+// triangles. Works in whatever plane the coordinates are in, the map layer passes projected ones.
+class PolygonTriangulator {
+  public:
+    // Three corners per triangle, counter-clockwise, each an index into the polygon's points
+    // counted ring after ring. Holes are bridged into the exterior first. Self-intersecting rings
+    // still terminate, though their triangles may overlap.
+    static std::vector<uint32_t> triangulate(const FlatMultiPolygon::Polygon& polygon);
+    // Even-odd test against all of the polygon's rings, so points in holes are outside
+    static bool contains(const FlatMultiPolygon::Polygon& polygon, double x, double y);
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include "IHttpClient.hpp"
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Decorator that passes every request through to another client and writes the URL and
+// response body to a fixture directory that ReplayHttpClient can serve later.
+//
+// Layout: one "<n>.body" file per response plus "index.tsv" with a line per response,
+// "<OK|FAILED>\t<file>\t<url>". Later lines for the same URL win on replay.
+class RecordingHttpClient : public IHttpClient {
+  public:
+    static constexpr const char* INDEX_FILE = "index.tsv";
+
+    // Starts a fresh recording, any index already in directory is replaced
+    RecordingHttpClient(IHttpClient& inner, std::filesystem::path directory);
+
+    std::optional<std::string> fetchUrl(const std::string& url) override;
+    FetchResult fetchUrlIfModified(const std::string& url) override;
+    std::vector<std::optional<std::string>>
+    fetchUrls(const std::vector<std::string>& urls) override;
+    void fetchUrls(const std::vector<std::string>& urls, const CompletionHandler& onComplete,
+                   const FetchOptions& options) override;
+    void fetchAsync(const std::string& url, bool ifModified, ResultHandler onComplete) override;
+    void fetchAsync(const std::string& url, const CacheValidators& validators,
+                    ResultHandler onComplete) override;
+
+    const std::filesystem::path& getDirectory() const {
+      return directory_;
+    }
+
+  private:
+    IHttpClient& inner_;
+    std::filesystem::path directory_;
+    std::ofstream index_;
+    size_t nextFile_ = 0;
+    std::mutex mutex_;
+
+    // Not-modified responses carry no body, the earlier recording still stands
+    void record(const std::string& url, const std::optional<std::string>& body);
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include "IHttpClient.hpp"
+#include <chrono>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Simulated network for ReplayHttpClient, zero leaves that part out
+struct ReplayProfile {
+    std::chrono::milliseconds latency{0}; // Per request, before the first byte arrives
+    uint64_t bytesPerSecond = 0;          // Per transfer
+    size_t maxInFlight = 8;               // Batch concurrency when the caller sets none
+    // Conditional fetches of a URL already served report it unchanged, as a server whose data
+    // has not moved would. Off by default, so every refresh runs its whole pipeline.
+    bool notModifiedOnRepeat = false;
+};
+
+// Serves responses captured by RecordingHttpClient without touching the network, optionally
+// slowed down to mimic a real link so benchmarks see realistic overlap between stages
+class ReplayHttpClient : public IHttpClient {
+  public:
+    explicit ReplayHttpClient(std::filesystem::path directory, ReplayProfile profile = {});
+    ~ReplayHttpClient() override;
+    ReplayHttpClient(const ReplayHttpClient&) = delete;
+    ReplayHttpClient& operator=(const ReplayHttpClient&) = delete;
+    ReplayHttpClient(ReplayHttpClient&&) = delete;
+    ReplayHttpClient& operator=(ReplayHttpClient&&) = delete;
+
+    std::optional<std::string> fetchUrl(const std::string& url) override;
+
+    // Returns the recorded body, or with notModifiedOnRepeat reports a URL already served as
+    // unchanged
+    FetchResult fetchUrlIfModified(const std::string& url) override;
+
+    std::vector<std::optional<std::string>>
+    fetchUrls(const std::vector<std::string>& urls) override;
+    void fetchUrls(const std::vector<std::string>& urls, const CompletionHandler& onComplete,
+                   const FetchOptions& options) override;
+    void fetchAsync(const std::string& url, bool ifModified, ResultHandler onComplete) override;
+    // Recordings keep no validators, so this is the ifModified fetch above
+    void fetchAsync(const std::string& url, const CacheValidators& validators,
+                    ResultHandler onComplete) override;
+
+    // Number of distinct URLs in the recording
+    size_t size() const {
+      return fixtures_.size();
+    }
+
+  private:
+    struct Fixture {
+        bool ok = false;
+        std::filesystem::path file;
+    };
+
+    std::unordered_map<std::string, Fixture> fixtures_;
+    ReplayProfile profile_;
+
+    std::unordered_set<std::string> served_;
+    std::mutex servedMutex_;
+
+    struct AsyncFetch {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+    std::vector<AsyncFetch> asyncFetches_; // Finished ones are joined by the next fetchAsync
+    std::mutex asyncMutex_;
+
+    std::optional<std::string> load(const std::string& url) const;
+
+    // Time a body of this size would take to arrive, latency included
+    std::chrono::microseconds transferTime(size_t bytes) const;
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <algorithm>
+#include <curl/curl.h>
+#include <simdjson.h>
+#include <string>
+
+// Receive buffer for one transfer. It is sized from Content-Length on the first write and
+// always keeps SIMDJSON_PADDING spare capacity, so parser.parse() on the released
+// string reads it in place instead of copying it into a padded buffer.
+class ResponseBuffer {
+  public:
+    // Content-Length is only a hint, a bogus header should not reserve gigabytes up front
+    static constexpr size_t MAX_PRESIZE = 64 * 1024 * 1024;
+
+    ResponseBuffer() = default;
+    explicit ResponseBuffer(CURL* curl) : curl_(curl) {}
+
+    // Start a new transfer on curl, discarding anything received so far
+    void reset(CURL* curl) {
+      curl_ = curl;
+      data_.clear();
+      sized_ = false;
+    }
+
+    void append(const char* data, size_t size) {
+      if (!sized_) {
+        sized_ = true;
+        curl_off_t length = -1;
+        if (curl_ != nullptr &&
+            curl_easy_getinfo(curl_, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length) == CURLE_OK &&
+            length > 0) {
+          // With compression this is the encoded size, still a better start than empty
+          data_.reserve(std::min(static_cast<size_t>(length), MAX_PRESIZE) +
+                        simdjson::SIMDJSON_PADDING);
+        }
+      }
+
+      size_t needed = data_.size() + size + simdjson::SIMDJSON_PADDING;
+      if (needed > data_.capacity()) {
+        data_.reserve(std::max(needed, data_.capacity() * 2));
+      }
+      data_.append(data, size);
+    }
+
+    size_t size() const {
+      return data_.size();
+    }
+
+    // Hand the body over, padded for simdjson
+    std::string release() {
+      if (data_.capacity() - data_.size() < simdjson::SIMDJSON_PADDING) {
+        data_.reserve(data_.size() + simdjson::SIMDJSON_PADDING);
+      }
+      std::string body = std::move(data_);
+      data_.clear();
+      sized_ = false;
+      return body;
+    }
+
+  private:
+    CURL* curl_ = nullptr;
+    std::string data_;
+    bool sized_ = false;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "Measure.hpp"
+#include "TypeUtils.hpp"
 #include <simdjson.h>
 #include <string>
 #include <vector>
@@ -7,11 +8,16 @@
 class Station {
   public:
     static Station fromJson(const simdjson::dom::element& jsonObj);
+    // Same result as fromJson, reading each field once in document order
+    static Station fromOnDemand(simdjson::ondemand::object jsonObj);
+    // Non-throwing forms of the above for bulk ingest, out is only complete on NONE
+    static ParseError decode(const simdjson::dom::element& jsonObj, Station& out);
+    static ParseError decode(simdjson::ondemand::object jsonObj, Station& out);
 
     const std::string& getRLOIid() const {
       return RLOIid;
     }
-    const std::string& getCatchmentName() const {
+    const InternedString& getCatchmentName() const {
       return catchmentName;
     }
     const std::string& getDateOpened() const {
@@ -35,13 +41,13 @@ class Station {
     const std::string& getNotation() const {
       return notation;
     }
-    const std::string& getTown() const {
+    const InternedString& getTown() const {
       return town;
     }
-    const std::string& getRiverName() const {
+    const InternedString& getRiverName() const {
       return riverName;
     }
-    const std::string& getStatus() const {
+    const InternedString& getStatus() const {
       return status;
     }
     const std::vector<Measure>& getMeasures() const {
@@ -53,8 +59,10 @@ class Station {
     }
 
   private:
+    static const FieldSchema<Station> SCHEMA;
+
     std::string RLOIid;
-    std::string catchmentName;
+    InternedString catchmentName;
     std::string dateOpened;
     std::string label;
     double lat = 0.0;
@@ -62,8 +70,8 @@ class Station {
     int64_t northing = 0;
     int64_t easting = 0;
     std::string notation;
-    std::string town;
-    std::string riverName;
-    std::string status;
+    InternedString town;
+    InternedString riverName;
+    InternedString status;
     std::vector<Measure> measures;
 };
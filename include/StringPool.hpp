@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Process-wide store for strings that repeat across thousands of objects, such as river names,
+// counties and measure units. Each distinct value is kept once, with a dense id, for the life
+// of the process.
+class StringPool {
+  public:
+    struct Entry {
+        std::string value;
+        uint32_t id;
+    };
+
+    StringPool();
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+    StringPool(StringPool&&) = delete;
+    StringPool& operator=(StringPool&&) = delete;
+
+    // Entry for value, added the first time it is seen. Safe to call from several threads.
+    const Entry* intern(std::string_view value);
+
+    // The "" entry, id 0
+    const Entry* empty() const {
+      return empty_;
+    }
+
+    // Distinct strings held
+    size_t size() const;
+
+    // Get singleton instance
+    static StringPool& getInstance();
+
+  private:
+    mutable std::shared_mutex mutex_;
+    std::deque<Entry> entries_; // A deque keeps entries in place as it grows
+    std::unordered_map<std::string_view, const Entry*> index_;
+    const Entry* empty_;
+};
+
+// Pointer-sized handle to a pooled string. Equal values share an entry, so comparing two
+// handles is a pointer compare, and it reads as a const std::string& wherever one is expected.
+class InternedString {
+  public:
+    InternedString() : entry_(StringPool::getInstance().empty()) {}
+    explicit InternedString(std::string_view value)
+        : entry_(StringPool::getInstance().intern(value)) {}
+
+    const std::string& str() const {
+      return entry_->value;
+    }
+    operator const std::string&() const {
+      return entry_->value;
+    }
+    // Dense index into the pool, for side tables keyed by value
+    uint32_t id() const {
+      return entry_->id;
+    }
+    bool empty() const {
+      return entry_->value.empty();
+    }
+
+    friend bool operator==(const InternedString& a, const InternedString& b) {
+      return a.entry_ == b.entry_;
+    }
+    friend bool operator!=(const InternedString& a, const InternedString& b) {
+      return a.entry_ != b.entry_;
+    }
+    friend bool operator==(const InternedString& a, std::string_view b) {
+      return a.str() == b;
+    }
+    friend bool operator!=(const InternedString& a, std::string_view b) {
+      return a.str() != b;
+    }
+    friend std::ostream& operator<<(std::ostream& out, const InternedString& value) {
+      return out << value.str();
+    }
+
+  private:
+    const StringPool::Entry* entry_;
+};
@@ -1,8 +1,16 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <exception>
 #include <functional>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <type_traits>
+#include <vector>
 
 class ThreadPool {
   public:
@@ -24,6 +32,16 @@ class ThreadPool {
         });
     }
 
+    // Pool sized to the machine for short CPU-bound work such as parsing
+    static ThreadPool& shared() {
+      static ThreadPool pool(std::max(1U, std::thread::hardware_concurrency()));
+      return pool;
+    }
+
+    size_t size() const {
+      return workers.size();
+    }
+
     template <class F> void enqueue(F&& f) {
       {
         std::unique_lock<std::mutex> lock(queue_mutex);
@@ -32,6 +50,61 @@ class ThreadPool {
       condition.notify_one();
     }
 
+    // Like enqueue, but the result or exception comes back through the future
+    template <class F> auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+      using Result = std::invoke_result_t<std::decay_t<F>>;
+      // std::function needs a copyable callable, so the task lives behind a shared_ptr
+      auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+      std::future<Result> result = task->get_future();
+      enqueue([task]() { (*task)(); });
+      return result;
+    }
+
+    // Calls body(begin, end) over [0, count) in chunks of at most grain items, spread over the
+    // pool and the calling thread, and returns once every chunk is done. The caller takes
+    // chunks too, so it never just waits on a busy pool, but it must not itself be a pool task.
+    template <class F> void parallelFor(size_t count, size_t grain, F&& body) {
+      grain = std::max<size_t>(1, grain);
+      size_t chunks = (count + grain - 1) / grain;
+      if (chunks <= 1 || workers.empty()) {
+        if (count > 0)
+          body(size_t{0}, count);
+        return;
+      }
+
+      std::atomic<size_t> next{0};
+      auto run = [&]() {
+        for (size_t chunk = next.fetch_add(1); chunk < chunks; chunk = next.fetch_add(1)) {
+          size_t begin = chunk * grain;
+          body(begin, std::min(count, begin + grain));
+        }
+      };
+
+      std::vector<std::future<void>> helpers;
+      size_t helperCount = std::min(workers.size(), chunks - 1);
+      helpers.reserve(helperCount);
+      for (size_t i = 0; i < helperCount; ++i)
+        helpers.push_back(submit(run));
+
+      // Helpers reference this frame, so wait for all of them before rethrowing anything
+      std::exception_ptr error;
+      try {
+        run();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      for (auto& helper : helpers) {
+        try {
+          helper.get();
+        } catch (...) {
+          if (!error)
+            error = std::current_exception();
+        }
+      }
+      if (error)
+        std::rethrow_exception(error);
+    }
+
     ~ThreadPool() {
       {
         std::unique_lock<std::mutex> lock(queue_mutex);
@@ -48,4 +121,4 @@ class ThreadPool {
     std::mutex queue_mutex;
     std::condition_variable condition;
     bool stop;
-};
\ No newline at end of file
+};
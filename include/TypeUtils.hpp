@@ -1,83 +1,304 @@
 #pragma once
+#include "ParseReport.hpp"
+#include "StringPool.hpp"
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
 #include <simdjson.h>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
 
-std::string getString(const simdjson::dom::element& elem, std::string_view key,
-                      const char* defaultVal);
-int getInt(const simdjson::dom::element& elem, std::string_view key, int defaultVal);
-double getDouble(const simdjson::dom::element& elem, std::string_view key, double defaultVal);
+// Index of the first "statusActive" entry when status is an array, otherwise 0
+size_t findActiveIndex(const simdjson::dom::element& status);
 
-template <typename T>
-auto getActiveValue(const simdjson::dom::element& elem, std::string_view key, const T& defaultVal) {
-  using ValueType = std::remove_cv_t<std::remove_reference_t<decltype(defaultVal)>>;
+// One member of T filled from a JSON field, and what it takes when the field is missing
+template <typename T> struct FieldSpec {
+    using Member = std::variant<std::string T::*, double T::*, int T::*, int64_t T::*,
+                                InternedString T::*>;
+    // Defaults for interned members are written as plain strings and interned by the schema
+    using Value = std::variant<std::string, double, int, int64_t, InternedString>;
 
-  simdjson::dom::element field;
-  auto error = elem[key].get(field);
-  if (error != 0U) {
-    return ValueType(defaultVal);
-  }
+    std::string_view key;
+    Member member;
+    Value defaultVal;
+    // An array value is indexed by the object's active status instead of being an error
+    bool active = false;
+    // Key of the enclosing object for nested fields, empty at the top level. Nested fields only
+    // take their default when that object is present, otherwise the member is left alone.
+    std::string_view parent = {};
+};
+
+// Field table for T. extract() walks an object's keys once, finding each one's field through a
+// small hash table, and resolves the active status index once per object rather than per field.
+template <typename T> class FieldSchema {
+  public:
+    static constexpr size_t MAX_FIELDS = 32;
+    static constexpr size_t MAX_PARENTS = 4;
 
-  // Try as array first
-  simdjson::dom::array arr;
-  if (field.get(arr) == 0U) {
-    // It's an array - find active status or use first
-    simdjson::dom::array statuses;
-    size_t activeIndex = 0;
-
-    if (elem["status"].get(statuses) == 0U && statuses.size() > 0) {
-      size_t i = 0;
-      for (auto status : statuses) {
-        std::string_view statusStr;
-        if (!status.get(statusStr) && statusStr.find("statusActive") != std::string_view::npos) {
-          activeIndex = i;
-          break;
-        }
-        i++;
+    FieldSchema(std::initializer_list<FieldSpec<T>> fields, std::string_view statusKey = {})
+        : fields_(fields) {
+      if (fields_.size() > MAX_FIELDS) {
+        throw std::logic_error("Too many fields in schema");
+      }
+      for (size_t i = 0; i < fields_.size(); ++i) {
+        FieldSpec<T>& field = fields_[i];
+        if (std::holds_alternative<InternedString T::*>(field.member) &&
+            std::holds_alternative<std::string>(field.defaultVal)) {
+          field.defaultVal = InternedString(std::get<std::string>(field.defaultVal));
+        }
+        if (field.member.index() != field.defaultVal.index()) {
+          throw std::logic_error("Default does not match member type for " +
+                                 std::string(field.key));
+        }
+        uint8_t level = TOP_LEVEL;
+        if (!field.parent.empty()) {
+          level = 0;
+          while (level < parents_.size() && parents_[level] != field.parent) {
+            level++;
+          }
+          if (level == parents_.size()) {
+            if (parents_.size() == MAX_PARENTS) {
+              throw std::logic_error("Too many nested objects in schema");
+            }
+            parents_.push_back(field.parent);
+            insert(field.parent, TOP_LEVEL, static_cast<uint8_t>(PARENT + level));
+          }
+        }
+        levels_.push_back(level);
+        insert(field.key, level, static_cast<uint8_t>(i));
+      }
+      if (!statusKey.empty()) {
+        insert(statusKey, TOP_LEVEL, STATUS);
       }
     }
 
-    // Get value at activeIndex
-    if constexpr (std::is_same_v<ValueType, std::string>) {
-      std::string_view sv;
-      if (arr.at(activeIndex).get(sv) != 0U) {
-        throw std::runtime_error("Array element is not a string");
+    // Fills out from jsonObj, stopping at the first present field of the wrong type
+    ParseError extract(const simdjson::dom::element& jsonObj, T& out) const {
+      Found found;
+      simdjson::dom::object object;
+      if (jsonObj.get(object) == simdjson::SUCCESS) {
+        collect(object, TOP_LEVEL, found);
+        for (uint8_t p = 0; p < parents_.size(); ++p) {
+          simdjson::dom::object nested;
+          if (found.has(PARENT + p) && found.parents[p].get(nested) == simdjson::SUCCESS) {
+            collect(nested, p, found);
+          }
+        }
       }
-      return std::string(sv);
-    } else if constexpr (std::is_same_v<ValueType, double>) {
-      double val;
-      if (arr.at(activeIndex).get(val) != 0U) {
-        throw std::runtime_error("Array element is not a number");
+
+      size_t activeIndex = found.has(STATUS) ? findActiveIndex(found.status) : 0;
+      for (size_t i = 0; i < fields_.size(); ++i) {
+        const FieldSpec<T>& field = fields_[i];
+        if (levels_[i] != TOP_LEVEL && !found.has(PARENT + levels_[i])) {
+          continue;
+        }
+        ParseError error = std::visit(
+            [&](auto member) {
+              using V = std::remove_reference_t<decltype(out.*member)>;
+              if (!found.has(i)) {
+                out.*member = std::get<V>(field.defaultVal);
+                return ParseError::NONE;
+              }
+              return read(found.values[i], field.active, activeIndex, out.*member);
+            },
+            field.member);
+        if (error != ParseError::NONE) {
+          return error;
+        }
       }
-      return val;
-    } else if constexpr (std::is_same_v<ValueType, int64_t>) {
-      int64_t val;
-      if (arr.at(activeIndex).get(val) != 0U) {
-        throw std::runtime_error("Array element is not an integer");
+      return ParseError::NONE;
+    }
+
+  private:
+    // Slot codes: a field index, PARENT plus a nested object's index, or STATUS
+    static constexpr uint8_t PARENT = MAX_FIELDS;
+    static constexpr uint8_t STATUS = PARENT + MAX_PARENTS;
+    static constexpr uint8_t EMPTY = 0xFF;
+    static constexpr uint8_t TOP_LEVEL = 0xFF;
+    static constexpr size_t SLOTS = 64; // Power of two, well over the most codes a schema has
+
+    struct Slot {
+        std::string_view key;
+        uint8_t level = TOP_LEVEL;
+        uint8_t code = EMPTY;
+    };
+
+    struct Found {
+        std::array<simdjson::dom::element, MAX_FIELDS> values;
+        std::array<simdjson::dom::element, MAX_PARENTS> parents;
+        simdjson::dom::element status;
+        uint64_t seen = 0; // Bit per slot code
+
+        bool has(size_t code) const {
+          return (seen >> code & 1U) != 0;
+        }
+    };
+
+    std::vector<FieldSpec<T>> fields_;
+    std::vector<uint8_t> levels_;
+    std::vector<std::string_view> parents_;
+    std::array<Slot, SLOTS> slots_{};
+
+    static size_t hash(std::string_view key) {
+      if (key.empty()) {
+        return 0;
       }
-      return val;
+      return key.size() * 31 + static_cast<unsigned char>(key.front()) * 7 +
+             static_cast<unsigned char>(key.back());
     }
-  }
 
-  // Not an array - get single value
-  if constexpr (std::is_same_v<ValueType, std::string>) {
-    std::string_view sv;
-    if (field.get(sv) != 0U) {
-      throw std::runtime_error("Field is not a string");
+    void insert(std::string_view key, uint8_t level, uint8_t code) {
+      for (size_t slot = hash(key);; ++slot) {
+        Slot& entry = slots_[slot % SLOTS];
+        if (entry.code == EMPTY) {
+          entry = {key, level, code};
+          return;
+        }
+        if (entry.key == key && entry.level == level) {
+          throw std::logic_error("Duplicate key in schema: " + std::string(key));
+        }
+      }
+    }
+
+    uint8_t find(std::string_view key, uint8_t level) const {
+      for (size_t slot = hash(key);; ++slot) {
+        const Slot& entry = slots_[slot % SLOTS];
+        if (entry.code == EMPTY) {
+          return EMPTY;
+        }
+        if (entry.level == level && entry.key == key) {
+          return entry.code;
+        }
+      }
     }
-    return std::string(sv);
-  } else if constexpr (std::is_same_v<ValueType, double>) {
-    double val;
-    if (field.get(val) != 0U) {
-      throw std::runtime_error("Field is not a number");
+
+    // Record where each key of this level is, the first occurrence of a key wins
+    void collect(const simdjson::dom::object& object, uint8_t level, Found& found) const {
+      for (auto [key, value] : object) {
+        uint8_t code = find(key, level);
+        if (code == EMPTY || found.has(code)) {
+          continue;
+        }
+        found.seen |= uint64_t{1} << code;
+        if (code < PARENT) {
+          found.values[code] = value;
+        } else if (code < STATUS) {
+          found.parents[code - PARENT] = value;
+        } else {
+          found.status = value;
+        }
+      }
     }
-    return val;
-  } else if constexpr (std::is_same_v<ValueType, int64_t>) {
-    int64_t val;
-    if (field.get(val) != 0U) {
-      throw std::runtime_error("Field is not an integer");
+
+    template <typename V>
+    static ParseError read(const simdjson::dom::element& value, bool active, size_t activeIndex,
+                           V& out) {
+      simdjson::dom::element target = value;
+      ParseError mismatch = ParseError::WRONG_TYPE;
+      simdjson::dom::array arr;
+      if (active && value.get(arr) == simdjson::SUCCESS) {
+        mismatch = ParseError::BAD_ELEMENT;
+        if (arr.at(activeIndex).get(target) != simdjson::SUCCESS) {
+          return mismatch;
+        }
+      }
+
+      if constexpr (std::is_same_v<V, std::string> || std::is_same_v<V, InternedString>) {
+        std::string_view sv;
+        if (target.get(sv) != simdjson::SUCCESS) {
+          return mismatch;
+        }
+        out = V(sv);
+      } else if constexpr (std::is_same_v<V, int>) {
+        int64_t val = 0;
+        if (target.get(val) != simdjson::SUCCESS) {
+          return mismatch;
+        }
+        out = static_cast<int>(val);
+      } else {
+        if (target.get(out) != simdjson::SUCCESS) {
+          return mismatch;
+        }
+      }
+      return ParseError::NONE;
     }
-    return val;
+};
+
+// On-Demand helpers. Values are read once, in document order, so they cannot look ahead.
+
+template <typename T> simdjson::error_code readValue(simdjson::ondemand::value value, T& out) {
+  if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, InternedString>) {
+    std::string_view sv;
+    auto error = value.get_string().get(sv);
+    if (error == simdjson::SUCCESS) {
+      out = T(sv);
+    }
+    return error;
+  } else {
+    return value.get(out);
   }
+}
 
-  return ValueType(defaultVal);
+// Reads a string field, WRONG_TYPE when it is not one
+template <typename S> ParseError readString(simdjson::ondemand::value value, S& out) {
+  return readValue(value, out) == simdjson::SUCCESS ? ParseError::NONE : ParseError::WRONG_TYPE;
 }
+
+size_t findActiveIndex(simdjson::ondemand::value status);
+
+// On-Demand counterpart of an active FieldSpec. A field may come before "status", so it keeps its
+// scalar or every array element and picks one in resolve() once the object has been read.
+template <typename T> class ActiveValue {
+  public:
+    ParseError read(simdjson::ondemand::value value) {
+      present_ = true;
+      elements_.clear();
+
+      simdjson::ondemand::array arr;
+      if (value.get_array().get(arr) == simdjson::SUCCESS) {
+        isArray_ = true;
+        // Only the chosen element has to be well typed, as with the DOM path
+        for (auto element : arr) {
+          simdjson::ondemand::value item;
+          T parsed{};
+          if (element.get(item) == simdjson::SUCCESS &&
+              readValue(item, parsed) == simdjson::SUCCESS) {
+            elements_.emplace_back(std::move(parsed));
+          } else {
+            elements_.emplace_back(std::nullopt);
+          }
+        }
+        return ParseError::NONE;
+      }
+
+      // Scalars are the common case, keep them out of the vector to save an allocation
+      isArray_ = false;
+      if (readValue(value, scalar_) != simdjson::SUCCESS) {
+        return ParseError::WRONG_TYPE;
+      }
+      return ParseError::NONE;
+    }
+
+    ParseError resolve(size_t activeIndex, const T& defaultVal, T& out) {
+      if (!present_) {
+        out = defaultVal;
+      } else if (!isArray_) {
+        out = std::move(scalar_);
+      } else if (activeIndex < elements_.size() && elements_[activeIndex]) {
+        out = std::move(*elements_[activeIndex]);
+      } else {
+        return ParseError::BAD_ELEMENT;
+      }
+      return ParseError::NONE;
+    }
+
+  private:
+    bool present_ = false;
+    bool isArray_ = false;
+    T scalar_{};
+    std::vector<std::optional<T>> elements_;
+};
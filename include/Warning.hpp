@@ -1,13 +1,20 @@
 #pragma once
+#include "GeometryLod.hpp"
 #include "GeometryTypes.hpp"
+#include "PolygonStore.hpp"
+#include "TypeUtils.hpp"
+#include <memory>
 #include <optional>
 #include <simdjson.h>
 #include <string>
+#include <utility>
 
 class Warning {
   public:
     static Warning fromJson(const simdjson::dom::element& jsonObj);
-    static MultiPolygon parseGeoJsonPolygon(const simdjson::dom::element& geoJson);
+    // Non-throwing form of fromJson, out is only complete on NONE
+    static ParseError decode(const simdjson::dom::element& jsonObj, Warning& out);
+    static FlatMultiPolygon parseGeoJsonPolygon(const simdjson::dom::element& geoJson);
 
     const std::string& getId() const {
       return id;
@@ -18,7 +25,7 @@ class Warning {
     const std::string& getAreaName() const {
       return areaName;
     }
-    const std::string& getSeverity() const {
+    const InternedString& getSeverity() const {
       return severity;
     }
     int getSeverityLevel() const {
@@ -36,34 +43,49 @@ class Warning {
     const std::string& getMessage() const {
       return message;
     }
-    const std::string& getCounty() const {
+    const InternedString& getCounty() const {
       return county;
     }
     const std::string& getPolygonUrl() const {
       return polygonUrl;
     }
-    const std::optional<MultiPolygon>& getFloodAreaPolygon() const {
-      return floodAreaPolygon;
+    // Null until a polygon is set, copies of the warning share one immutable geometry
+    const FlatMultiPolygon* getFloodAreaPolygon() const {
+      return geometry.polygon.get();
     }
 
-    void setFloodAreaPolygon(const std::optional<MultiPolygon>& polygon) {
-      floodAreaPolygon = polygon;
+    // Null until buildPolygonLod runs
+    const GeometryLod* getPolygonLod() const {
+      return geometry.lod.get();
     }
 
+    const SharedGeometry& getGeometry() const {
+      return geometry;
+    }
+    // Take geometry another warning or an earlier refresh already decoded for this area
+    void setGeometry(SharedGeometry shared) {
+      geometry = std::move(shared);
+    }
+    void setFloodAreaPolygon(std::optional<FlatMultiPolygon> polygon);
+    // Simplify the polygon for every zoom, slow enough that it belongs on a worker thread
+    void buildPolygonLod();
+
   private:
+    static const FieldSchema<Warning> SCHEMA;
+
     std::string id;
     std::string description;
     std::string areaName;
-    std::string severity;
+    InternedString severity;
     int severityLevel = 0;
     std::string timeMessageChanged;
     std::string timeRaised;
     std::string timeSeverityChanged;
     std::string message;
-    std::string county;
+    InternedString county;
     std::string polygonUrl;
-    std::optional<MultiPolygon> floodAreaPolygon;
+    SharedGeometry geometry;
 
-    static LinearRing parseLinearRing(const simdjson::dom::array& ringJson);
-    static MyPolygon parsePolygon(const simdjson::dom::array& polygonJson);
+    static void parseLinearRing(const simdjson::dom::array& ringJson, FlatMultiPolygon& out);
+    static void parsePolygon(const simdjson::dom::array& polygonJson, FlatMultiPolygon& out);
 };
@@ -1,15 +1,28 @@
 #pragma once
+#include "AreaMesh.hpp"
 #include "Warning.hpp"
 #include <QAbstractListModel>
 #include <QTimer>
 #include <QVariantList>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <vector>
 
 class WarningModel : public QAbstractListModel {
     Q_OBJECT
     friend class WarningModelTest;
+    Q_PROPERTY(double lastApplyMs READ getLastApplyMs NOTIFY applyTimeChanged)
+    Q_PROPERTY(int applyBudgetOverruns READ getApplyBudgetOverruns NOTIFY applyTimeChanged)
 
   public:
+    // GUI thread time a refresh may take to apply, one frame at 60 Hz
+    static constexpr std::chrono::microseconds DEFAULT_APPLY_BUDGET{16000};
+
+    // No role carries the polygons for drawing, WarningPolygonLayer reads getAreaMesh instead
     enum class WarningRoles : uint16_t {
       DESCRIPTION_ROLE = Qt::UserRole + 1,
       SEVERITY_ROLE,
@@ -20,24 +33,116 @@ class WarningModel : public QAbstractListModel {
     };
 
     explicit WarningModel(const std::vector<Warning>& warnings, QObject* parent = nullptr);
+    // Cancels a refresh still running on the worker without waiting for it
+    ~WarningModel() override;
+    WarningModel(const WarningModel&) = delete;
+    WarningModel& operator=(const WarningModel&) = delete;
+    WarningModel(WarningModel&&) = delete;
+    WarningModel& operator=(WarningModel&&) = delete;
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
 
+    // Rows in order, for C++ views such as the map's polygon layer
+    const std::vector<Warning>& getWarnings() const {
+      return m_warnings;
+    }
+    // A row's geometry projected and triangulated for the map, null without a polygon
+    const std::shared_ptr<const AreaMesh>& getAreaMesh(size_t row) const {
+      return m_polygonValues[row].mesh;
+    }
+
     Q_INVOKABLE void startAutoUpdate();
     Q_INVOKABLE void stopAutoUpdate();
+    // polygonPath follows the map zoom, rows only change when a new level of detail applies
+    Q_INVOKABLE void setZoomLevel(double zoomLevel);
+
+    // True from a fetch starting on the worker until its result has been applied
+    bool isRefreshing() const {
+      return m_refreshing;
+    }
+    // GUI thread time the last applied refresh took: the diff, the views' updates to it and
+    // whatever views catch up on in warningsApplied
+    std::chrono::microseconds getLastApplyTime() const {
+      return m_lastApplyTime;
+    }
+    double getLastApplyMs() const {
+      return static_cast<double>(m_lastApplyTime.count()) / 1000.0;
+    }
+    // Refreshes that took longer than the budget to apply, each one is also logged
+    int getApplyBudgetOverruns() const {
+      return m_applyBudgetOverruns;
+    }
+    void setApplyBudget(std::chrono::microseconds budget) {
+      m_applyBudget = budget;
+    }
 
   signals:
     void warningsUpdated(int count);
+    // Sent straight after new rows are in place, for views that gather row signals into one
+    // update, so that update counts towards the apply time
+    void warningsApplied();
+    void applyTimeChanged();
 
   private:
+    // Starts a refresh on the worker thread, its result comes back through the event loop
     void fetchWarnings();
 
+    // A warning's geometry as QML values for each level of detail and as the map layer's
+    // mesh, built once on arrival
+    struct PolygonValues {
+        // What the values were converted from, held so a later refresh can compare pointers
+        SharedGeometry source;
+        // Exterior ring of the first polygon, as QGeoCoordinates
+        std::array<QVariantList, GeometryLod::LEVELS> paths;
+        std::shared_ptr<const AreaMesh> mesh;
+    };
+
+    // Rows as a refresh lays them out, in model order with their QML values and meshes, so
+    // applying one on the GUI thread is only the diff and the map layer's merge
+    struct Snapshot {
+        std::vector<Warning> warnings;
+        std::vector<PolygonValues> polygonValues;
+    };
+
     std::vector<Warning> m_warnings;
+    std::vector<PolygonValues> m_polygonValues; // Row for row with m_warnings
     QTimer* m_updateTimer;
+    double m_zoomLevel = GeometryLod::MIN_ZOOM;
+    bool m_autoUpdate = false;
+
+    // Shared with refresh workers, which outlive the model if it goes first
+    struct RefreshHandle {
+        std::mutex mutex;
+        WarningModel* model; // Null once the model is gone, guarded by mutex
+        std::atomic<bool> cancelled{false};
+
+        explicit RefreshHandle(WarningModel* owner) : model(owner) {}
+    };
+    std::shared_ptr<RefreshHandle> m_refreshHandle;
+    bool m_refreshing = false; // Only touched on the GUI thread
+    std::chrono::microseconds m_lastApplyTime{0};
+    std::chrono::microseconds m_applyBudget = DEFAULT_APPLY_BUDGET;
+    int m_applyBudgetOverruns = 0;
 
-    static QVariantList getPolygonPath(const Warning& warning);
+    static PolygonValues convertPolygon(const Warning& warning);
+    // Geometry already converted in previous is reused, only new geometry is converted
+    static std::vector<PolygonValues>
+    convertPolygons(const std::vector<Warning>& warnings,
+                    const std::vector<PolygonValues>& previous = {});
+    // Sorts the rows and converts their geometry, safe on any thread
+    static Snapshot prepareSnapshot(std::vector<Warning> warnings,
+                                    const std::vector<PolygonValues>& previous = {});
+    // Fetch, parse, polygons and conversion, run on the worker. Nothing when the warnings are
+    // unchanged upstream, could not be fetched or the refresh was cancelled between stages.
+    // previous is the rows' values at the start.
+    static std::optional<Snapshot> fetchSnapshot(const std::vector<PolygonValues>& previous,
+                                                 const std::atomic<bool>& cancelled);
+    void finishRefresh(std::optional<Snapshot> snapshot);
+    // Applies a snapshot as row inserts, removals, moves and per-role changes, keyed by flood
+    // area, so views keep their state for rows that stay
+    void applySnapshot(Snapshot snapshot);
     void updateWarnings(const std::vector<Warning>& newWarnings);
     static int calculateNextUpdateMs();
 };
@@ -0,0 +1,101 @@
+#pragma once
+#include "AreaGrid.hpp"
+#include "AreaMesh.hpp"
+#include "GeometryLod.hpp"
+#include <QGeoCoordinate>
+#include <QMatrix4x4>
+#include <QPointer>
+#include <QQuickItem>
+#include <array>
+#include <memory>
+#include <vector>
+
+class WarningModel;
+
+// Draws every warning polygon in a handful of scene graph nodes, a fill and an outline per
+// severity under one transform that follows the map. The model hands over each area already
+// projected and triangulated, model updates only merge them, and panning and zooming only change
+// the transform.
+class WarningPolygonLayer : public QQuickItem {
+    Q_OBJECT
+    Q_PROPERTY(WarningModel* model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(QGeoCoordinate center READ center WRITE setCenter NOTIFY centerChanged)
+    Q_PROPERTY(double zoomLevel READ zoomLevel WRITE setZoomLevel NOTIFY zoomLevelChanged)
+    Q_PROPERTY(double bearing READ bearing WRITE setBearing NOTIFY bearingChanged)
+
+  public:
+    // Severity levels 1 to 3 and one for anything else, in drawing order, least severe first
+    static constexpr int SEVERITY_BUCKETS = 4;
+
+    explicit WarningPolygonLayer(QQuickItem* parent = nullptr);
+
+    WarningModel* model() const {
+      return m_model;
+    }
+    void setModel(WarningModel* model);
+    QGeoCoordinate center() const {
+      return m_center;
+    }
+    void setCenter(const QGeoCoordinate& center);
+    double zoomLevel() const {
+      return m_zoomLevel;
+    }
+    void setZoomLevel(double zoomLevel);
+    double bearing() const {
+      return m_bearing;
+    }
+    void setBearing(double bearing);
+
+    // Row of the most severe warning under a point in item coordinates, -1 if there is none or
+    // the rows have changed since the layer last caught up with them
+    Q_INVOKABLE int warningAt(QPointF point) const;
+
+  signals:
+    void modelChanged();
+    void centerChanged();
+    void zoomLevelChanged();
+    void bearingChanged();
+
+  protected:
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data) override;
+
+  private:
+    // Every warning of one severity at one level of detail, vertices in projected pixels at
+    // zoom 0 relative to the origin
+    struct Mesh {
+        std::vector<float> vertices; // Interleaved x, y
+        std::vector<uint32_t> triangles;
+        std::vector<uint32_t> outlines; // Pairs of vertices
+    };
+    struct Row {
+        std::shared_ptr<const AreaMesh> mesh; // Null for a warning without a polygon
+        int bucket = 0;
+    };
+
+    QPointer<WarningModel> m_model;
+    QGeoCoordinate m_center;
+    double m_zoomLevel = GeometryLod::MIN_ZOOM;
+    double m_bearing = 0.0;
+
+    std::array<std::array<Mesh, SEVERITY_BUCKETS>, GeometryLod::LEVELS> m_meshes;
+    std::vector<Row> m_rows; // Row for row with the model as of the last rebuild
+    std::array<bool, GeometryLod::LEVELS> m_merged{}; // Levels whose meshes hold m_rows
+    // Rows by where they are at each merged level, so hit tests skip the areas far away
+    std::array<AreaGrid, GeometryLod::LEVELS> m_grids;
+    // Set when the level's meshes have to be uploaded to the scene graph again
+    bool m_geometryDirty = true;
+    bool m_rebuildPending = false;
+
+    void scheduleRebuild();
+    void rebuildIfPending();
+    void rebuild();
+    // Merges the rows' areas into the level's meshes and grid unless that was done since the
+    // rebuild
+    void mergeLevel(int level);
+    // True if a row's geometry or severity differs from what the meshes were merged from
+    bool rowChanged(size_t row) const;
+    QMatrix4x4 viewMatrix() const;
+    int level() const {
+      return GeometryLod::levelForZoom(m_zoomLevel);
+    }
+};
@@ -1,4 +1,5 @@
 pragma ComponentBehavior: Bound
+import FloodMonitor
 import QtLocation
 import QtPositioning
 import QtQuick
@@ -76,33 +77,35 @@ Item {
 
         onZoomLevelChanged: {
             root.clusterModel.updateClusters(map.zoomLevel);
+            root.warningModel.setZoomLevel(map.zoomLevel);
         }
 
-        // Flood warning polygons
-        MapItemView {
-            id: warningView
-            model: root.warningModel
-
-            delegate: MapPolygon {
-                id: polygonDelegate
-                required property var model
-                required property int index
+        // Flood warning polygons, batched into a few scene graph nodes and hit tested in C++
+        WarningPolygonLayer {
+            id: warningLayer
 
-                property int sev: Number(polygonDelegate.model.severityLevel)
+            anchors.fill: parent
+            model: root.warningModel
+            center: map.center
+            zoomLevel: map.zoomLevel
+            bearing: map.bearing
+
+            TapHandler {
+                onTapped: eventPoint => {
+                    // Station markers are stacked above the polygons, a tap on one is the marker's
+                    var onMap = warningLayer.mapToItem(map, eventPoint.position);
+                    if (map.childAt(onMap.x, onMap.y) !== warningLayer)
+                        return;
+                    var row = warningLayer.warningAt(eventPoint.position);
+                    if (row >= 0)
+                        root.polygonClicked(row);
+                }
+            }
 
-                path: polygonDelegate.model.polygonPath
-                color: sev === 1 ? Qt.rgba(1, 0.27, 0.27, 0.5) : sev === 2 ? Qt.rgba(1, 0.6, 0.27, 0.5) : sev === 3 ? Qt.rgba(1, 0.87, 0.27, 0.5) : Qt.rgba(0.53, 0.53, 0.53, 0.5)
-                border.color: sev === 1 ? "#ff4444" : sev === 2 ? "#ff9944" : sev === 3 ? "#ffdd44" : "#888888"
-                border.width: 3
-                opacity: 1
+            HoverHandler {
+                id: warningHover
 
-                MouseArea {
-                    anchors.fill: parent
-                    cursorShape: Qt.PointingHandCursor
-                    onClicked: {
-                        root.polygonClicked(polygonDelegate.index);
-                    }
-                }
+                cursorShape: warningHover.hovered && warningLayer.warningAt(warningHover.point.position) >= 0 ? Qt.PointingHandCursor : Qt.ArrowCursor
             }
         }
 
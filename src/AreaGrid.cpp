@@ -0,0 +1,79 @@
+#include "AreaGrid.hpp"
+#include <algorithm>
+#include <cmath>
+
+AreaGrid::AreaGrid(const std::vector<const AreaMesh::Bounds*>& bounds) {
+  bool any = false;
+  bounds_.resize(bounds.size());
+  for (size_t area = 0; area < bounds.size(); ++area) {
+    if (bounds[area] == nullptr) {
+      continue;
+    }
+    const AreaMesh::Bounds& box = *bounds[area];
+    bounds_[area] = box;
+    if (!any) {
+      extent_ = box;
+      any = true;
+    }
+    extent_.minX = std::min(extent_.minX, box.minX);
+    extent_.minY = std::min(extent_.minY, box.minY);
+    extent_.maxX = std::max(extent_.maxX, box.maxX);
+    extent_.maxY = std::max(extent_.maxY, box.maxY);
+  }
+  if (!any) {
+    return;
+  }
+
+  // A degenerate extent still needs a nonzero cell to divide by
+  cellWidth_ = std::max((extent_.maxX - extent_.minX) / CELLS, 1e-12);
+  cellHeight_ = std::max((extent_.maxY - extent_.minY) / CELLS, 1e-12);
+
+  // Count each cell's areas, then lay the lists out back to back
+  auto forEachCell = [&](const AreaMesh::Bounds& box, auto&& visit) {
+    auto [firstColumn, lastColumn] = cellSpan(box.minX, box.maxX, extent_.minX, cellWidth_);
+    auto [firstRow, lastRow] = cellSpan(box.minY, box.maxY, extent_.minY, cellHeight_);
+    for (int row = firstRow; row <= lastRow; ++row) {
+      for (int column = firstColumn; column <= lastColumn; ++column) {
+        visit((row * CELLS) + column);
+      }
+    }
+  };
+
+  cellStarts_.assign((CELLS * CELLS) + 1, 0);
+  for (size_t area = 0; area < bounds.size(); ++area) {
+    if (bounds[area] != nullptr) {
+      forEachCell(*bounds[area], [this](int cell) { ++cellStarts_[cell + 1]; });
+    }
+  }
+  for (size_t cell = 1; cell < cellStarts_.size(); ++cell) {
+    cellStarts_[cell] += cellStarts_[cell - 1];
+  }
+
+  cellAreas_.resize(cellStarts_.back());
+  std::vector<uint32_t> filled(cellStarts_.begin(), cellStarts_.end() - 1);
+  for (size_t area = 0; area < bounds.size(); ++area) {
+    if (bounds[area] != nullptr) {
+      forEachCell(*bounds[area], [&](int cell) {
+        cellAreas_[filled[cell]++] = static_cast<uint32_t>(area);
+      });
+    }
+  }
+}
+
+std::pair<uint32_t, uint32_t> AreaGrid::cell(double x, double y) const {
+  if (cellStarts_.empty() || !extent_.contains(x, y)) {
+    return {0, 0};
+  }
+  int column = cellSpan(x, x, extent_.minX, cellWidth_).first;
+  int row = cellSpan(y, y, extent_.minY, cellHeight_).first;
+  int index = (row * CELLS) + column;
+  return {cellStarts_[index], cellStarts_[index + 1]};
+}
+
+std::pair<int, int> AreaGrid::cellSpan(double from, double to, double origin,
+                                       double cellSize) {
+  auto toCell = [origin, cellSize](double value) {
+    return std::clamp(static_cast<int>(std::floor((value - origin) / cellSize)), 0, CELLS - 1);
+  };
+  return {toCell(from), toCell(to)};
+}
@@ -0,0 +1,96 @@
+#include "AreaMesh.hpp"
+#include "PolygonTriangulator.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Web Mercator tiles are 256 px wide and cover the world at zoom 0
+static constexpr double TILE_SIZE = 256.0;
+static constexpr double MAX_LATITUDE = 85.05112878;
+// Vertices are stored relative to the middle of England, which keeps floats to a small fraction
+// of a pixel even at street zoom
+static constexpr double ORIGIN_LON = -1.4;
+static constexpr double ORIGIN_LAT = 53.0;
+
+namespace {
+
+std::pair<double, double> projectFromCorner(double lon, double lat) {
+  double sinLat = std::sin(std::clamp(lat, -MAX_LATITUDE, MAX_LATITUDE) * M_PI / 180.0);
+  double y = 0.5 - (std::log((1.0 + sinLat) / (1.0 - sinLat)) / (4.0 * M_PI));
+  return {(lon + 180.0) / 360.0 * TILE_SIZE, y * TILE_SIZE};
+}
+
+} // namespace
+
+AreaMesh::AreaMesh(SharedGeometry source) : source_(std::move(source)) {
+  const GeometryLod* lod = source_.lod.get();
+  if (source_.polygon == nullptr) {
+    levels_.resize(1);
+  } else if (lod == nullptr) {
+    levels_.push_back(buildLevel(*source_.polygon));
+  } else {
+    levels_.reserve(GeometryLod::LEVELS);
+    for (int level = 0; level < GeometryLod::LEVELS; ++level) {
+      levels_.push_back(buildLevel(lod->forZoom(GeometryLod::MIN_ZOOM + level)));
+    }
+  }
+}
+
+bool AreaMesh::contains(int level, double x, double y) const {
+  const Level& area = this->level(level);
+  if (area.shape.empty() || !area.bounds.contains(x, y)) {
+    return false;
+  }
+  return std::any_of(area.shape.begin(), area.shape.end(), [x, y](auto polygon) {
+    return PolygonTriangulator::contains(polygon, x, y);
+  });
+}
+
+std::pair<double, double> AreaMesh::project(double lon, double lat) {
+  static const std::pair<double, double> origin = projectFromCorner(ORIGIN_LON, ORIGIN_LAT);
+  auto [x, y] = projectFromCorner(lon, lat);
+  return {x - origin.first, y - origin.second};
+}
+
+AreaMesh::Level AreaMesh::buildLevel(const FlatMultiPolygon& geometry) {
+  Level area;
+  area.shape.reservePoints(geometry.pointCount());
+  area.shape.reserveRings(geometry.ringCount());
+  area.shape.reservePolygons(geometry.size());
+  for (auto polygon : geometry) {
+    for (auto ring : polygon) {
+      for (const auto& [lon, lat] : ring) {
+        auto [x, y] = project(lon, lat);
+        area.shape.addPoint(x, y);
+      }
+      area.shape.closeRing();
+    }
+    area.shape.closePolygon();
+  }
+
+  for (size_t i = 0; i < area.shape.pointCount(); ++i) {
+    auto [x, y] = area.shape.point(i);
+    if (i == 0) {
+      area.bounds = {x, y, x, y};
+    }
+    area.bounds.minX = std::min(area.bounds.minX, x);
+    area.bounds.minY = std::min(area.bounds.minY, y);
+    area.bounds.maxX = std::max(area.bounds.maxX, x);
+    area.bounds.maxY = std::max(area.bounds.maxY, y);
+  }
+
+  uint32_t offset = 0;
+  for (auto polygon : area.shape) {
+    for (uint32_t index : PolygonTriangulator::triangulate(polygon)) {
+      area.triangles.push_back(offset + index);
+    }
+    for (auto ring : polygon) {
+      auto size = static_cast<uint32_t>(ring.size());
+      for (uint32_t i = 0; i + 1 < size; ++i) {
+        area.outlines.push_back(offset + i);
+        area.outlines.push_back(offset + i + 1);
+      }
+      offset += size;
+    }
+  }
+  return area;
+}
@@ -0,0 +1,409 @@
+#include "CoordinateDecoder.hpp"
+#include <array>
+#include <charconv>
+
+// Doubles represent every integer up to 2^53 and every power of ten up to 1e22 exactly, so
+// one multiply or divide of the two is correctly rounded (Clinger's fast path)
+static constexpr uint64_t MAX_EXACT_MANTISSA = uint64_t{1} << 53;
+static constexpr int MAX_EXACT_POWER = 22;
+// A uint64 holds any 19 digit mantissa
+static constexpr int MAX_MANTISSA_DIGITS = 19;
+
+static constexpr std::array<double, MAX_EXACT_POWER + 1> POWERS_OF_TEN = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// The characters that change nesting when skipping a container: brackets, braces and quotes
+static constexpr std::array<bool, 256> NESTING = [] {
+  std::array<bool, 256> table{};
+  for (unsigned char c : {'[', ']', '{', '}', '"'}) {
+    table[c] = true;
+  }
+  return table;
+}();
+
+namespace {
+
+bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Append a run of digits to the mantissa, returns the end of the run
+const char* parseDigits(const char* p, const char* end, uint64_t& mantissa, int& digits) {
+  for (; p != end && isDigit(*p); ++p, ++digits) {
+    mantissa = (mantissa * 10) + static_cast<uint64_t>(*p - '0');
+  }
+  return p;
+}
+
+// Coordinates have few enough digits for the fast path, anything else goes to from_chars
+const char* parseFast(const char* pos, const char* end, double& value) {
+  const char* p = pos;
+  bool negative = p != end && *p == '-';
+  p += negative ? 1 : 0;
+
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  p = parseDigits(p, end, mantissa, digits);
+  if (digits == 0) {
+    return nullptr;
+  }
+  if (p != end && *p == '.') {
+    const char* fraction = ++p;
+    p = parseDigits(p, end, mantissa, digits);
+    if (p == fraction) {
+      return nullptr;
+    }
+    exponent = -static_cast<int>(p - fraction);
+  }
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    bool negativeExponent = p != end && *p == '-';
+    p += (p != end && (*p == '-' || *p == '+')) ? 1 : 0;
+    int explicitExponent = 0;
+    const char* exponentDigits = p;
+    for (; p != end && isDigit(*p) && p - exponentDigits < 4; ++p) {
+      explicitExponent = (explicitExponent * 10) + (*p - '0');
+    }
+    if (p == exponentDigits || (p != end && isDigit(*p))) {
+      return nullptr;
+    }
+    exponent += negativeExponent ? -explicitExponent : explicitExponent;
+  }
+
+  if (digits > MAX_MANTISSA_DIGITS || mantissa > MAX_EXACT_MANTISSA ||
+      exponent < -MAX_EXACT_POWER || exponent > MAX_EXACT_POWER) {
+    return nullptr;
+  }
+  value = static_cast<double>(mantissa);
+  value = exponent < 0 ? value / POWERS_OF_TEN[-exponent] : value * POWERS_OF_TEN[exponent];
+  value = negative ? -value : value;
+  return p;
+}
+
+// A cursor over the coordinates text. Each parse step leaves it just past what it consumed.
+class Scanner {
+  public:
+    explicit Scanner(std::string_view json) : pos_(json.data()), end_(json.data() + json.size()) {}
+
+    bool atEnd() {
+      skipWhitespace();
+      return pos_ == end_;
+    }
+
+    // Calls element() for each element of the array at the cursor, which must consume it
+    template <typename Element> bool forEach(Element element) {
+      if (!consume('[')) {
+        return false;
+      }
+      if (consume(']')) {
+        return true;
+      }
+      for (size_t index = 0;; ++index) {
+        if (!element(index)) {
+          return false;
+        }
+        if (consume(']')) {
+          return true;
+        }
+        if (!consume(',')) {
+          return false;
+        }
+      }
+    }
+
+    const char* position() const {
+      return pos_;
+    }
+    void rewind(const char* position) {
+      pos_ = position;
+    }
+
+    // The common [lon, lat] position in one pass, false leaves the cursor wherever it stopped
+    bool numberPair(double& lon, double& lat) {
+      if (!consume('[')) {
+        return false;
+      }
+      skipWhitespace();
+      const char* next = parseFast(pos_, end_, lon);
+      if (next == nullptr) {
+        return false;
+      }
+      pos_ = next;
+      if (!consume(',')) {
+        return false;
+      }
+      skipWhitespace();
+      next = parseFast(pos_, end_, lat);
+      if (next == nullptr) {
+        return false;
+      }
+      pos_ = next;
+      return consume(']');
+    }
+
+    // Calls member(key) for each member of the object at the cursor, which must consume the
+    // value. A key that needs unescaping fails the walk, so no member is ever mistaken.
+    template <typename Member> bool forEachMember(Member member) {
+      if (!consume('{')) {
+        return false;
+      }
+      if (consume('}')) {
+        return true;
+      }
+      for (;;) {
+        std::string_view key;
+        if (!string(key) || key.find('\\') != std::string_view::npos || !consume(':') ||
+            !member(key)) {
+          return false;
+        }
+        if (consume('}')) {
+          return true;
+        }
+        if (!consume(',')) {
+          return false;
+        }
+      }
+    }
+
+    bool peek(char c) {
+      skipWhitespace();
+      return pos_ != end_ && *pos_ == c;
+    }
+    bool peekArray() {
+      return peek('[');
+    }
+
+    // The raw contents of the string at the cursor
+    bool string(std::string_view& contents) {
+      if (!peek('"')) {
+        return false;
+      }
+      const char* start = ++pos_;
+      if (!skipStringBody()) {
+        return false;
+      }
+      contents = std::string_view(start, static_cast<size_t>(pos_ - 1 - start));
+      return true;
+    }
+
+    // Parse a number at the cursor. Anything else is skipped and reported through isNumber.
+    bool number(double& value, bool& isNumber) {
+      skipWhitespace();
+      isNumber = false;
+      if (pos_ != end_ && (*pos_ == '-' || isDigit(*pos_))) {
+        if (const char* next = parseFast(pos_, end_, value)) {
+          pos_ = next;
+          isNumber = true;
+          return true;
+        }
+        auto [next, error] = std::from_chars(pos_, end_, value);
+        if (error != std::errc() && error != std::errc::result_out_of_range) {
+          return false;
+        }
+        pos_ = next;
+        isNumber = error == std::errc();
+        return true;
+      }
+      return skipValue();
+    }
+
+    // Step over one value of any type, strings may hold brackets so they are read through
+    bool skipValue() {
+      skipWhitespace();
+      if (pos_ == end_) {
+        return false;
+      }
+      if (*pos_ == '"') {
+        ++pos_;
+        return skipStringBody();
+      }
+      if (*pos_ != '[' && *pos_ != '{') {
+        // A bare literal or number ends at the next delimiter, and cannot be empty
+        const char* start = pos_;
+        while (pos_ != end_ && *pos_ != ',' && *pos_ != ']' && *pos_ != '}' &&
+               !isWhitespace(*pos_)) {
+          ++pos_;
+        }
+        return pos_ != start;
+      }
+      size_t depth = 0;
+      while (pos_ != end_) {
+        // Numbers and separators make up most of a container, only brackets and quotes matter
+        while (pos_ != end_ && !NESTING[static_cast<unsigned char>(*pos_)]) {
+          ++pos_;
+        }
+        if (pos_ == end_) {
+          break;
+        }
+        char c = *pos_++;
+        if (c == '"') {
+          if (!skipStringBody()) {
+            return false;
+          }
+        } else if (c == '[' || c == '{') {
+          ++depth;
+        } else if (--depth == 0) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+  private:
+    const char* pos_;
+    const char* end_;
+
+    static bool isWhitespace(char c) {
+      return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    void skipWhitespace() {
+      while (pos_ != end_ && isWhitespace(*pos_)) {
+        ++pos_;
+      }
+    }
+
+    bool consume(char expected) {
+      skipWhitespace();
+      if (pos_ != end_ && *pos_ == expected) {
+        ++pos_;
+        return true;
+      }
+      return false;
+    }
+
+    bool skipStringBody() {
+      while (pos_ != end_) {
+        char c = *pos_++;
+        if (c == '\\') {
+          if (pos_ == end_) {
+            return false;
+          }
+          ++pos_;
+        } else if (c == '"') {
+          return true;
+        }
+      }
+      return false;
+    }
+};
+
+// [lon, lat, ...], extra members such as altitude are skipped
+bool decodePosition(Scanner& scanner, FlatMultiPolygon& out) {
+  double lon = 0.0;
+  double lat = 0.0;
+  const char* start = scanner.position();
+  if (scanner.numberPair(lon, lat)) {
+    out.addPoint(lon, lat);
+    return true;
+  }
+  scanner.rewind(start);
+
+  bool valid = true;
+  size_t count = 0;
+  bool ok = scanner.forEach([&](size_t index) {
+    count = index + 1;
+    if (index >= 2) {
+      return scanner.skipValue();
+    }
+    bool isNumber = false;
+    if (!scanner.number(index == 0 ? lon : lat, isNumber)) {
+      return false;
+    }
+    valid = valid && isNumber;
+    return true;
+  });
+  if (ok && valid && count >= 2) {
+    out.addPoint(lon, lat);
+  }
+  return ok;
+}
+
+template <typename Decode> bool arrayElementsOrSkip(Scanner& scanner, Decode decode) {
+  return scanner.forEach(
+      [&](size_t) { return scanner.peekArray() ? decode() : scanner.skipValue(); });
+}
+
+bool decodePolygon(Scanner& scanner, FlatMultiPolygon& out) {
+  bool ok = arrayElementsOrSkip(scanner, [&]() {
+    bool ringOk = arrayElementsOrSkip(scanner, [&]() { return decodePosition(scanner, out); });
+    out.closeRing();
+    return ringOk;
+  });
+  out.closePolygon();
+  return ok;
+}
+
+bool decodeCoordinates(Scanner& scanner, GeometryKind kind, FlatMultiPolygon& out) {
+  if (!scanner.peekArray()) {
+    return false;
+  }
+  return kind == GeometryKind::POLYGON
+             ? decodePolygon(scanner, out)
+             : arrayElementsOrSkip(scanner, [&]() { return decodePolygon(scanner, out); });
+}
+
+// The members of a geometry object. The type has to come first so the coordinates can be
+// decoded where they stand, the first occurrence of each wins as with simdjson's DOM lookups.
+bool decodeGeometryMembers(Scanner& scanner, FlatMultiPolygon& out) {
+  std::string_view type;
+  bool seenType = false;
+  bool decoded = false;
+  scanner.forEachMember([&](std::string_view key) {
+    if (key == "type" && !seenType) {
+      seenType = true;
+      return scanner.string(type);
+    }
+    if (key != "coordinates") {
+      return scanner.skipValue();
+    }
+    // Decoding stops here either way, what follows need not be read
+    if (type == "Polygon") {
+      decoded = decodeCoordinates(scanner, GeometryKind::POLYGON, out);
+    } else if (type == "MultiPolygon") {
+      decoded = decodeCoordinates(scanner, GeometryKind::MULTI_POLYGON, out);
+    }
+    return false;
+  });
+  return decoded;
+}
+
+} // namespace
+
+bool decodeFeatureGeometry(std::string_view document, FlatMultiPolygon& out) {
+  Scanner scanner(document);
+  // Members are aborted with false once the geometry is decoded
+  bool decoded = false;
+  bool seenFeatures = false;
+  scanner.forEachMember([&](std::string_view key) {
+    if (key != "features" || seenFeatures) {
+      return scanner.skipValue();
+    }
+    seenFeatures = true;
+    return scanner.forEach([&](size_t index) {
+      if (index > 0) {
+        return false;
+      }
+      return scanner.forEachMember([&](std::string_view featureKey) {
+        if (featureKey != "geometry") {
+          return scanner.skipValue();
+        }
+        decoded = decodeGeometryMembers(scanner, out);
+        return false;
+      });
+    });
+  });
+  return decoded;
+}
+
+bool decodeGeometry(std::string_view object, FlatMultiPolygon& out) {
+  Scanner scanner(object);
+  return decodeGeometryMembers(scanner, out);
+}
+
+bool decodeCoordinates(std::string_view json, GeometryKind kind, FlatMultiPolygon& out) {
+  Scanner scanner(json);
+  return decodeCoordinates(scanner, kind, out) && scanner.atEnd();
+}
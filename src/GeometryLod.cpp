@@ -0,0 +1,344 @@
+#include "GeometryLod.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+// Web Mercator tiles are 256 px wide and cover 360 degrees of longitude at zoom 0
+static constexpr double TILE_SIZE = 256.0;
+static constexpr double TOLERANCE_PIXELS = 0.5;
+// Halvings of the tolerance tried before a polygon is kept unsimplified
+static constexpr int MAX_ATTEMPTS = 4;
+// Bounds the crossing check's grid so a huge ring cannot allocate a huge grid
+static constexpr size_t MAX_GRID_SIDE = 256;
+// A closed ring needs three corners plus the repeated first point
+static constexpr size_t MIN_RING_POINTS = 4;
+
+namespace {
+
+struct Point {
+    double x;
+    double y;
+};
+
+struct Segment {
+    Point a;
+    Point b;
+    uint32_t ring;
+    uint32_t index;
+    uint32_t ringSegments;
+};
+
+double distanceSquared(const Point& p, const Point& a, const Point& b) {
+  double dx = b.x - a.x;
+  double dy = b.y - a.y;
+  double lengthSquared = (dx * dx) + (dy * dy);
+  double t = 0.0;
+  if (lengthSquared > 0.0) {
+    t = std::clamp((((p.x - a.x) * dx) + ((p.y - a.y) * dy)) / lengthSquared, 0.0, 1.0);
+  }
+  double ex = a.x + (t * dx) - p.x;
+  double ey = a.y + (t * dy) - p.y;
+  return (ex * ex) + (ey * ey);
+}
+
+// Keep the point furthest from each chord while it is further than the tolerance
+void markChain(const std::vector<Point>& points, size_t first, size_t last,
+               double toleranceSquared, std::vector<uint8_t>& keep) {
+  std::vector<std::pair<size_t, size_t>> pending{{first, last}};
+  while (!pending.empty()) {
+    auto [a, b] = pending.back();
+    pending.pop_back();
+
+    double furthest = 0.0;
+    size_t index = a;
+    for (size_t i = a + 1; i < b; ++i) {
+      double d = distanceSquared(points[i], points[a], points[b]);
+      if (d > furthest) {
+        furthest = d;
+        index = i;
+      }
+    }
+    if (furthest > toleranceSquared) {
+      keep[index] = 1;
+      pending.emplace_back(a, index);
+      pending.emplace_back(index, b);
+    }
+  }
+}
+
+// Simplify one ring into out. The ring is split at the point furthest from its start, so a
+// closed ring, whose two ends coincide, still has a chord to measure against.
+void simplifyRing(const FlatMultiPolygon::Ring& ring, double yScale, double toleranceSquared,
+                  FlatMultiPolygon& out) {
+  size_t count = ring.size();
+  if (count <= MIN_RING_POINTS) {
+    for (const auto& [lon, lat] : ring) {
+      out.addPoint(lon, lat);
+    }
+    out.closeRing();
+    return;
+  }
+
+  std::vector<Point> points;
+  points.reserve(count);
+  for (const auto& [lon, lat] : ring) {
+    points.push_back({lon, lat * yScale});
+  }
+
+  size_t split = 0;
+  double furthest = -1.0;
+  for (size_t i = 1; i < count - 1; ++i) {
+    double dx = points[i].x - points[0].x;
+    double dy = points[i].y - points[0].y;
+    if ((dx * dx) + (dy * dy) > furthest) {
+      furthest = (dx * dx) + (dy * dy);
+      split = i;
+    }
+  }
+
+  std::vector<uint8_t> keep(count, 0);
+  keep[0] = keep[split] = keep[count - 1] = 1;
+  markChain(points, 0, split, toleranceSquared, keep);
+  markChain(points, split, count - 1, toleranceSquared, keep);
+
+  // A ring flattened to a line would vanish, so keep its widest point as a third corner
+  if (std::count(keep.begin(), keep.end(), 1) < static_cast<std::ptrdiff_t>(MIN_RING_POINTS)) {
+    double widest = -1.0;
+    size_t corner = 0;
+    for (size_t i = 1; i < count - 1; ++i) {
+      double d = distanceSquared(points[i], points[0], points[split]);
+      if (keep[i] == 0U && d > widest) {
+        widest = d;
+        corner = i;
+      }
+    }
+    keep[corner] = 1;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    if (keep[i] != 0U) {
+      Coordinate point = ring[i];
+      out.addPoint(point.first, point.second);
+    }
+  }
+  out.closeRing();
+}
+
+double orientation(const Point& a, const Point& b, const Point& c) {
+  return ((b.x - a.x) * (c.y - a.y)) - ((b.y - a.y) * (c.x - a.x));
+}
+
+bool onSegment(const Point& a, const Point& b, const Point& p) {
+  return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) && std::min(a.y, b.y) <= p.y &&
+         p.y <= std::max(a.y, b.y);
+}
+
+// A proper crossing, or the endpoints of either segment that lie on the other
+bool segmentsContact(const Segment& s, const Segment& t, std::vector<Point>& touches) {
+  double o1 = orientation(s.a, s.b, t.a);
+  double o2 = orientation(s.a, s.b, t.b);
+  double o3 = orientation(t.a, t.b, s.a);
+  double o4 = orientation(t.a, t.b, s.b);
+  if (((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0)) && ((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0))) {
+    return true;
+  }
+  touches.clear();
+  if (o1 == 0 && onSegment(s.a, s.b, t.a)) {
+    touches.push_back(t.a);
+  }
+  if (o2 == 0 && onSegment(s.a, s.b, t.b)) {
+    touches.push_back(t.b);
+  }
+  if (o3 == 0 && onSegment(t.a, t.b, s.a)) {
+    touches.push_back(s.a);
+  }
+  if (o4 == 0 && onSegment(t.a, t.b, s.b)) {
+    touches.push_back(s.b);
+  }
+  return false;
+}
+
+// Consecutive edges of a ring share a point by construction, the first and last included
+bool adjacent(const Segment& s, const Segment& t) {
+  if (s.ring != t.ring) {
+    return false;
+  }
+  uint32_t low = std::min(s.index, t.index);
+  uint32_t high = std::max(s.index, t.index);
+  return high - low == 1 || (low == 0 && high == s.ringSegments - 1);
+}
+
+// Calls onContact(crossing, touches) for non-adjacent edges of the whole geometry that cross or
+// touch, until it returns true. Edges are bucketed into a uniform grid and only edges sharing a
+// cell are tested, so parts of a MultiPolygon are checked against each other too.
+template <typename OnContact>
+bool findContacts(const FlatMultiPolygon& geometry, OnContact&& onContact) {
+  std::vector<Segment> segments;
+  uint32_t ringId = 0;
+  for (auto polygon : geometry) {
+    for (auto ring : polygon) {
+      uint32_t r = ringId++;
+      if (ring.size() < 2) {
+        continue;
+      }
+      auto ringSegments = static_cast<uint32_t>(ring.size() - 1);
+      Coordinate previous = ring[0];
+      for (uint32_t i = 0; i < ringSegments; ++i) {
+        Coordinate next = ring[i + 1];
+        segments.push_back({{previous.first, previous.second}, {next.first, next.second}, r, i,
+                            ringSegments});
+        previous = next;
+      }
+    }
+  }
+  if (segments.size() < 3) {
+    return false;
+  }
+
+  Point low = segments[0].a;
+  Point high = segments[0].a;
+  for (const auto& segment : segments) {
+    for (const Point& p : {segment.a, segment.b}) {
+      low = {std::min(low.x, p.x), std::min(low.y, p.y)};
+      high = {std::max(high.x, p.x), std::max(high.y, p.y)};
+    }
+  }
+
+  auto side = std::clamp<size_t>(
+      static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(segments.size())))), 1,
+      MAX_GRID_SIDE);
+  double width = std::max(high.x - low.x, 1e-12);
+  double height = std::max(high.y - low.y, 1e-12);
+  auto cell = [&](double value, double origin, double extent) {
+    auto index = static_cast<size_t>((value - origin) / extent * static_cast<double>(side));
+    return std::min(index, side - 1);
+  };
+
+  std::vector<std::vector<uint32_t>> cells(side * side);
+  for (uint32_t i = 0; i < segments.size(); ++i) {
+    const auto& s = segments[i];
+    size_t x0 = cell(std::min(s.a.x, s.b.x), low.x, width);
+    size_t x1 = cell(std::max(s.a.x, s.b.x), low.x, width);
+    size_t y0 = cell(std::min(s.a.y, s.b.y), low.y, height);
+    size_t y1 = cell(std::max(s.a.y, s.b.y), low.y, height);
+    for (size_t y = y0; y <= y1; ++y) {
+      for (size_t x = x0; x <= x1; ++x) {
+        cells[(y * side) + x].push_back(i);
+      }
+    }
+  }
+
+  std::vector<Point> touches;
+  for (const auto& bucket : cells) {
+    for (size_t i = 0; i < bucket.size(); ++i) {
+      for (size_t j = i + 1; j < bucket.size(); ++j) {
+        const auto& s = segments[bucket[i]];
+        const auto& t = segments[bucket[j]];
+        if (adjacent(s, t)) {
+          continue;
+        }
+        bool crossing = segmentsContact(s, t, touches);
+        if ((crossing || !touches.empty()) && onContact(crossing, touches)) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool pointBefore(const Point& a, const Point& b) {
+  return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+// Every point where two non-adjacent edges of the source touch, sorted for lookups
+std::vector<Point> touchPoints(const FlatMultiPolygon& source) {
+  std::vector<Point> points;
+  findContacts(source, [&points](bool, const std::vector<Point>& touches) {
+    points.insert(points.end(), touches.begin(), touches.end());
+    return false;
+  });
+  std::sort(points.begin(), points.end(), pointBefore);
+  return points;
+}
+
+bool introducesContacts(const FlatMultiPolygon& simplified,
+                        const std::vector<Point>& sourceTouches) {
+  return findContacts(simplified, [&](bool crossing, const std::vector<Point>& touches) {
+    return crossing || std::any_of(touches.begin(), touches.end(), [&](const Point& p) {
+             return !std::binary_search(sourceTouches.begin(), sourceTouches.end(), p,
+                                        pointBefore);
+           });
+  });
+}
+
+} // namespace
+
+GeometryLod::GeometryLod(const FlatMultiPolygon& source) {
+  for (int level = 0; level < LEVELS; ++level) {
+    levels_[level] = simplify(source, toleranceForZoom(MIN_ZOOM + level));
+  }
+}
+
+int GeometryLod::levelForZoom(double zoom) {
+  if (!(zoom > MIN_ZOOM)) { // NaN lands on the coarsest level too
+    return 0;
+  }
+  return std::min(static_cast<int>(zoom) - MIN_ZOOM, LEVELS - 1);
+}
+
+double GeometryLod::toleranceForZoom(int zoom) {
+  return TOLERANCE_PIXELS * 360.0 / (TILE_SIZE * std::ldexp(1.0, zoom));
+}
+
+FlatMultiPolygon GeometryLod::simplify(const FlatMultiPolygon& source, double tolerance) {
+  if (source.empty()) {
+    return {};
+  }
+
+  // Mercator stretches latitude by 1 / cos(lat), near enough constant across one flood area
+  double minLat = source.point(0).second;
+  double maxLat = minLat;
+  for (size_t i = 1; i < source.pointCount(); ++i) {
+    minLat = std::min(minLat, source.point(i).second);
+    maxLat = std::max(maxLat, source.point(i).second);
+  }
+  double yScale = 1.0 / std::cos((minLat + maxLat) * M_PI / 360.0);
+
+  // Rings that already touch in the source, such as a hole meeting its shell, may still touch
+  std::vector<Point> sourceTouches;
+  bool touchesFound = false;
+  double attemptTolerance = tolerance;
+  for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+    FlatMultiPolygon candidate;
+    candidate.reservePolygons(source.size());
+    candidate.reserveRings(source.ringCount());
+    for (auto polygon : source) {
+      for (auto ring : polygon) {
+        simplifyRing(ring, yScale, attemptTolerance * attemptTolerance, candidate);
+      }
+      candidate.closePolygon();
+    }
+    // Most candidates touch nowhere, so the source is only searched when one does
+    bool clean = !findContacts(candidate, [](bool, const std::vector<Point>&) { return true; });
+    if (!clean && !touchesFound) {
+      sourceTouches = touchPoints(source);
+      touchesFound = true;
+    }
+    if (clean || !introducesContacts(candidate, sourceTouches)) {
+      return candidate;
+    }
+    attemptTolerance /= 2.0;
+  }
+  return source;
+}
+
+bool GeometryLod::hasCrossings(const FlatMultiPolygon& geometry) {
+  return findContacts(geometry, [](bool, const std::vector<Point>&) { return true; });
+}
+
+bool GeometryLod::addsContacts(const FlatMultiPolygon& simplified,
+                               const FlatMultiPolygon& source) {
+  return introducesContacts(simplified, touchPoints(source));
+}
@@ -1,5 +1,11 @@
 #include "HttpClient.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <queue>
 #include <thread>
 
 // Static members initialization
@@ -8,15 +14,44 @@ std::once_flag HttpClient::curlInitFlag;
 IHttpClient* HttpClient::testInstance = nullptr;
 
 HttpClient::HttpClient(size_t poolSize)
-    : poolSize_(poolSize), createdHandles_(0), inUseHandles_(0) {
+    : poolSize_(poolSize), createdHandles_(0), inUseHandles_(0), share_(nullptr),
+      connectionsOpened_(0), multiHandle_(nullptr), jitterRng_(std::random_device{}()),
+      loopMulti_(nullptr), loopStopping_(false) {
   std::call_once(curlInitFlag, []() {
     curl_global_init(CURL_GLOBAL_ALL);
     curlInitialized = true;
     std::atexit(cleanupCurl);
   });
+
+  // Share DNS lookups and TLS sessions between pooled and multi transfers so a new
+  // connection can skip resolution and resume the TLS session. The connection cache itself
+  // lives in multiHandle_, as libcurl does not support sharing it across threads.
+  share_ = curl_share_init();
+  if (share_ != nullptr) {
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lockShare);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlockShare);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  } else {
+    std::cerr << "Failed to initialize curl share handle\n";
+  }
+
+  multiHandle_ = curl_multi_init();
+  if (multiHandle_ == nullptr) {
+    std::cerr << "Failed to initialize curl multi handle\n";
+  }
+
+  // Same override the curl tool honours, lets benchmarks trust a local test certificate
+  const char* caBundle = std::getenv("CURL_CA_BUNDLE"); // NOLINT(concurrency-mt-unsafe)
+  if (caBundle != nullptr) {
+    caBundle_ = caBundle;
+  }
 }
 
 HttpClient::~HttpClient() {
+  stopEventLoop();
+
   std::unique_lock<std::mutex> lock(poolMutex_);
 
   // Wait for all handles to be returned
@@ -26,6 +61,23 @@ HttpClient::~HttpClient() {
     curl_easy_cleanup(handle);
   }
   availableHandles_.clear();
+
+  // Easy handles must be gone before the multi and share handles they reference
+  if (multiHandle_ != nullptr) {
+    curl_multi_cleanup(multiHandle_);
+  }
+  if (share_ != nullptr) {
+    curl_share_cleanup(share_);
+  }
+}
+
+void HttpClient::lockShare(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/,
+                           void* userptr) {
+  static_cast<HttpClient*>(userptr)->shareMutexes_.at(data).lock();
+}
+
+void HttpClient::unlockShare(CURL* /*handle*/, curl_lock_data data, void* userptr) {
+  static_cast<HttpClient*>(userptr)->shareMutexes_.at(data).unlock();
 }
 
 void HttpClient::cleanupCurl() {
@@ -47,8 +99,14 @@ void HttpClient::setInstance(IHttpClient* instance) {
   testInstance = instance;
 }
 
-void HttpClient::applyPersistentOptions(CURL* curl) {
+void HttpClient::applyPersistentOptions(CURL* curl) const {
   // Set common options that persist across requests
+  if (share_ != nullptr) {
+    curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+  }
+  if (!caBundle_.empty()) {
+    curl_easy_setopt(curl, CURLOPT_CAINFO, caBundle_.c_str());
+  }
   curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
   curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
   curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);        // 30 second timeout
@@ -74,18 +132,45 @@ HttpClient::CurlHandle HttpClient::acquireHandle() {
     availableHandles_.pop_front();
   } else {
     // Otherwise, create a new handle
-    handle = curl_easy_init();
+    handle = createHandle();
     if (handle == nullptr) {
-      std::cerr << "Failed to initialize curl handle\n";
       return {nullptr, this};
     }
-    applyPersistentOptions(handle);
-    createdHandles_++;
   }
   inUseHandles_++;
   return {handle, this};
 }
 
+std::optional<HttpClient::CurlHandle> HttpClient::tryAcquireHandle() {
+  std::unique_lock<std::mutex> lock(poolMutex_);
+
+  CURL* handle = nullptr;
+  if (!availableHandles_.empty()) {
+    handle = availableHandles_.front();
+    availableHandles_.pop_front();
+  } else if (createdHandles_ < poolSize_) {
+    handle = createHandle();
+  }
+
+  if (handle == nullptr) {
+    return std::nullopt;
+  }
+  inUseHandles_++;
+  return CurlHandle(handle, this);
+}
+
+// Caller must hold poolMutex_
+CURL* HttpClient::createHandle() {
+  CURL* handle = curl_easy_init();
+  if (handle == nullptr) {
+    std::cerr << "Failed to initialize curl handle\n";
+    return nullptr;
+  }
+  applyPersistentOptions(handle);
+  createdHandles_++;
+  return handle;
+}
+
 void HttpClient::returnHandle(CURL* handle) {
   if (handle == nullptr) {
     return;
@@ -97,11 +182,117 @@ void HttpClient::returnHandle(CURL* handle) {
   poolCond_.notify_one();              // Notify one waiting thread that a handle is available
 }
 
-size_t HttpClient::writeCallback(void* contents, size_t size, size_t nmemb, std::string* userp) {
+size_t HttpClient::writeCallback(void* contents, size_t size, size_t nmemb,
+                                 ResponseBuffer* userp) {
   userp->append(static_cast<char*>(contents), size * nmemb);
   return size * nmemb;
 }
 
+size_t HttpClient::headerCallback(char* buffer, size_t size, size_t nitems,
+                                 CacheValidators* userp) {
+  size_t length = size * nitems;
+  std::string_view line(buffer, length);
+
+  // A new status line means a redirect or 1xx response, only the final headers count
+  if (line.rfind("HTTP/", 0) == 0) {
+    *userp = CacheValidators{};
+    return length;
+  }
+
+  size_t colon = line.find(':');
+  if (colon == std::string_view::npos) {
+    return length;
+  }
+
+  std::string name(line.substr(0, colon));
+  std::transform(name.begin(), name.end(), name.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+  std::string_view value = line.substr(colon + 1);
+  size_t start = value.find_first_not_of(" \t");
+  size_t end = value.find_last_not_of(" \t\r\n");
+  value = (start == std::string_view::npos) ? std::string_view{}
+                                            : value.substr(start, end - start + 1);
+
+  if (name == "etag") {
+    userp->etag = std::string(value);
+  } else if (name == "last-modified") {
+    userp->lastModified = std::string(value);
+  }
+  return length;
+}
+
+void HttpClient::recordTransfer(CURL* curl, CURLcode result, const std::string& url) {
+  long connects = 0;
+  if (curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects) == CURLE_OK && connects > 0) {
+    connectionsOpened_ += static_cast<size_t>(connects);
+  }
+
+  // libcurl's timers are cumulative from the start of the request, split them into phases
+  curl_off_t nameLookup = 0;
+  curl_off_t connect = 0;
+  curl_off_t appConnect = 0;
+  curl_off_t startTransfer = 0;
+  curl_off_t total = 0;
+  curl_off_t bytesDown = 0;
+  curl_off_t bytesUp = 0;
+  long requestSize = 0;
+  long httpCode = 0;
+  curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &nameLookup);
+  curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+  curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+  curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &startTransfer);
+  curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+  curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &bytesDown);
+  curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &bytesUp);
+  curl_easy_getinfo(curl, CURLINFO_REQUEST_SIZE, &requestSize);
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+
+  // A timer a later phase never reached reads 0, the gaps are clamped rather than negative
+  auto span = [](curl_off_t from, curl_off_t to) {
+    return to > from ? static_cast<uint64_t>(to - from) : 0;
+  };
+  curl_off_t handshakeDone = std::max(connect, appConnect);
+
+  RequestTiming timing;
+  auto phase = [&timing](TimingPhase p) -> uint64_t& {
+    return timing.phases.at(static_cast<size_t>(p));
+  };
+  phase(TimingPhase::DNS) = span(0, nameLookup);
+  phase(TimingPhase::CONNECT) = span(nameLookup, connect);
+  phase(TimingPhase::TLS) = span(connect, appConnect);
+  phase(TimingPhase::FIRST_BYTE) = span(handshakeDone, startTransfer);
+  phase(TimingPhase::TRANSFER) = span(startTransfer, total);
+  phase(TimingPhase::TOTAL) = span(0, total);
+  timing.tls = appConnect > 0;
+  timing.bytesDown = bytesDown > 0 ? static_cast<uint64_t>(bytesDown) : 0;
+  timing.bytesUp = static_cast<uint64_t>(std::max<long>(requestSize, 0)) +
+                   (bytesUp > 0 ? static_cast<uint64_t>(bytesUp) : 0);
+  timing.failed = result != CURLE_OK || (httpCode != 200 && httpCode != 304);
+
+  HttpMetrics::getInstance().record(url, timing);
+}
+
+std::optional<std::string> HttpClient::finishTransfer(CURL* curl, CURLcode result,
+                                                      const std::string& url,
+                                                      ResponseBuffer& buffer) {
+  recordTransfer(curl, result, url);
+
+  if (result != CURLE_OK) {
+    std::cerr << "CURL error for " << url << ": " << curl_easy_strerror(result) << '\n';
+    return std::nullopt;
+  }
+
+  long httpCode = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+  if (httpCode != 200) {
+    std::cerr << "HTTP Error " << httpCode << " for URL: " << url << '\n';
+    return std::nullopt;
+  }
+
+  return buffer.release();
+}
+
 std::optional<std::string> HttpClient::fetchUrl(const std::string& url) {
   CurlHandle curlWrapper = acquireHandle();
   CURL* curl = curlWrapper.get();
@@ -111,80 +302,572 @@ std::optional<std::string> HttpClient::fetchUrl(const std::string& url) {
     return std::nullopt;
   }
 
-  std::string readBuffer;
+  ResponseBuffer readBuffer(curl);
   curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
   curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
 
   CURLcode res = curl_easy_perform(curl);
+  return finishTransfer(curl, res, url, readBuffer);
+}
+
+CacheValidators HttpClient::rememberedValidators(const std::string& url) {
+  std::lock_guard<std::mutex> lock(validatorsMutex_);
+  auto it = validators_.find(url);
+  return it != validators_.end() ? it->second : CacheValidators{};
+}
+
+curl_slist* HttpClient::conditionalHeaders(const CacheValidators& validators) {
+  curl_slist* headers = nullptr;
+  if (!validators.etag.empty()) {
+    headers = curl_slist_append(headers, ("If-None-Match: " + validators.etag).c_str());
+  }
+  if (!validators.lastModified.empty()) {
+    headers =
+        curl_slist_append(headers, ("If-Modified-Since: " + validators.lastModified).c_str());
+  }
+  return headers;
+}
+
+void HttpClient::clearConditionalOptions(CURL* curl) {
+  // Handles are reused, so drop the per-request header state
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+  curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, nullptr);
+  curl_easy_setopt(curl, CURLOPT_HEADERDATA, nullptr);
+}
+
+FetchResult HttpClient::finishConditional(CURL* curl, CURLcode result, const std::string& url,
+                                          ResponseBuffer& buffer, CacheValidators& received) {
   long httpCode = 0;
   curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+  if (result == CURLE_OK && httpCode == 304) {
+    recordTransfer(curl, result, url);
+    return {FetchStatus::NOT_MODIFIED, std::nullopt, {}};
+  }
 
-  if (res != CURLE_OK) {
-    std::cerr << "CURL error for " << url << ": " << curl_easy_strerror(res) << '\n';
-    return std::nullopt;
+  auto body = finishTransfer(curl, result, url, buffer);
+  if (!body) {
+    return {};
   }
 
-  if (httpCode != 200) {
-    std::cerr << "HTTP Error " << httpCode << " for URL: " << url << '\n';
-    return std::nullopt;
+  FetchResult outcome{FetchStatus::OK, std::move(body), received};
+  {
+    std::lock_guard<std::mutex> lock(validatorsMutex_);
+    if (received.empty()) {
+      validators_.erase(url);
+    } else {
+      validators_[url] = std::move(received);
+    }
+  }
+  return outcome;
+}
+
+FetchResult HttpClient::fetchUrlIfModified(const std::string& url) {
+  CurlHandle curlWrapper = acquireHandle();
+  CURL* curl = curlWrapper.get();
+
+  if (curl == nullptr) {
+    std::cerr << "No curl handle available for URL: " << url << '\n';
+    return {};
+  }
+
+  curl_slist* headers = conditionalHeaders(rememberedValidators(url));
+  ResponseBuffer readBuffer(curl);
+  CacheValidators received;
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+  curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+  curl_easy_setopt(curl, CURLOPT_HEADERDATA, &received);
+
+  CURLcode res = curl_easy_perform(curl);
+
+  clearConditionalOptions(curl);
+  curl_slist_free_all(headers);
+
+  return finishConditional(curl, res, url, readBuffer, received);
+}
+
+void HttpClient::fetchAsync(const std::string& url, bool ifModified, ResultHandler onComplete) {
+  auto request = std::make_unique<AsyncRequest>();
+  request->url = url;
+  request->ifModified = ifModified;
+  if (ifModified) {
+    request->sent = rememberedValidators(url);
+  }
+  request->onComplete = std::move(onComplete);
+  queueAsync(std::move(request));
+}
+
+void HttpClient::fetchAsync(const std::string& url, const CacheValidators& validators,
+                            ResultHandler onComplete) {
+  auto request = std::make_unique<AsyncRequest>();
+  request->url = url;
+  request->ifModified = true;
+  request->sent = validators;
+  request->onComplete = std::move(onComplete);
+  queueAsync(std::move(request));
+}
+
+void HttpClient::queueAsync(std::unique_ptr<AsyncRequest> request) {
+  std::call_once(loopStartFlag_, [this]() {
+    loopMulti_ = curl_multi_init();
+    if (loopMulti_ == nullptr) {
+      std::cerr << "Failed to initialize curl multi handle for network thread\n";
+      return;
+    }
+    loopThread_ = std::thread(&HttpClient::runEventLoop, this);
+  });
+
+  {
+    std::lock_guard<std::mutex> lock(loopMutex_);
+    if (loopMulti_ != nullptr && !loopStopping_) {
+      loopQueue_.push_back(std::move(request));
+    }
+  }
+
+  if (request) {
+    // Loop never started or is shutting down
+    request->onComplete({});
+    return;
+  }
+  curl_multi_wakeup(loopMulti_);
+}
+
+void HttpClient::stopEventLoop() {
+  {
+    std::lock_guard<std::mutex> lock(loopMutex_);
+    loopStopping_ = true;
+  }
+  if (loopThread_.joinable()) {
+    curl_multi_wakeup(loopMulti_);
+    loopThread_.join();
   }
+  if (loopMulti_ != nullptr) {
+    curl_multi_cleanup(loopMulti_);
+    loopMulti_ = nullptr;
+  }
+}
+
+void HttpClient::runEventLoop() {
+  // The loop owns its handles, they share DNS and TLS sessions with the pool
+  std::vector<CURL*> idleHandles;
+  std::unordered_map<CURL*, std::unique_ptr<AsyncRequest>> active;
+
+  auto complete = [](AsyncRequest& request, FetchResult result) {
+    try {
+      request.onComplete(std::move(result));
+    } catch (const std::exception& e) {
+      std::cerr << "Completion handler failed for " << request.url << ": " << e.what() << '\n';
+    }
+  };
+
+  auto release = [&](CURL* handle, AsyncRequest& request) {
+    curl_multi_remove_handle(loopMulti_, handle);
+    if (request.ifModified) {
+      clearConditionalOptions(handle);
+      curl_slist_free_all(request.headers);
+      request.headers = nullptr;
+    }
+    if (idleHandles.size() < poolSize_) {
+      idleHandles.push_back(handle);
+    } else {
+      curl_easy_cleanup(handle);
+    }
+  };
+
+  for (;;) {
+    // Admit queued requests up to the pool size
+    std::deque<std::unique_ptr<AsyncRequest>> incoming;
+    bool stopping = false;
+    {
+      std::lock_guard<std::mutex> lock(loopMutex_);
+      stopping = loopStopping_;
+      while (!loopQueue_.empty() && active.size() + incoming.size() < poolSize_) {
+        incoming.push_back(std::move(loopQueue_.front()));
+        loopQueue_.pop_front();
+      }
+      if (stopping) {
+        std::move(loopQueue_.begin(), loopQueue_.end(), std::back_inserter(incoming));
+        loopQueue_.clear();
+      }
+    }
+
+    if (stopping) {
+      for (auto& request : incoming) {
+        complete(*request, {});
+      }
+      for (auto& [handle, request] : active) {
+        release(handle, *request);
+        complete(*request, {});
+      }
+      break;
+    }
 
-  return readBuffer;
+    for (auto& request : incoming) {
+      CURL* handle = nullptr;
+      if (!idleHandles.empty()) {
+        handle = idleHandles.back();
+        idleHandles.pop_back();
+      } else {
+        handle = curl_easy_init();
+        if (handle == nullptr) {
+          std::cerr << "Failed to initialize curl handle for URL: " << request->url << '\n';
+          complete(*request, {});
+          continue;
+        }
+        applyPersistentOptions(handle);
+      }
+
+      request->buffer.reset(handle);
+      curl_easy_setopt(handle, CURLOPT_URL, request->url.c_str());
+      curl_easy_setopt(handle, CURLOPT_WRITEDATA, &request->buffer);
+      if (request->ifModified) {
+        request->headers = conditionalHeaders(request->sent);
+        curl_easy_setopt(handle, CURLOPT_HTTPHEADER, request->headers);
+        curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, headerCallback);
+        curl_easy_setopt(handle, CURLOPT_HEADERDATA, &request->received);
+      }
+      curl_multi_add_handle(loopMulti_, handle);
+      active.emplace(handle, std::move(request));
+    }
+
+    int stillRunning = 0;
+    CURLMcode mc = curl_multi_perform(loopMulti_, &stillRunning);
+    if (mc != CURLM_OK) {
+      std::cerr << "curl_multi_perform error: " << curl_multi_strerror(mc) << '\n';
+    }
+
+    CURLMsg* msg = nullptr;
+    int msgsLeft = 0;
+    while ((msg = curl_multi_info_read(loopMulti_, &msgsLeft)) != nullptr) {
+      if (msg->msg != CURLMSG_DONE) {
+        continue;
+      }
+
+      CURL* handle = msg->easy_handle;
+      CURLcode result = msg->data.result;
+      auto it = active.find(handle);
+      if (it == active.end()) {
+        continue;
+      }
+      std::unique_ptr<AsyncRequest> request = std::move(it->second);
+      active.erase(it);
+
+      FetchResult outcome;
+      if (request->ifModified) {
+        outcome =
+            finishConditional(handle, result, request->url, request->buffer, request->received);
+      } else {
+        auto body = finishTransfer(handle, result, request->url, request->buffer);
+        outcome.status = body ? FetchStatus::OK : FetchStatus::FAILED;
+        outcome.body = std::move(body);
+      }
+      release(handle, *request);
+      complete(*request, std::move(outcome));
+    }
+
+    // Sleep until there is network activity or curl_multi_wakeup from a new submission,
+    // unless queued requests can take the slots that just freed up
+    bool admitMore = false;
+    {
+      std::lock_guard<std::mutex> lock(loopMutex_);
+      admitMore = !loopQueue_.empty() && active.size() < poolSize_;
+    }
+    mc = curl_multi_poll(loopMulti_, nullptr, 0, admitMore ? 0 : 1000, nullptr);
+    if (mc != CURLM_OK) {
+      std::cerr << "curl_multi_poll error: " << curl_multi_strerror(mc) << '\n';
+    }
+  }
+
+  for (CURL* handle : idleHandles) {
+    curl_easy_cleanup(handle);
+  }
 }
 
 std::vector<std::optional<std::string>>
 HttpClient::fetchUrls(const std::vector<std::string>& urls) {
   std::vector<std::optional<std::string>> results(urls.size());
 
+  fetchUrls(
+      urls,
+      [&results](size_t index, std::optional<std::string> body) {
+        results[index] = std::move(body);
+      },
+      FetchOptions{});
+
+  return results;
+}
+
+void HttpClient::fetchUrls(const std::vector<std::string>& urls,
+                           const CompletionHandler& onComplete, const FetchOptions& options) {
   if (urls.empty()) {
-    return results;
+    return;
   }
 
-  CURLM* multiHandle = curl_multi_init();
-  if (multiHandle == nullptr) {
-    std::cerr << "Failed to initialize curl multi handle\n";
-    return results;
+  // One batch at a time drives the shared multi handle
+  std::lock_guard<std::mutex> multiLock(multiMutex_);
+  if (multiHandle_ == nullptr) {
+    std::cerr << "No curl multi handle available\n";
+    for (size_t i = 0; i < urls.size(); ++i) {
+      onComplete(i, std::nullopt);
+    }
+    return;
+  }
+  curl_multi_setopt(multiHandle_, CURLMOPT_MAX_HOST_CONNECTIONS, options.maxPerHost);
+
+  const bool multiplex = options.http2Multiplex;
+  const long streams =
+      options.maxConcurrentStreams > 0 ? options.maxConcurrentStreams : DEFAULT_CONCURRENT_STREAMS;
+  if (multiplex) {
+    curl_multi_setopt(multiHandle_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multiHandle_, CURLMOPT_MAX_CONCURRENT_STREAMS, streams);
   }
 
-  // Map easy handles to their request data
-  std::unordered_map<CURL*, MultiRequest*> handleMap;
-  std::vector<MultiRequest> requests(urls.size());
+  // Borrow warm handles from the pool. Wait for the first one, take any others that are free
+  // right now (leaving one for concurrent fetchUrl callers), and cycle the URLs through them
+  // as transfers complete. Streams are cheap, so a multiplexed batch tops the window up with
+  // unpooled handles that live for this batch only.
+  size_t window = multiplex ? static_cast<size_t>(streams) : std::max<size_t>(1, poolSize_ - 1);
+  window = std::min(urls.size(), window);
+  if (options.maxInFlight > 0) {
+    window = std::min(window, options.maxInFlight);
+  }
+  const size_t hedgeSlots = options.hedge.percentile > 0 ? options.hedge.maxHedges : 0;
+  std::vector<MultiRequest> requests;
+  requests.reserve(window + hedgeSlots);
+  requests.push_back(MultiRequest{acquireHandle(), {}, 0, false, {}});
+  while (requests.size() < window) {
+    auto handle = tryAcquireHandle();
+    if (!handle) {
+      break;
+    }
+    requests.push_back(MultiRequest{std::move(*handle), {}, 0, false, {}});
+  }
+  while (multiplex && requests.size() < window) {
+    CURL* handle = curl_easy_init();
+    if (handle == nullptr) {
+      break;
+    }
+    applyPersistentOptions(handle);
+    requests.push_back(MultiRequest{CurlHandle(handle, nullptr), {}, 0, false, {}});
+  }
 
-  // Add all URLs to multi handle
-  for (size_t i = 0; i < urls.size(); ++i) {
-    requests[i].handle = curl_easy_init();
-    if (requests[i].handle == nullptr) {
-      std::cerr << "Failed to initialize curl handle for URL: " << urls[i] << '\n';
-      continue;
+  // Hedged duplicates run on their own unpooled handles so they never hold up new URLs
+  const size_t primarySlots = requests.size();
+  for (size_t i = 0; i < hedgeSlots; ++i) {
+    CURL* handle = curl_easy_init();
+    if (handle == nullptr) {
+      break;
     }
+    applyPersistentOptions(handle);
+    requests.push_back(MultiRequest{CurlHandle(handle, nullptr), {}, 0, false, {}});
+  }
 
-    requests[i].index = i;
+  if (multiplex) {
+    // Wait for an existing connection to confirm multiplexing instead of opening another
+    for (auto& req : requests) {
+      if (req.handle.get() != nullptr) {
+        curl_easy_setopt(req.handle.get(), CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_0);
+        curl_easy_setopt(req.handle.get(), CURLOPT_PIPEWAIT, 1L);
+      }
+    }
+  }
 
-    // Apply persistent options
-    applyPersistentOptions(requests[i].handle);
+  using Clock = std::chrono::steady_clock;
+  struct UrlState {
+      int attempts = 0; // Excluding hedged duplicates
+      int running = 0;
+      bool hedged = false;
+      bool done = false;
+  };
+  std::vector<UrlState> state(urls.size());
+
+  // Failed transfers waiting out their backoff, earliest first
+  using Retry = std::pair<Clock::time_point, size_t>;
+  std::priority_queue<Retry, std::vector<Retry>, std::greater<>> retries;
+  const int maxAttempts = std::max(1, options.retry.maxAttempts);
+
+  std::optional<std::chrono::milliseconds> hedgeAfter;
+  auto updateHedgeThreshold = [&]() {
+    if (hedgeSlots == 0) {
+      return;
+    }
+    auto latency = latencyPercentile(options.hedge.percentile);
+    if (latency) {
+      hedgeAfter = std::max(*latency, options.hedge.minDelay);
+    }
+  };
+  updateHedgeThreshold();
+
+  int running = 0;
+  size_t nextUrl = 0;
+  auto launch = [&](MultiRequest& req, size_t index, bool countAttempt) {
+    req.index = index;
+    req.active = true;
+    req.started = Clock::now();
+    req.buffer.reset(req.handle.get());
 
     // Set URL-specific options
-    curl_easy_setopt(requests[i].handle, CURLOPT_URL, urls[i].c_str());
-    curl_easy_setopt(requests[i].handle, CURLOPT_WRITEDATA, &requests[i].buffer);
-    curl_easy_setopt(requests[i].handle, CURLOPT_PRIVATE, &requests[i]);
+    curl_easy_setopt(req.handle.get(), CURLOPT_URL, urls[index].c_str());
+    curl_easy_setopt(req.handle.get(), CURLOPT_WRITEDATA, &req.buffer);
+    curl_easy_setopt(req.handle.get(), CURLOPT_PRIVATE, &req);
+    curl_multi_add_handle(multiHandle_, req.handle.get());
 
-    handleMap[requests[i].handle] = &requests[i];
-    curl_multi_add_handle(multiHandle, requests[i].handle);
-  }
+    if (countAttempt) {
+      state[index].attempts++;
+    }
+    state[index].running++;
+    running++;
+  };
+
+  auto detach = [&](MultiRequest& req) {
+    curl_multi_remove_handle(multiHandle_, req.handle.get());
+    req.active = false;
+    state[req.index].running--;
+    running--;
+  };
+
+  // Give every free primary slot a retry whose backoff has elapsed, or else the next new URL
+  auto fillSlots = [&]() {
+    for (size_t i = 0; i < primarySlots; ++i) {
+      MultiRequest& req = requests[i];
+      if (req.active || req.handle.get() == nullptr) {
+        continue;
+      }
+      if (!retries.empty() && retries.top().first <= Clock::now()) {
+        size_t index = retries.top().second;
+        retries.pop();
+        launch(req, index, true);
+      } else if (nextUrl < urls.size()) {
+        launch(req, nextUrl++, true);
+      } else {
+        break;
+      }
+    }
+  };
+
+  auto deliver = [&](size_t index, std::optional<std::string> body) {
+    state[index].done = true;
+    try {
+      onComplete(index, std::move(body));
+    } catch (const std::exception& e) {
+      std::cerr << "Completion handler failed for " << urls[index] << ": " << e.what() << '\n';
+    }
+  };
+
+  fillSlots();
 
   // Perform all requests
-  int stillRunning = 1;
-  while (stillRunning != 0) {
-    CURLMcode mc = curl_multi_perform(multiHandle, &stillRunning);
+  while (running > 0 || !retries.empty()) {
+    int stillRunning = 0;
+    CURLMcode mc = curl_multi_perform(multiHandle_, &stillRunning);
 
     if (mc != CURLM_OK) {
       std::cerr << "curl_multi_perform error: " << curl_multi_strerror(mc) << '\n';
       break;
     }
 
-    if (stillRunning != 0) {
+    // Collect finished transfers and hand their handles the next URL
+    CURLMsg* msg = nullptr;
+    int msgsLeft = 0;
+    while ((msg = curl_multi_info_read(multiHandle_, &msgsLeft)) != nullptr) {
+      if (msg->msg != CURLMSG_DONE) {
+        continue;
+      }
+
+      CURL* handle = msg->easy_handle;
+      CURLcode result = msg->data.result;
+      MultiRequest* req = nullptr;
+      curl_easy_getinfo(handle, CURLINFO_PRIVATE, &req);
+      if (req == nullptr || !req->active) {
+        // Already cancelled as the losing half of a hedge
+        continue;
+      }
+
+      size_t index = req->index;
+      auto elapsed =
+          std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - req->started);
+      bool transient = isTransientFailure(handle, result);
+      detach(*req);
+      auto body = finishTransfer(handle, result, urls[index], req->buffer);
+
+      if (body) {
+        recordLatency(elapsed);
+        updateHedgeThreshold();
+
+        // First copy to succeed wins, cancel its duplicate
+        for (auto& other : requests) {
+          if (other.active && other.index == index) {
+            detach(other);
+          }
+        }
+
+        // Start the next transfer before running the handler so the network stays busy
+        fillSlots();
+        deliver(index, std::move(body));
+      } else if (state[index].running > 0) {
+        // A duplicate is still in flight and may yet succeed
+        fillSlots();
+      } else if (transient && state[index].attempts < maxAttempts) {
+        auto delay = backoffDelay(options.retry, state[index].attempts,
+                                  std::uniform_real_distribution<double>(0.0, 1.0)(jitterRng_));
+        std::cerr << "Retrying " << urls[index] << " in " << delay.count() << " ms (attempt "
+                  << state[index].attempts + 1 << " of " << maxAttempts << ")\n";
+        retries.emplace(Clock::now() + delay, index);
+        state[index].hedged = false;
+        fillSlots();
+      } else {
+        fillSlots();
+        deliver(index, std::nullopt);
+      }
+    }
+
+    // Retries that came due while every slot was busy
+    fillSlots();
+
+    // Duplicate stragglers that have run past the hedging threshold
+    auto now = Clock::now();
+    auto pollTimeout = std::chrono::milliseconds(1000);
+    if (hedgeAfter) {
+      for (size_t i = 0; i < primarySlots; ++i) {
+        MultiRequest& req = requests[i];
+        if (!req.active || state[req.index].hedged) {
+          continue;
+        }
+        auto deadline = req.started + *hedgeAfter;
+        if (deadline > now) {
+          auto untilHedge = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+          pollTimeout = std::min(pollTimeout, untilHedge);
+          continue;
+        }
+        auto spare = std::find_if(requests.begin() + static_cast<std::ptrdiff_t>(primarySlots),
+                                  requests.end(), [](const MultiRequest& candidate) {
+                                    return !candidate.active && candidate.handle.get() != nullptr;
+                                  });
+        if (spare == requests.end()) {
+          break;
+        }
+        state[req.index].hedged = true;
+        launch(*spare, req.index, false);
+      }
+    }
+
+    // Wake up in time for the next retry, as long as a slot is free to take it
+    bool slotFree = std::any_of(requests.begin(),
+                                requests.begin() + static_cast<std::ptrdiff_t>(primarySlots),
+                                [](const MultiRequest& candidate) {
+                                  return !candidate.active && candidate.handle.get() != nullptr;
+                                });
+    if (!retries.empty() && slotFree) {
+      auto untilDue =
+          std::chrono::duration_cast<std::chrono::milliseconds>(retries.top().first - now);
+      pollTimeout = std::min(pollTimeout, std::max(untilDue, std::chrono::milliseconds(0)));
+    }
+
+    if (running > 0 || !retries.empty()) {
       // Wait for activity, with timeout
-      mc = curl_multi_poll(multiHandle, nullptr, 0, 1000, nullptr);
+      mc = curl_multi_poll(multiHandle_, nullptr, 0, static_cast<int>(pollTimeout.count()),
+                           nullptr);
       if (mc != CURLM_OK) {
         std::cerr << "curl_multi_poll error: " << curl_multi_strerror(mc) << '\n';
         break;
@@ -192,43 +875,75 @@ HttpClient::fetchUrls(const std::vector<std::string>& urls) {
     }
   }
 
-  // Check results
-  CURLMsg* msg = nullptr;
-  int msgsLeft = 0;
-
-  while ((msg = curl_multi_info_read(multiHandle, &msgsLeft)) != nullptr) {
-    if (msg->msg == CURLMSG_DONE) {
-      CURL* handle = msg->easy_handle;
-      auto it = handleMap.find(handle);
-
-      if (it != handleMap.end()) {
-        MultiRequest* req = it->second;
-        long httpCode = 0;
-        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &httpCode);
-
-        if (msg->data.result == CURLE_OK && httpCode == 200) {
-          results[req->index] = std::move(req->buffer);
-        } else {
-          if (msg->data.result != CURLE_OK) {
-            std::cerr << "CURL error for " << urls[req->index] << ": "
-                      << curl_easy_strerror(msg->data.result) << '\n';
-          } else {
-            std::cerr << "HTTP Error " << httpCode << " for URL: " << urls[req->index] << '\n';
-          }
-          results[req->index] = std::nullopt;
-        }
+  // Detach anything left over from an aborted loop before the handles go back to the pool
+  for (auto& req : requests) {
+    if (req.handle.get() != nullptr) {
+      curl_multi_remove_handle(multiHandle_, req.handle.get());
+      curl_easy_setopt(req.handle.get(), CURLOPT_PRIVATE, nullptr);
+      if (multiplex) {
+        curl_easy_setopt(req.handle.get(), CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_NONE);
+        curl_easy_setopt(req.handle.get(), CURLOPT_PIPEWAIT, 0L);
       }
     }
   }
+  curl_multi_setopt(multiHandle_, CURLMOPT_MAX_HOST_CONNECTIONS, 0L);
+  if (multiplex) {
+    curl_multi_setopt(multiHandle_, CURLMOPT_MAX_CONCURRENT_STREAMS, DEFAULT_CONCURRENT_STREAMS);
+  }
 
-  // Cleanup
-  for (auto& req : requests) {
-    if (req.handle != nullptr) {
-      curl_multi_remove_handle(multiHandle, req.handle);
-      curl_easy_cleanup(req.handle);
+  // Every URL gets exactly one callback, even when the loop bailed out early
+  for (size_t i = 0; i < urls.size(); ++i) {
+    if (!state[i].done) {
+      onComplete(i, std::nullopt);
     }
   }
-  curl_multi_cleanup(multiHandle);
+}
 
-  return results;
+std::chrono::milliseconds HttpClient::backoffDelay(const RetryPolicy& policy, int attempt,
+                                                   double jitter) {
+  // Exponential window capped at maxDelay, then a random point in its upper half so retries
+  // spread out without collapsing to an immediate hammering of the server
+  double window = static_cast<double>(policy.baseDelay.count()) *
+                  std::pow(2.0, static_cast<double>(std::max(0, attempt - 1)));
+  window = std::min(window, static_cast<double>(policy.maxDelay.count()));
+  return std::chrono::milliseconds(static_cast<int64_t>(window / 2 + (jitter * window / 2)));
+}
+
+bool HttpClient::isTransientFailure(CURL* curl, CURLcode result) {
+  switch (result) {
+    case CURLE_OK: {
+      long httpCode = 0;
+      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+      return httpCode == 408 || httpCode == 429 || httpCode >= 500;
+    }
+    case CURLE_UNSUPPORTED_PROTOCOL:
+    case CURLE_URL_MALFORMAT:
+    case CURLE_NOT_BUILT_IN:
+      return false;
+    default:
+      return true;
+  }
+}
+
+// Caller must hold multiMutex_
+void HttpClient::recordLatency(std::chrono::milliseconds latency) {
+  if (latencies_.size() < LATENCY_SAMPLES) {
+    latencies_.push_back(latency);
+  } else {
+    latencies_[nextLatency_] = latency;
+  }
+  nextLatency_ = (nextLatency_ + 1) % LATENCY_SAMPLES;
+}
+
+// Caller must hold multiMutex_
+std::optional<std::chrono::milliseconds> HttpClient::latencyPercentile(double percentile) const {
+  if (latencies_.size() < MIN_LATENCY_SAMPLES) {
+    return std::nullopt;
+  }
+  std::vector<std::chrono::milliseconds> samples = latencies_;
+  auto rank = std::min(samples.size() - 1,
+                       static_cast<size_t>(percentile * static_cast<double>(samples.size())));
+  std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank),
+                   samples.end());
+  return samples[rank];
 }
@@ -0,0 +1,196 @@
+#include "HttpMetrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+void LatencyHistogram::record(uint64_t micros) {
+  size_t bucket = 0;
+  while (bucket + 1 < BUCKETS && micros >= (uint64_t{1} << bucket)) {
+    bucket++;
+  }
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(micros, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::mean() const {
+  uint64_t total = count();
+  return total == 0 ? 0 : sum_.load(std::memory_order_relaxed) / total;
+}
+
+uint64_t LatencyHistogram::percentile(double quantile) const {
+  // Read the buckets once, writers may still be adding to them
+  std::array<uint64_t, BUCKETS> snapshot{};
+  uint64_t total = 0;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    snapshot[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += snapshot[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  auto target = static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(total)));
+  target = std::clamp<uint64_t>(target, 1, total);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    seen += snapshot[i];
+    if (seen >= target) {
+      return uint64_t{1} << i;
+    }
+  }
+  return uint64_t{1} << (BUCKETS - 1);
+}
+
+HttpMetrics::~HttpMetrics() {
+  stopPeriodicDump();
+}
+
+HttpMetrics& HttpMetrics::getInstance() {
+  static HttpMetrics instance;
+  return instance;
+}
+
+UrlClass HttpMetrics::classify(std::string_view url) {
+  // Drop the query so "?status=Active" and friends do not matter
+  url = url.substr(0, url.find('?'));
+
+  auto endsWith = [url](std::string_view suffix) {
+    return url.size() >= suffix.size() && url.substr(url.size() - suffix.size()) == suffix;
+  };
+
+  if (endsWith("/polygon")) {
+    return UrlClass::POLYGON;
+  }
+  if (endsWith("/measures")) {
+    return UrlClass::MEASURES;
+  }
+  if (url.find("/id/floods") != std::string_view::npos) {
+    return UrlClass::FLOODS;
+  }
+  if (url.find("/id/stations") != std::string_view::npos) {
+    return UrlClass::STATIONS;
+  }
+  return UrlClass::OTHER;
+}
+
+const char* HttpMetrics::className(UrlClass urlClass) {
+  switch (urlClass) {
+    case UrlClass::STATIONS:
+      return "stations";
+    case UrlClass::FLOODS:
+      return "floods";
+    case UrlClass::POLYGON:
+      return "polygon";
+    case UrlClass::MEASURES:
+      return "measures";
+    default:
+      return "other";
+  }
+}
+
+const char* HttpMetrics::phaseName(TimingPhase phase) {
+  switch (phase) {
+    case TimingPhase::DNS:
+      return "dns";
+    case TimingPhase::CONNECT:
+      return "connect";
+    case TimingPhase::TLS:
+      return "tls";
+    case TimingPhase::FIRST_BYTE:
+      return "first byte";
+    case TimingPhase::TRANSFER:
+      return "transfer";
+    default:
+      return "total";
+  }
+}
+
+void HttpMetrics::record(std::string_view url, const RequestTiming& timing) {
+  ClassMetrics& metrics = classes_.at(static_cast<size_t>(classify(url)));
+  metrics.requests.fetch_add(1, std::memory_order_relaxed);
+  if (timing.failed) {
+    metrics.failures.fetch_add(1, std::memory_order_relaxed);
+  }
+  metrics.bytesDown.fetch_add(timing.bytesDown, std::memory_order_relaxed);
+  metrics.bytesUp.fetch_add(timing.bytesUp, std::memory_order_relaxed);
+
+  for (size_t i = 0; i < timing.phases.size(); ++i) {
+    if (static_cast<TimingPhase>(i) == TimingPhase::TLS && !timing.tls) {
+      continue;
+    }
+    metrics.phases[i].record(timing.phases[i]);
+  }
+}
+
+HttpMetrics::ClassSummary HttpMetrics::summary(UrlClass urlClass) const {
+  const ClassMetrics& metrics = classes_.at(static_cast<size_t>(urlClass));
+  ClassSummary result;
+  result.requests = metrics.requests.load(std::memory_order_relaxed);
+  result.failures = metrics.failures.load(std::memory_order_relaxed);
+  result.bytesDown = metrics.bytesDown.load(std::memory_order_relaxed);
+  result.bytesUp = metrics.bytesUp.load(std::memory_order_relaxed);
+
+  for (size_t i = 0; i < result.phases.size(); ++i) {
+    const LatencyHistogram& histogram = metrics.phases[i];
+    result.phases[i] = {histogram.count(), histogram.mean(), histogram.percentile(0.5),
+                        histogram.percentile(0.9), histogram.percentile(0.99)};
+  }
+  return result;
+}
+
+void HttpMetrics::dump(std::ostream& out) const {
+  // Percentiles are bucket upper bounds, so they read as "under this many ms"
+  auto ms = [](uint64_t micros) { return static_cast<double>(micros) / 1000.0; };
+
+  // Formatted apart and written in one go, so the caller's stream keeps its flags and other
+  // threads writing to it cannot land mid-report
+  std::ostringstream text;
+  text << "HTTP metrics (ms)\n";
+  for (size_t c = 0; c < static_cast<size_t>(UrlClass::COUNT); ++c) {
+    ClassSummary s = summary(static_cast<UrlClass>(c));
+    if (s.requests == 0) {
+      continue;
+    }
+
+    text << "  " << className(static_cast<UrlClass>(c)) << ": " << s.requests << " requests, "
+        << s.failures << " failed, " << s.bytesDown << " bytes in, " << s.bytesUp
+        << " bytes out\n";
+    for (size_t p = 0; p < s.phases.size(); ++p) {
+      const PhaseSummary& phase = s.phases[p];
+      if (phase.count == 0) {
+        continue;
+      }
+      text << "    " << std::left << std::setw(11) << phaseName(static_cast<TimingPhase>(p))
+          << std::right << std::fixed << std::setprecision(1) << " mean " << ms(phase.mean)
+          << "  p50 <" << ms(phase.p50) << "  p90 <" << ms(phase.p90) << "  p99 <"
+          << ms(phase.p99) << '\n';
+    }
+  }
+  out << text.str() << std::flush;
+}
+
+void HttpMetrics::startPeriodicDump(std::chrono::seconds interval, std::ostream& out) {
+  stopPeriodicDump();
+
+  std::lock_guard<std::mutex> lock(dumpMutex_);
+  dumpStopping_ = false;
+  dumpThread_ = std::thread([this, interval, &out]() {
+    std::unique_lock<std::mutex> lock(dumpMutex_);
+    while (!dumpCond_.wait_for(lock, interval, [this]() { return dumpStopping_; })) {
+      dump(out);
+    }
+  });
+}
+
+void HttpMetrics::stopPeriodicDump() {
+  {
+    std::lock_guard<std::mutex> lock(dumpMutex_);
+    dumpStopping_ = true;
+  }
+  dumpCond_.notify_all();
+  if (dumpThread_.joinable()) {
+    dumpThread_.join();
+  }
+}
@@ -1,21 +1,25 @@
 #include "Measure.hpp"
-#include "TypeUtils.hpp"
 #include <iostream>
 
-Measure Measure::fromJson(const simdjson::dom::element& jsonObj) {
-  Measure measure;
+const FieldSchema<Measure> Measure::SCHEMA({
+    {"@id", &Measure::id, ""},
+    {"parameter", &Measure::parameter, ""},
+    {"parameterName", &Measure::parameterName, ""},
+    {"qualifier", &Measure::qualifier, ""},
+    {"unitName", &Measure::unitName, ""},
+    {"period", &Measure::period, 0.0},
+    {"value", &Measure::latestReading, 0.0, false, "latestReading"},
+});
 
-  measure.id = getString(jsonObj, "@id", "");
-  measure.parameter = getString(jsonObj, "parameter", "");
-  measure.parameterName = getString(jsonObj, "parameterName", "");
-  measure.qualifier = getString(jsonObj, "qualifier", "");
-  measure.unitName = getString(jsonObj, "unitName", "");
-  measure.period = getDouble(jsonObj, "period", 0.0);
+ParseError Measure::decode(const simdjson::dom::element& jsonObj, Measure& out) {
+  return SCHEMA.extract(jsonObj, out);
+}
 
-  simdjson::dom::element reading;
-  if (jsonObj["latestReading"].get(reading) == 0U) {
-    measure.latestReading = getDouble(reading, "value", 0.0);
+Measure Measure::fromJson(const simdjson::dom::element& jsonObj) {
+  Measure measure;
+  ParseError error = decode(jsonObj, measure);
+  if (error != ParseError::NONE) {
+    throw std::runtime_error(std::string("Invalid measure: ") + parseErrorName(error));
   }
-
   return measure;
 }
@@ -1,92 +1,405 @@
 #include "MonitoringData.hpp"
+#include "CoordinateDecoder.hpp"
+#include "ParserPool.hpp"
+#include "PolygonCache.hpp"
+#include "PolygonStore.hpp"
 #include <HttpClient.hpp>
 #include <ThreadPool.hpp>
+#include <atomic>
 #include <future>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
-void MonitoringData::parseWarnings(const simdjson::dom::element& apiResponse) {
-  simdjson::dom::array items;
-  auto error = apiResponse["items"].get(items);
-  if (error == 0U) {
-    for (auto item : items) {
-      if (item.is_null()) {
-        continue;
-      }
+// All polygons come from the same Environment Agency host
+static constexpr long MAX_POLYGON_CONNECTIONS_PER_HOST = 8;
+// A polygon that fails outright stays missing until the next refresh, so retry it and
+// duplicate stragglers rather than let one slow transfer hold up the batch
+static constexpr int POLYGON_FETCH_ATTEMPTS = 3;
+static constexpr double POLYGON_HEDGE_PERCENTILE = 0.95;
 
-      try {
-        warnings.push_back(Warning::fromJson(item));
-      } catch (const std::exception& e) {
-        std::cerr << "Error parsing warning: " << e.what() << '\n';
+// Items decoded per pool task, large enough to outweigh the hand-off
+static constexpr size_t PARSE_CHUNK_SIZE = 256;
+
+// Decode items in chunks on the shared pool. Each item has its own output slot, so order is
+// kept without a lock, and failures are tallied afterwards in item order.
+template <typename T, typename Item, typename Decode>
+static void decodeItems(const std::vector<std::pair<size_t, Item>>& items, Decode decode,
+                        std::vector<T>& out, ParseReport& report) {
+  std::vector<std::optional<T>> decoded(items.size());
+  std::vector<ParseError> errors(items.size(), ParseError::NONE);
+  ThreadPool::shared().parallelFor(items.size(), PARSE_CHUNK_SIZE, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      T value;
+      errors[i] = decode(items[i].second, value);
+      if (errors[i] == ParseError::NONE) {
+        decoded[i].emplace(std::move(value));
       }
     }
+  });
+
+  out.reserve(out.size() + items.size());
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (decoded[i]) {
+      out.push_back(std::move(*decoded[i]));
+      report.decoded++;
+    } else {
+      report.recordFailure(items[i].first, errors[i]);
+    }
   }
 }
 
-void MonitoringData::parseStations(const simdjson::dom::element& apiResponse) {
+// Non-null entries of the response's items array, with their positions in it
+static std::vector<std::pair<size_t, simdjson::dom::element>>
+itemElements(const simdjson::dom::element& apiResponse, ParseReport& report) {
+  std::vector<std::pair<size_t, simdjson::dom::element>> elements;
   simdjson::dom::array items;
-  auto error = apiResponse["items"].get(items);
-  if (error == 0U) {
+  if (apiResponse["items"].get(items) == 0U) {
+    elements.reserve(items.size());
     for (auto item : items) {
-      if (item.is_null()) {
-        continue;
+      if (!item.is_null()) {
+        elements.emplace_back(report.items, item);
       }
+      report.items++;
+    }
+  }
+  return elements;
+}
+
+ParseReport MonitoringData::parseWarnings(const simdjson::dom::element& apiResponse) {
+  ParseReport report;
+  decodeItems(
+      itemElements(apiResponse, report),
+      [](const simdjson::dom::element& item, Warning& out) { return Warning::decode(item, out); },
+      warnings, report);
+  return report;
+}
+
+ParseReport MonitoringData::parseStations(const simdjson::dom::element& apiResponse) {
+  ParseReport report;
+  decodeItems(
+      itemElements(apiResponse, report),
+      [](const simdjson::dom::element& item, Station& out) { return Station::decode(item, out); },
+      stations, report);
+  return report;
+}
+
+ParseReport MonitoringData::parseStationsOnDemand(const std::string& json) {
+  ParseReport report;
+  // Allocating a parser's buffers costs as much as the parse itself, so reuse a pooled one
+  auto parser = OnDemandParserPool::getInstance().acquire();
+
+  // Bodies from HttpClient already carry the padding, anything else gets a padded copy
+  simdjson::padded_string padded;
+  std::string_view buffer = json;
+  if (json.capacity() - json.size() < simdjson::SIMDJSON_PADDING) {
+    padded = simdjson::padded_string(json);
+    buffer = padded;
+  }
+
+  simdjson::ondemand::document doc;
+  size_t capacity = buffer.size() + simdjson::SIMDJSON_PADDING;
+  simdjson::ondemand::array items;
+  auto error = parser->iterate(buffer.data(), buffer.size(), capacity).get(doc);
+  if (error == simdjson::SUCCESS) {
+    error = doc["items"].get_array().get(items);
+  }
+  if (error == simdjson::NO_SUCH_FIELD) {
+    return report;
+  }
+  if (error != simdjson::SUCCESS) {
+    report.document = ParseError::MALFORMED;
+    return report;
+  }
+
+  // One sequential pass finds where each station object starts and ends, then the objects are
+  // decoded in parallel. Each is a slice of the padded buffer, so it can be iterated in place.
+  // Splitting rescans every object, which only pays off with more than one core to decode on.
+  bool split = ThreadPool::shared().size() > 1;
+  std::vector<std::pair<size_t, std::string_view>> objects;
+  for (auto item : items) {
+    size_t index = report.items++;
+    simdjson::ondemand::value value;
+    simdjson::ondemand::json_type type;
+    if (item.get(value) != simdjson::SUCCESS || value.type().get(type) != simdjson::SUCCESS) {
+      // The rest of the document cannot be trusted after a structural error
+      report.document = ParseError::MALFORMED;
+      return report;
+    }
+    if (type != simdjson::ondemand::json_type::object) {
+      continue; // null and other non-object entries, as in parseStations
+    }
 
-      try {
-        stations.push_back(Station::fromJson(item));
-      } catch (const std::exception& e) {
-        std::cerr << "Error parsing station: " << e.what() << '\n';
+    if (!split) {
+      simdjson::ondemand::object object;
+      Station station;
+      ParseError itemError = value.get_object().get(object) == simdjson::SUCCESS
+                                 ? Station::decode(object, station)
+                                 : ParseError::MALFORMED;
+      if (itemError == ParseError::NONE) {
+        stations.push_back(std::move(station));
+        report.decoded++;
+      } else {
+        report.recordFailure(index, itemError);
       }
+      continue;
+    }
+
+    std::string_view raw;
+    if (value.raw_json().get(raw) != simdjson::SUCCESS) {
+      report.document = ParseError::MALFORMED;
+      return report;
     }
+    objects.emplace_back(index, raw);
   }
+
+  const char* bufferEnd = buffer.data() + capacity;
+  decodeItems(
+      objects,
+      [bufferEnd](std::string_view raw, Station& out) {
+        // Station objects are small, a parser per thread never grows large
+        thread_local simdjson::ondemand::parser itemParser;
+        simdjson::ondemand::document itemDoc;
+        simdjson::ondemand::object object;
+        if (itemParser.iterate(raw.data(), raw.size(), static_cast<size_t>(bufferEnd - raw.data()))
+                    .get(itemDoc) != simdjson::SUCCESS ||
+            itemDoc.get_object().get(object) != simdjson::SUCCESS) {
+          return ParseError::MALFORMED;
+        }
+        return Station::decode(object, out);
+      },
+      stations, report);
+  return report;
 }
 
-void MonitoringData::fetchAllPolygonsAsync() {
-  // Collect all URLs that need fetching
-  std::vector<std::string> urls;
-  std::vector<Warning*> warningPtrs;
+void PolygonTimings::log(std::ostream& out) const {
+  auto ms = [](Duration d) { return static_cast<double>(d.count()) / 1000.0; };
+  out << "polygons: " << polygons << " (" << shared << " shared, " << cached << " cached, "
+      << failed << " failed)"
+      << ", download " << ms(download) << " ms, parse " << ms(parse) << " ms, geometry "
+      << ms(geometry) << " ms, simplify " << ms(simplify) << " ms\n";
+}
 
+// Decode stage durations summed over workers, in microseconds
+struct StageClock {
+    std::atomic<int64_t> parse{0};
+    std::atomic<int64_t> geometry{0};
+    std::atomic<int64_t> simplify{0};
+
+    static void add(std::atomic<int64_t>& total, std::chrono::steady_clock::time_point since) {
+      total += std::chrono::duration_cast<PolygonTimings::Duration>(
+                   std::chrono::steady_clock::now() - since)
+                   .count();
+    }
+};
+
+// Decode a flood area GeoJSON document's geometry. The coordinates are read straight from the
+// text when the document is a plain FeatureCollection, anything else goes through the DOM.
+static std::optional<FlatMultiPolygon> decodePolygon(const std::string& body,
+                                                     const std::string& url, StageClock& clock) {
+  // Parsing and geometry are one pass here, so it all counts as geometry
+  auto geometryStart = std::chrono::steady_clock::now();
+  FlatMultiPolygon decoded;
+  bool fast = decodeFeatureGeometry(body, decoded);
+  StageClock::add(clock.geometry, geometryStart);
+  if (fast) {
+    return decoded;
+  }
+
+  auto parser = ParserPool::getInstance().acquire();
+  auto parseStart = std::chrono::steady_clock::now();
+  simdjson::dom::element polygonJson;
+  auto error = parser->parse(body).get(polygonJson);
+  if (error != 0U) {
+    std::cerr << "Error parsing polygon from URL " << url << ": " << error << '\n';
+    return std::nullopt;
+  }
+
+  // Extract geometry element properly
+  simdjson::dom::element geometry;
+  error = polygonJson["features"].at(0)["geometry"].get(geometry);
+  StageClock::add(clock.parse, parseStart);
+  if (error != 0U) {
+    std::cerr << "Error getting geometry from polygon\n";
+    return std::nullopt;
+  }
+
+  geometryStart = std::chrono::steady_clock::now();
+  FlatMultiPolygon polygon = Warning::parseGeoJsonPolygon(geometry);
+  StageClock::add(clock.geometry, geometryStart);
+  return polygon;
+}
+
+// Parse a flood area GeoJSON document into the warning, returns false if it is unusable.
+// Only this warning is written, so different warnings can be decoded concurrently.
+static bool applyPolygon(Warning& warning, const std::string& body, const std::string& url,
+                         StageClock& clock) {
+  try {
+    auto polygon = decodePolygon(body, url, clock);
+    if (!polygon) {
+      return false;
+    }
+    warning.setFloodAreaPolygon(std::move(*polygon));
+
+    auto simplifyStart = std::chrono::steady_clock::now();
+    warning.buildPolygonLod();
+    StageClock::add(clock.simplify, simplifyStart);
+    return true;
+  } catch (const std::exception& e) {
+    std::cerr << "Error parsing polygon from URL " << url << ": " << e.what() << '\n';
+    return false;
+  }
+}
+
+PolygonTimings MonitoringData::fetchAllPolygonsAsync() {
+  PolygonTimings timings;
+  auto& store = PolygonStore::getInstance();
+
+  // Areas a live warning already holds are taken as they are. The rest are grouped by area,
+  // the first warning of a group is fetched and decoded and the others share its geometry.
+  std::vector<std::vector<Warning*>> groups;
+  std::unordered_map<std::string_view, size_t> groupOf;
   for (auto& warning : warnings) {
-    if (!warning.getPolygonUrl().empty()) {
-      urls.push_back(warning.getPolygonUrl());
-      warningPtrs.push_back(&warning);
+    const std::string& url = warning.getPolygonUrl();
+    if (url.empty()) {
+      continue;
+    }
+    ++timings.polygons;
+    SharedGeometry shared = store.find(warning.getId(), url);
+    if (shared.polygon) {
+      warning.setGeometry(std::move(shared));
+      ++timings.shared;
+      continue;
     }
+    // Polygon URLs name their flood area, so the URL alone keys the group
+    auto [group, added] = groupOf.emplace(url, groups.size());
+    if (added) {
+      groups.emplace_back();
+    }
+    groups[group->second].push_back(&warning);
+  }
+  if (groups.empty()) {
+    return timings;
   }
 
-  if (urls.empty()) {
-    return;
+  std::vector<Warning*> withPolygon;
+  withPolygon.reserve(groups.size());
+  for (const auto& group : groups) {
+    withPolygon.push_back(group.front());
   }
 
-  // Fetch all URLs concurrently using multi-curl
-  auto results = HttpClient::getInstance().fetchUrls(urls);
+  auto& cache = PolygonCache::getInstance();
+  auto& pool = ThreadPool::shared();
+  StageClock clock;
 
-  // Process results
-  simdjson::dom::parser parser;
-  for (size_t i = 0; i < results.size(); ++i) {
-    if (!results[i]) {
-      std::cerr << "Failed to fetch polygon from URL: " << urls[i] << '\n';
+  // Serve what we can from the disk cache, decoding the hits across the pool
+  std::vector<std::optional<PolygonCache::Entry>> cached(withPolygon.size());
+  for (size_t i = 0; i < withPolygon.size(); ++i) {
+    cached[i] = cache.load(withPolygon[i]->getPolygonUrl());
+  }
+  std::vector<uint8_t> applied(withPolygon.size(), 0);
+  pool.parallelFor(withPolygon.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      if (cached[i]) {
+        applied[i] = applyPolygon(*withPolygon[i], cached[i]->body,
+                                  withPolygon[i]->getPolygonUrl(), clock);
+      }
+    }
+  });
+
+  // Collect the rest for download
+  std::vector<std::string> urls;
+  std::vector<Warning*> warningPtrs;
+  std::vector<PolygonCache::StaleEntry> staleEntries;
+  for (size_t i = 0; i < withPolygon.size(); ++i) {
+    const std::string& url = withPolygon[i]->getPolygonUrl();
+    if (applied[i] != 0U) {
+      ++timings.cached;
+      if (cached[i]->stale) {
+        staleEntries.push_back({url, std::move(cached[i]->validators)});
+      }
       continue;
     }
+    urls.push_back(url);
+    warningPtrs.push_back(withPolygon[i]);
+  }
+  cached.clear();
 
-    try {
-      simdjson::dom::element polygonJson;
-      auto error = parser.parse(*results[i]).get(polygonJson);
-      if (error != 0U) {
-        std::cerr << "Error parsing polygon from URL " << urls[i] << ": " << error << '\n';
-        continue;
+  if (!urls.empty()) {
+    // Hand each polygon to the pool as soon as its download completes, so decoding overlaps
+    // the transfers still in flight. Every task owns one body slot and one warning.
+    FetchOptions options;
+    options.maxPerHost = MAX_POLYGON_CONNECTIONS_PER_HOST;
+    options.retry.maxAttempts = POLYGON_FETCH_ATTEMPTS;
+    options.hedge.percentile = POLYGON_HEDGE_PERCENTILE;
+
+    std::vector<std::optional<std::string>> bodies(urls.size());
+    std::vector<uint8_t> decoded(urls.size(), 0);
+    std::vector<std::future<void>> decodes;
+    decodes.reserve(urls.size());
+    // Tasks reference this frame, so they must all finish before it unwinds
+    auto waitForDecodes = [&decodes]() {
+      for (auto& decode : decodes) {
+        decode.wait();
       }
+    };
 
-      // Extract geometry element properly
-      simdjson::dom::element geometry;
-      error = polygonJson["features"].at(0)["geometry"].get(geometry);
-      if (error != 0U) {
-        std::cerr << "Error getting geometry from polygon\n";
-        continue;
+    auto downloadStart = std::chrono::steady_clock::now();
+    try {
+      HttpClient::getInstance().fetchUrls(
+          urls,
+          [&](size_t i, std::optional<std::string> body) {
+            if (!body) {
+              std::cerr << "Failed to fetch polygon from URL: " << urls[i] << '\n';
+              return;
+            }
+            bodies[i] = std::move(body);
+            decodes.push_back(pool.submit([&, i]() {
+              decoded[i] = applyPolygon(*warningPtrs[i], *bodies[i], urls[i], clock);
+            }));
+          },
+          options);
+    } catch (...) {
+      waitForDecodes();
+      throw;
+    }
+    timings.download = std::chrono::duration_cast<PolygonTimings::Duration>(
+        std::chrono::steady_clock::now() - downloadStart);
+    waitForDecodes();
+
+    // Cache writes share one lock, so keep them off the decode workers
+    for (size_t i = 0; i < urls.size(); ++i) {
+      if (decoded[i] != 0U) {
+        cache.store(urls[i], *bodies[i]);
+      } else {
+        ++timings.failed;
       }
+    }
+    cache.enforceSizeLimit();
+  }
 
-      warningPtrs[i]->setFloodAreaPolygon(Warning::parseGeoJsonPolygon(geometry));
-    } catch (const std::exception& e) {
-      std::cerr << "Error parsing polygon from URL " << urls[i] << ": " << e.what() << '\n';
+  // Old entries were good enough for now, refresh them for next time
+  cache.revalidateAsync(std::move(staleEntries));
+
+  // Publish each decoded area, and hand the copy that ends up in the store to its whole group
+  for (const auto& group : groups) {
+    Warning* first = group.front();
+    if (first->getFloodAreaPolygon() == nullptr) {
+      continue;
     }
+    SharedGeometry geometry = first->getGeometry();
+    for (Warning* warning : group) {
+      warning->setGeometry(store.insert(warning->getId(), warning->getPolygonUrl(), geometry));
+    }
+    timings.shared += group.size() - 1;
   }
+
+  timings.parse = PolygonTimings::Duration(clock.parse.load());
+  timings.geometry = PolygonTimings::Duration(clock.geometry.load());
+  timings.simplify = PolygonTimings::Duration(clock.simplify.load());
+  return timings;
 }
@@ -0,0 +1,56 @@
+#include "ParseReport.hpp"
+
+const char* parseErrorName(ParseError error) {
+  switch (error) {
+    case ParseError::NONE:
+      return "none";
+    case ParseError::WRONG_TYPE:
+      return "wrong type";
+    case ParseError::BAD_ELEMENT:
+      return "bad active element";
+    case ParseError::MALFORMED:
+      return "malformed";
+    default:
+      return "unknown";
+  }
+}
+
+void ParseReport::recordFailure(size_t index, ParseError error) {
+  errors.at(static_cast<size_t>(error))++;
+  if (samples.size() < MAX_SAMPLES) {
+    samples.push_back(index);
+  }
+}
+
+size_t ParseReport::failed() const {
+  size_t total = 0;
+  for (size_t count : errors) {
+    total += count;
+  }
+  return total;
+}
+
+void ParseReport::log(std::ostream& out, const char* kind) const {
+  if (!ok()) {
+    out << kind << ": document " << parseErrorName(document) << '\n';
+    return;
+  }
+
+  out << kind << ": decoded " << decoded << " of " << items;
+  if (failed() > 0) {
+    out << ", " << failed() << " failed (";
+    const char* separator = "";
+    for (size_t i = 1; i < errors.size(); ++i) {
+      if (errors[i] > 0) {
+        out << separator << parseErrorName(static_cast<ParseError>(i)) << ": " << errors[i];
+        separator = ", ";
+      }
+    }
+    out << "), first at [";
+    for (size_t i = 0; i < samples.size(); ++i) {
+      out << (i > 0 ? ", " : "") << samples[i];
+    }
+    out << ']';
+  }
+  out << '\n';
+}
@@ -0,0 +1,284 @@
+#include "PolygonCache.hpp"
+#include "HttpClient.hpp"
+#include "ParserPool.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <simdjson.h>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+// Entry layout: "FWPC2 <storedAt> <bodySize> <checksum> <urlSize> <etagSize> <lastModifiedSize>\n"
+// + url + etag + lastModified + body. storedAt is zero padded to a fixed width right after the
+// magic, so renew can rewrite it in place.
+static constexpr std::string_view CACHE_MAGIC = "FWPC2";
+static constexpr int STORED_AT_WIDTH = 20;
+
+static int64_t secondsSinceEpoch() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+PolygonCache* PolygonCache::testInstance = nullptr;
+
+PolygonCache::PolygonCache(fs::path directory, uintmax_t maxBytes, std::chrono::seconds maxAge)
+    : directory_(std::move(directory)), maxBytes_(maxBytes), maxAge_(maxAge) {}
+
+PolygonCache::~PolygonCache() {
+  if (revalidator_.joinable()) {
+    revalidator_.join();
+  }
+}
+
+PolygonCache& PolygonCache::getInstance() {
+  if (testInstance != nullptr) {
+    return *testInstance;
+  }
+  // Construct the HTTP client first so it outlives any background revalidation at exit
+  HttpClient::getInstance();
+  static PolygonCache instance(defaultDirectory());
+  return instance;
+}
+
+void PolygonCache::setInstance(PolygonCache* instance) {
+  testInstance = instance;
+}
+
+fs::path PolygonCache::defaultDirectory() {
+  for (const char* var : {"XDG_CACHE_HOME", "LOCALAPPDATA"}) {
+    const char* value = std::getenv(var); // NOLINT(concurrency-mt-unsafe)
+    if (value != nullptr && *value != '\0') {
+      return fs::path(value) / "FloodWatcher" / "polygons";
+    }
+  }
+
+  const char* home = std::getenv("HOME"); // NOLINT(concurrency-mt-unsafe)
+  if (home != nullptr && *home != '\0') {
+    return fs::path(home) / ".cache" / "FloodWatcher" / "polygons";
+  }
+  return fs::temp_directory_path() / "FloodWatcher" / "polygons";
+}
+
+uint64_t PolygonCache::checksum(std::string_view data) {
+  // FNV-1a, enough to catch truncated or damaged files
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+fs::path PolygonCache::pathFor(const std::string& url) const {
+  std::ostringstream name;
+  name << std::hex << checksum(url) << ".geojson";
+  return directory_ / name.str();
+}
+
+std::optional<PolygonCache::Entry> PolygonCache::load(const std::string& url) {
+  fs::path path = pathFor(url);
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return std::nullopt;
+  }
+
+  std::string magic;
+  int64_t storedAt = 0;
+  size_t bodySize = 0;
+  uint64_t expectedChecksum = 0;
+  size_t urlSize = 0;
+  size_t etagSize = 0;
+  size_t lastModifiedSize = 0;
+  file >> magic >> storedAt >> bodySize >> std::hex >> expectedChecksum >> std::dec >> urlSize >>
+      etagSize >> lastModifiedSize;
+  file.get(); // Header newline
+
+  auto discard = [&path](const char* reason) -> std::optional<Entry> {
+    std::cerr << "Discarding polygon cache entry " << path.filename() << ": " << reason << '\n';
+    std::error_code ec;
+    fs::remove(path, ec);
+    return std::nullopt;
+  };
+
+  if (!file || magic != CACHE_MAGIC) {
+    file.close();
+    return discard("bad header");
+  }
+
+  std::string storedUrl(urlSize, '\0');
+  file.read(storedUrl.data(), static_cast<std::streamsize>(urlSize));
+  if (!file || storedUrl != url) {
+    // Either damaged or a different URL hashing to the same name
+    file.close();
+    return discard("key mismatch");
+  }
+
+  CacheValidators validators;
+  validators.etag.resize(etagSize);
+  validators.lastModified.resize(lastModifiedSize);
+  file.read(validators.etag.data(), static_cast<std::streamsize>(etagSize));
+  file.read(validators.lastModified.data(), static_cast<std::streamsize>(lastModifiedSize));
+
+  // Leave simdjson's padding free so the body parses without a copy
+  std::string body;
+  body.reserve(bodySize + simdjson::SIMDJSON_PADDING);
+  body.resize(bodySize);
+  file.read(body.data(), static_cast<std::streamsize>(bodySize));
+  if (!file || file.peek() != std::ifstream::traits_type::eof() ||
+      checksum(body) != expectedChecksum) {
+    file.close();
+    return discard("checksum mismatch");
+  }
+  file.close();
+
+  // Touch the file so size eviction treats it as recently used
+  std::error_code ec;
+  fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+  auto age = std::chrono::system_clock::now() -
+             std::chrono::system_clock::time_point(std::chrono::seconds(storedAt));
+  return Entry{std::move(body), age > maxAge_, std::move(validators)};
+}
+
+void PolygonCache::store(const std::string& url, std::string_view body,
+                         const CacheValidators& validators) {
+  std::lock_guard<std::mutex> lock(writeMutex_);
+
+  std::error_code ec;
+  fs::create_directories(directory_, ec);
+  if (ec) {
+    std::cerr << "Failed to create polygon cache directory " << directory_ << ": "
+              << ec.message() << '\n';
+    return;
+  }
+
+  // Write to a temporary file and rename, so readers never see a partial entry
+  fs::path path = pathFor(url);
+  fs::path tmpPath = path;
+  tmpPath += ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+    file << CACHE_MAGIC << ' ' << std::setw(STORED_AT_WIDTH) << std::setfill('0')
+         << secondsSinceEpoch() << ' ' << body.size() << ' ' << std::hex << checksum(body)
+         << std::dec << ' ' << url.size() << ' ' << validators.etag.size() << ' '
+         << validators.lastModified.size() << '\n';
+    file.write(url.data(), static_cast<std::streamsize>(url.size()));
+    file << validators.etag << validators.lastModified;
+    file.write(body.data(), static_cast<std::streamsize>(body.size()));
+    if (!file) {
+      std::cerr << "Failed to write polygon cache entry for " << url << '\n';
+      file.close();
+      fs::remove(tmpPath, ec);
+      return;
+    }
+  }
+
+  fs::rename(tmpPath, path, ec);
+  if (ec) {
+    std::cerr << "Failed to store polygon cache entry for " << url << ": " << ec.message()
+              << '\n';
+    fs::remove(tmpPath, ec);
+  }
+}
+
+void PolygonCache::renew(const std::string& url) {
+  std::lock_guard<std::mutex> lock(writeMutex_);
+
+  std::fstream file(pathFor(url), std::ios::in | std::ios::out | std::ios::binary);
+  std::string magic;
+  file >> magic;
+  if (!file || magic != CACHE_MAGIC) {
+    return;
+  }
+  // Same width as store wrote, so nothing after the field moves. The write also bumps the
+  // file's mtime, which size eviction reads as a use.
+  file.seekp(static_cast<std::streamoff>(CACHE_MAGIC.size() + 1));
+  file << std::setw(STORED_AT_WIDTH) << std::setfill('0') << secondsSinceEpoch();
+  if (!file) {
+    std::cerr << "Failed to renew polygon cache entry for " << url << '\n';
+  }
+}
+
+void PolygonCache::enforceSizeLimit() {
+  std::lock_guard<std::mutex> lock(writeMutex_);
+
+  struct CachedFile {
+      fs::path path;
+      uintmax_t size;
+      fs::file_time_type lastUsed;
+  };
+
+  std::error_code ec;
+  std::vector<CachedFile> files;
+  uintmax_t totalBytes = 0;
+  for (const auto& item : fs::directory_iterator(directory_, ec)) {
+    if (!item.is_regular_file(ec) || item.path().extension() != ".geojson") {
+      continue;
+    }
+    uintmax_t size = item.file_size(ec);
+    files.push_back({item.path(), size, item.last_write_time(ec)});
+    totalBytes += size;
+  }
+
+  if (totalBytes <= maxBytes_) {
+    return;
+  }
+
+  std::sort(files.begin(), files.end(), [](const CachedFile& a, const CachedFile& b) {
+    return a.lastUsed < b.lastUsed;
+  });
+
+  for (const auto& file : files) {
+    if (totalBytes <= maxBytes_) {
+      break;
+    }
+    if (fs::remove(file.path, ec)) {
+      totalBytes -= file.size;
+    }
+  }
+}
+
+bool PolygonCache::hasGeometry(const std::string& body) {
+  // The lookup fetchAllPolygonsAsync does before it decodes and caches a download
+  auto parser = ParserPool::getInstance().acquire();
+  simdjson::dom::element document;
+  simdjson::dom::object geometry;
+  return parser->parse(body).get(document) == simdjson::SUCCESS &&
+         document["features"].at(0)["geometry"].get(geometry) == simdjson::SUCCESS;
+}
+
+void PolygonCache::revalidateAsync(std::vector<StaleEntry> entries) {
+  // One revalidation pass at a time, later requests are dropped while it runs
+  if (entries.empty() || revalidating_.exchange(true)) {
+    return;
+  }
+  if (revalidator_.joinable()) {
+    revalidator_.join();
+  }
+
+  revalidator_ = std::thread([this, entries = std::move(entries)]() {
+    // All requests go out together on the network thread, the bodies are checked here
+    auto& client = HttpClient::getInstance();
+    std::vector<std::future<FetchResult>> fetches;
+    fetches.reserve(entries.size());
+    for (const auto& entry : entries) {
+      fetches.push_back(client.fetchUrlIfModifiedAsync(entry.url, entry.validators));
+    }
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+      FetchResult result = fetches[i].get();
+      if (result.status == FetchStatus::NOT_MODIFIED) {
+        renew(entries[i].url);
+      } else if (result.body && hasGeometry(*result.body)) {
+        // A truncated or error page would otherwise replace a good entry
+        store(entries[i].url, *result.body, result.validators);
+      }
+    }
+    enforceSizeLimit();
+    revalidating_ = false;
+  });
+}
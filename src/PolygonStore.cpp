@@ -0,0 +1,61 @@
+#include "PolygonStore.hpp"
+#include <algorithm>
+
+std::string PolygonStore::key(std::string_view floodAreaId, std::string_view url) {
+  std::string key;
+  key.reserve(floodAreaId.size() + 1 + url.size());
+  key.append(floodAreaId).append(1, '\n').append(url);
+  return key;
+}
+
+SharedGeometry PolygonStore::liveGeometry(const Entry& entry) {
+  SharedGeometry geometry{entry.polygon.lock(), entry.lod.lock()};
+  if (!geometry.polygon) {
+    geometry.lod.reset();
+  }
+  return geometry;
+}
+
+SharedGeometry PolygonStore::find(std::string_view floodAreaId, std::string_view url) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key(floodAreaId, url));
+  if (it == entries_.end()) {
+    return {};
+  }
+  return liveGeometry(it->second);
+}
+
+SharedGeometry PolygonStore::insert(std::string_view floodAreaId, std::string_view url,
+                                    SharedGeometry geometry) {
+  if (!geometry.polygon) {
+    return geometry;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry& entry = entries_[key(floodAreaId, url)];
+  SharedGeometry live = liveGeometry(entry);
+  // Only a copy with its levels built wins over the newcomer
+  if (live.polygon && (live.lod || !geometry.lod)) {
+    return live;
+  }
+  entry.polygon = geometry.polygon;
+  entry.lod = geometry.lod;
+
+  if (entries_.size() >= sweepAt_) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      it = it->second.polygon.expired() ? entries_.erase(it) : std::next(it);
+    }
+    sweepAt_ = std::max(MIN_SWEEP_SIZE, 2 * entries_.size());
+  }
+  return geometry;
+}
+
+size_t PolygonStore::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+PolygonStore& PolygonStore::getInstance() {
+  static PolygonStore instance;
+  return instance;
+}
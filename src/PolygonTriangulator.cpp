@@ -0,0 +1,359 @@
+#include "PolygonTriangulator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+// Bounds the ear search grid so a huge ring cannot allocate a huge grid
+static constexpr size_t MAX_GRID_SIDE = 256;
+// A ring needs three corners to enclose anything
+static constexpr size_t MIN_RING_CORNERS = 3;
+
+namespace {
+
+// A corner in the doubly linked ring being clipped
+struct Node {
+    double x;
+    double y;
+    uint32_t point;
+    uint32_t prev;
+    uint32_t next;
+    bool removed;
+};
+
+// Positive when a, b, c turn counter-clockwise
+double cross(const Node& a, const Node& b, const Node& c) {
+  return ((b.x - a.x) * (c.y - a.y)) - ((b.y - a.y) * (c.x - a.x));
+}
+
+bool sameSpot(const Node& a, const Node& b) {
+  return a.x == b.x && a.y == b.y;
+}
+
+// Inclusive of the edges, whichever way the triangle turns
+bool inTriangle(const Node& a, const Node& b, const Node& c, const Node& p) {
+  double ab = cross(a, b, p);
+  double bc = cross(b, c, p);
+  double ca = cross(c, a, p);
+  return (ab >= 0 && bc >= 0 && ca >= 0) || (ab <= 0 && bc <= 0 && ca <= 0);
+}
+
+class EarClipper {
+  public:
+    explicit EarClipper(const FlatMultiPolygon::Polygon& polygon) {
+      uint32_t point = 0;
+      std::vector<uint32_t> holes;
+      for (size_t r = 0; r < polygon.size(); ++r) {
+        auto ring = polygon[r];
+        // The closing point repeats the first and is left out of the cycle
+        size_t corners = ring.size();
+        if (corners > 1 && ring[0] == ring[corners - 1]) {
+          --corners;
+        }
+        if (corners >= MIN_RING_CORNERS) {
+          // The exterior runs counter-clockwise and holes clockwise
+          uint32_t start = linkRing(ring, corners, point, r == 0);
+          if (r == 0) {
+            outer_ = start;
+          } else if (start != NONE) {
+            holes.push_back(start);
+          }
+        }
+        if (r == 0 && outer_ == NONE) {
+          return;
+        }
+        point += static_cast<uint32_t>(ring.size());
+      }
+      bridgeHoles(holes);
+    }
+
+    std::vector<uint32_t> clip() {
+      std::vector<uint32_t> triangles;
+      if (outer_ == NONE) {
+        return triangles;
+      }
+      buildGrid();
+      triangles.reserve(3 * nodes_.size());
+
+      uint32_t ear = filterPoints(outer_);
+      uint32_t stop = ear;
+      bool filtered = false;
+      while (nodes_[ear].prev != nodes_[ear].next) {
+        uint32_t prev = nodes_[ear].prev;
+        uint32_t next = nodes_[ear].next;
+        if (isEar(ear)) {
+          triangles.insert(triangles.end(),
+                           {nodes_[prev].point, nodes_[ear].point, nodes_[next].point});
+          remove(ear);
+          ear = stop = nodes_[next].next;
+          filtered = false;
+          continue;
+        }
+        ear = next;
+        if (ear != stop) {
+          continue;
+        }
+        // A whole lap without an ear: drop flat and repeated corners, then if that was already
+        // tried the ring is self-intersecting and the next corner is clipped regardless
+        if (!filtered) {
+          ear = stop = filterPoints(ear);
+          filtered = true;
+          continue;
+        }
+        prev = nodes_[ear].prev;
+        next = nodes_[ear].next;
+        if (cross(nodes_[prev], nodes_[ear], nodes_[next]) > 0) {
+          triangles.insert(triangles.end(),
+                           {nodes_[prev].point, nodes_[ear].point, nodes_[next].point});
+        }
+        remove(ear);
+        ear = stop = next;
+        filtered = false;
+      }
+      return triangles;
+    }
+
+  private:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    std::vector<Node> nodes_;
+    uint32_t outer_ = NONE;
+    // Uniform grid of node indices, so an ear is only checked against corners near it
+    std::vector<std::vector<uint32_t>> cells_;
+    size_t side_ = 1;
+    double minX_ = 0.0;
+    double minY_ = 0.0;
+    double cellWidth_ = 1.0;
+    double cellHeight_ = 1.0;
+
+    uint32_t linkRing(const FlatMultiPolygon::Ring& ring, size_t corners, uint32_t firstPoint,
+                      bool counterClockwise) {
+      double area = 0.0;
+      for (size_t i = 0, j = corners - 1; i < corners; j = i++) {
+        area += (ring[j].first * ring[i].second) - (ring[i].first * ring[j].second);
+      }
+      if (area == 0.0) {
+        return NONE;
+      }
+
+      bool reverse = (area > 0) != counterClockwise;
+      auto first = static_cast<uint32_t>(nodes_.size());
+      for (size_t k = 0; k < corners; ++k) {
+        size_t i = reverse ? corners - 1 - k : k;
+        auto index = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back({ring[i].first, ring[i].second, firstPoint + static_cast<uint32_t>(i),
+                          index - 1, index + 1, false});
+      }
+      nodes_[first].prev = static_cast<uint32_t>(nodes_.size() - 1);
+      nodes_.back().next = first;
+      return first;
+    }
+
+    // Holes are joined to the exterior by a pair of coincident edges, rightmost hole first so a
+    // bridge never has to cross a hole that is still separate (Eberly's method)
+    void bridgeHoles(std::vector<uint32_t>& holes) {
+      for (auto& hole : holes) {
+        hole = rightmost(hole);
+      }
+      std::sort(holes.begin(), holes.end(),
+                [&](uint32_t a, uint32_t b) { return nodes_[a].x > nodes_[b].x; });
+      for (uint32_t hole : holes) {
+        uint32_t bridge = findBridge(hole);
+        if (bridge != NONE) {
+          split(bridge, hole);
+        }
+      }
+    }
+
+    uint32_t rightmost(uint32_t start) const {
+      uint32_t best = start;
+      for (uint32_t p = nodes_[start].next; p != start; p = nodes_[p].next) {
+        if (nodes_[p].x > nodes_[best].x) {
+          best = p;
+        }
+      }
+      return best;
+    }
+
+    // An exterior corner the hole's rightmost corner can see, found by casting a ray along +x
+    uint32_t findBridge(uint32_t hole) const {
+      const Node& m = nodes_[hole];
+      double nearest = std::numeric_limits<double>::infinity();
+      uint32_t candidate = NONE;
+      uint32_t p = outer_;
+      do {
+        const Node& a = nodes_[p];
+        const Node& b = nodes_[a.next];
+        // Counter-clockwise, so the edges a ray from inside leaves through run upwards
+        if (a.y <= m.y && m.y <= b.y && a.y != b.y) {
+          double x = a.x + ((m.y - a.y) * (b.x - a.x) / (b.y - a.y));
+          if (x >= m.x && x < nearest) {
+            nearest = x;
+            candidate = a.x > b.x ? p : a.next;
+          }
+        }
+        p = a.next;
+      } while (p != outer_);
+      if (candidate == NONE || nearest == m.x) {
+        return candidate;
+      }
+
+      // Corners inside the triangle between the hole, the hit and the candidate would block the
+      // view, the one closest in angle to the ray is visible instead
+      Node hit{nearest, m.y, 0, 0, 0, false};
+      uint32_t best = candidate;
+      double bestTan = std::numeric_limits<double>::infinity();
+      p = outer_;
+      do {
+        const Node& v = nodes_[p];
+        if (v.x > m.x && inTriangle(m, hit, nodes_[candidate], v) && locallyInside(p, m)) {
+          double tan = std::abs(v.y - m.y) / (v.x - m.x);
+          if (tan < bestTan || (tan == bestTan && v.x < nodes_[best].x)) {
+            best = p;
+            bestTan = tan;
+          }
+        }
+        p = v.next;
+      } while (p != outer_);
+      return best;
+    }
+
+    // Whether the segment from corner a towards b starts inside the polygon
+    bool locallyInside(uint32_t a, const Node& b) const {
+      const Node& prev = nodes_[nodes_[a].prev];
+      const Node& next = nodes_[nodes_[a].next];
+      const Node& at = nodes_[a];
+      if (cross(prev, at, next) >= 0) {
+        return cross(at, next, b) >= 0 && cross(prev, at, b) >= 0;
+      }
+      return cross(at, next, b) >= 0 || cross(prev, at, b) >= 0;
+    }
+
+    // Splice the hole's cycle in after outer corner a, through duplicates of a and the hole's b
+    void split(uint32_t a, uint32_t b) {
+      auto a2 = static_cast<uint32_t>(nodes_.size());
+      nodes_.push_back(nodes_[a]);
+      auto b2 = static_cast<uint32_t>(nodes_.size());
+      nodes_.push_back(nodes_[b]);
+      uint32_t an = nodes_[a].next;
+      uint32_t bp = nodes_[b].prev;
+
+      nodes_[a].next = b;
+      nodes_[b].prev = a;
+      nodes_[a2].next = an;
+      nodes_[an].prev = a2;
+      nodes_[b2].next = a2;
+      nodes_[a2].prev = b2;
+      nodes_[bp].next = b2;
+      nodes_[b2].prev = bp;
+    }
+
+    void remove(uint32_t p) {
+      Node& node = nodes_[p];
+      nodes_[node.prev].next = node.next;
+      nodes_[node.next].prev = node.prev;
+      node.removed = true;
+    }
+
+    // Drop corners that repeat the next one or lie flat between their neighbours, returns a
+    // corner still in the ring
+    uint32_t filterPoints(uint32_t start) {
+      uint32_t p = start;
+      uint32_t end = start;
+      bool again = false;
+      do {
+        again = false;
+        const Node& node = nodes_[p];
+        if (node.prev != node.next &&
+            (sameSpot(node, nodes_[node.next]) ||
+             cross(nodes_[node.prev], node, nodes_[node.next]) == 0)) {
+          p = end = node.prev;
+          remove(nodes_[p].next);
+          again = true;
+        } else {
+          p = node.next;
+        }
+      } while (again || p != end);
+      return end;
+    }
+
+    void buildGrid() {
+      double maxX = nodes_[0].x;
+      double maxY = nodes_[0].y;
+      minX_ = maxX;
+      minY_ = maxY;
+      for (const auto& node : nodes_) {
+        minX_ = std::min(minX_, node.x);
+        minY_ = std::min(minY_, node.y);
+        maxX = std::max(maxX, node.x);
+        maxY = std::max(maxY, node.y);
+      }
+      side_ = std::clamp<size_t>(
+          static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodes_.size())))), 1,
+          MAX_GRID_SIDE);
+      cellWidth_ = std::max(maxX - minX_, 1e-12) / static_cast<double>(side_);
+      cellHeight_ = std::max(maxY - minY_, 1e-12) / static_cast<double>(side_);
+      cells_.assign(side_ * side_, {});
+      for (uint32_t i = 0; i < nodes_.size(); ++i) {
+        cells_[(cell(nodes_[i].y, minY_, cellHeight_) * side_) +
+               cell(nodes_[i].x, minX_, cellWidth_)]
+            .push_back(i);
+      }
+    }
+
+    size_t cell(double value, double origin, double extent) const {
+      auto index = static_cast<size_t>(std::max(0.0, (value - origin) / extent));
+      return std::min(index, side_ - 1);
+    }
+
+    // A convex corner whose triangle holds no reflex corner of the remaining ring
+    bool isEar(uint32_t ear) const {
+      const Node& b = nodes_[ear];
+      const Node& a = nodes_[b.prev];
+      const Node& c = nodes_[b.next];
+      if (cross(a, b, c) <= 0) {
+        return false;
+      }
+
+      size_t x0 = cell(std::min({a.x, b.x, c.x}), minX_, cellWidth_);
+      size_t x1 = cell(std::max({a.x, b.x, c.x}), minX_, cellWidth_);
+      size_t y0 = cell(std::min({a.y, b.y, c.y}), minY_, cellHeight_);
+      size_t y1 = cell(std::max({a.y, b.y, c.y}), minY_, cellHeight_);
+      for (size_t y = y0; y <= y1; ++y) {
+        for (size_t x = x0; x <= x1; ++x) {
+          for (uint32_t i : cells_[(y * side_) + x]) {
+            const Node& p = nodes_[i];
+            // Bridge duplicates share a spot with a neighbour without blocking it
+            if (p.removed || i == ear || i == b.prev || i == b.next || sameSpot(p, a) ||
+                sameSpot(p, c)) {
+              continue;
+            }
+            if (inTriangle(a, b, c, p) && cross(nodes_[p.prev], p, nodes_[p.next]) <= 0) {
+              return false;
+            }
+          }
+        }
+      }
+      return true;
+    }
+};
+
+} // namespace
+
+std::vector<uint32_t> PolygonTriangulator::triangulate(const FlatMultiPolygon::Polygon& polygon) {
+  return EarClipper(polygon).clip();
+}
+
+bool PolygonTriangulator::contains(const FlatMultiPolygon::Polygon& polygon, double x, double y) {
+  bool inside = false;
+  for (auto ring : polygon) {
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+      auto [xi, yi] = ring[i];
+      auto [xj, yj] = ring[j];
+      if ((yi > y) != (yj > y) && x < xi + ((y - yi) * (xj - xi) / (yj - yi))) {
+        inside = !inside;
+      }
+    }
+  }
+  return inside;
+}
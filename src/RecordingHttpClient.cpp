@@ -0,0 +1,95 @@
+#include "RecordingHttpClient.hpp"
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+RecordingHttpClient::RecordingHttpClient(IHttpClient& inner, fs::path directory)
+    : inner_(inner), directory_(std::move(directory)) {
+  std::error_code ec;
+  fs::create_directories(directory_, ec);
+  if (ec) {
+    std::cerr << "Failed to create fixture directory " << directory_ << ": " << ec.message()
+              << '\n';
+  }
+  index_.open(directory_ / INDEX_FILE, std::ios::trunc);
+  if (!index_) {
+    std::cerr << "Failed to open fixture index in " << directory_ << '\n';
+  }
+}
+
+void RecordingHttpClient::record(const std::string& url, const std::optional<std::string>& body) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!index_) {
+    return;
+  }
+
+  std::string file = std::to_string(nextFile_++) + ".body";
+  if (body) {
+    std::ofstream out(directory_ / file, std::ios::binary | std::ios::trunc);
+    out.write(body->data(), static_cast<std::streamsize>(body->size()));
+    if (!out) {
+      std::cerr << "Failed to write fixture for " << url << '\n';
+      return;
+    }
+  }
+
+  // Flush per line so a recording cut short by a crash is still usable
+  index_ << (body ? "OK" : "FAILED") << '\t' << file << '\t' << url << '\n' << std::flush;
+}
+
+std::optional<std::string> RecordingHttpClient::fetchUrl(const std::string& url) {
+  auto body = inner_.fetchUrl(url);
+  record(url, body);
+  return body;
+}
+
+FetchResult RecordingHttpClient::fetchUrlIfModified(const std::string& url) {
+  auto result = inner_.fetchUrlIfModified(url);
+  if (result.status != FetchStatus::NOT_MODIFIED) {
+    record(url, result.body);
+  }
+  return result;
+}
+
+std::vector<std::optional<std::string>>
+RecordingHttpClient::fetchUrls(const std::vector<std::string>& urls) {
+  auto results = inner_.fetchUrls(urls);
+  for (size_t i = 0; i < urls.size() && i < results.size(); ++i) {
+    record(urls[i], results[i]);
+  }
+  return results;
+}
+
+void RecordingHttpClient::fetchUrls(const std::vector<std::string>& urls,
+                                    const CompletionHandler& onComplete,
+                                    const FetchOptions& options) {
+  inner_.fetchUrls(
+      urls,
+      [this, &urls, &onComplete](size_t index, std::optional<std::string> body) {
+        record(urls[index], body);
+        onComplete(index, std::move(body));
+      },
+      options);
+}
+
+void RecordingHttpClient::fetchAsync(const std::string& url, bool ifModified,
+                                     ResultHandler onComplete) {
+  inner_.fetchAsync(url, ifModified,
+                    [this, url, onComplete = std::move(onComplete)](FetchResult result) {
+                      if (result.status != FetchStatus::NOT_MODIFIED) {
+                        record(url, result.body);
+                      }
+                      onComplete(std::move(result));
+                    });
+}
+
+void RecordingHttpClient::fetchAsync(const std::string& url, const CacheValidators& validators,
+                                     ResultHandler onComplete) {
+  inner_.fetchAsync(url, validators,
+                    [this, url, onComplete = std::move(onComplete)](FetchResult result) {
+                      if (result.status != FetchStatus::NOT_MODIFIED) {
+                        record(url, result.body);
+                      }
+                      onComplete(std::move(result));
+                    });
+}
@@ -0,0 +1,214 @@
+#include "ReplayHttpClient.hpp"
+#include "RecordingHttpClient.hpp"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <simdjson.h>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+ReplayHttpClient::ReplayHttpClient(fs::path directory, ReplayProfile profile)
+    : profile_(profile) {
+  std::ifstream index(directory / RecordingHttpClient::INDEX_FILE);
+  if (!index) {
+    std::cerr << "No fixture index in " << directory << '\n';
+    return;
+  }
+
+  std::string line;
+  while (std::getline(index, line)) {
+    std::istringstream fields(line);
+    std::string status;
+    std::string file;
+    std::string url;
+    if (!std::getline(fields, status, '\t') || !std::getline(fields, file, '\t') ||
+        !std::getline(fields, url)) {
+      continue;
+    }
+    // Later recordings of the same URL replace earlier ones
+    fixtures_[url] = Fixture{status == "OK", directory / file};
+  }
+}
+
+ReplayHttpClient::~ReplayHttpClient() {
+  // Joined outside the lock, a completion handler may still start another fetch
+  for (;;) {
+    std::vector<AsyncFetch> fetches;
+    {
+      std::lock_guard<std::mutex> lock(asyncMutex_);
+      fetches.swap(asyncFetches_);
+    }
+    if (fetches.empty()) {
+      return;
+    }
+    for (auto& fetch : fetches) {
+      fetch.thread.join();
+    }
+  }
+}
+
+std::optional<std::string> ReplayHttpClient::load(const std::string& url) const {
+  auto it = fixtures_.find(url);
+  if (it == fixtures_.end()) {
+    std::cerr << "No fixture for URL: " << url << '\n';
+    return std::nullopt;
+  }
+  if (!it->second.ok) {
+    return std::nullopt;
+  }
+
+  std::ifstream file(it->second.file, std::ios::binary | std::ios::ate);
+  if (!file) {
+    std::cerr << "Missing fixture file " << it->second.file << " for URL: " << url << '\n';
+    return std::nullopt;
+  }
+
+  // Padded like HttpClient's bodies so parsing behaves the same as against the network
+  auto size = static_cast<size_t>(file.tellg());
+  std::string body;
+  body.reserve(size + simdjson::SIMDJSON_PADDING);
+  body.resize(size);
+  file.seekg(0);
+  file.read(body.data(), static_cast<std::streamsize>(size));
+  return body;
+}
+
+std::chrono::microseconds ReplayHttpClient::transferTime(size_t bytes) const {
+  std::chrono::microseconds time = profile_.latency;
+  if (profile_.bytesPerSecond > 0) {
+    time += std::chrono::microseconds(static_cast<int64_t>(
+        static_cast<double>(bytes) * 1e6 / static_cast<double>(profile_.bytesPerSecond)));
+  }
+  return time;
+}
+
+std::optional<std::string> ReplayHttpClient::fetchUrl(const std::string& url) {
+  auto body = load(url);
+  std::this_thread::sleep_for(transferTime(body ? body->size() : 0));
+  return body;
+}
+
+FetchResult ReplayHttpClient::fetchUrlIfModified(const std::string& url) {
+  if (!profile_.notModifiedOnRepeat) {
+    auto body = fetchUrl(url);
+    if (!body) {
+      return {};
+    }
+    return {FetchStatus::OK, std::move(body), {}};
+  }
+
+  bool seen = false;
+  {
+    std::lock_guard<std::mutex> lock(servedMutex_);
+    seen = served_.count(url) != 0U;
+  }
+  if (seen) {
+    std::this_thread::sleep_for(transferTime(0));
+    return {FetchStatus::NOT_MODIFIED, std::nullopt, {}};
+  }
+
+  auto body = fetchUrl(url);
+  if (!body) {
+    return {};
+  }
+  {
+    std::lock_guard<std::mutex> lock(servedMutex_);
+    served_.insert(url);
+  }
+  return {FetchStatus::OK, std::move(body), {}};
+}
+
+std::vector<std::optional<std::string>>
+ReplayHttpClient::fetchUrls(const std::vector<std::string>& urls) {
+  std::vector<std::optional<std::string>> results(urls.size());
+  fetchUrls(
+      urls,
+      [&results](size_t index, std::optional<std::string> body) {
+        results[index] = std::move(body);
+      },
+      FetchOptions{});
+  return results;
+}
+
+void ReplayHttpClient::fetchUrls(const std::vector<std::string>& urls,
+                                 const CompletionHandler& onComplete,
+                                 const FetchOptions& options) {
+  using Clock = std::chrono::steady_clock;
+
+  // Work out when each transfer would finish if `window` of them ran side by side, then
+  // deliver them in that order at those times
+  size_t window = options.maxInFlight > 0 ? options.maxInFlight : profile_.maxInFlight;
+  window = std::max<size_t>(1, window);
+
+  std::priority_queue<std::chrono::microseconds, std::vector<std::chrono::microseconds>,
+                      std::greater<>>
+      slotsFreeAt;
+  for (size_t i = 0; i < std::min(window, urls.size()); ++i) {
+    slotsFreeAt.push(std::chrono::microseconds(0));
+  }
+
+  std::vector<std::pair<std::chrono::microseconds, size_t>> finishes;
+  finishes.reserve(urls.size());
+  for (size_t i = 0; i < urls.size(); ++i) {
+    std::error_code ec;
+    uintmax_t bytes = 0;
+    auto it = fixtures_.find(urls[i]);
+    if (it != fixtures_.end() && it->second.ok) {
+      bytes = fs::file_size(it->second.file, ec);
+    }
+    auto start = slotsFreeAt.top();
+    slotsFreeAt.pop();
+    auto finish = start + transferTime(ec ? 0 : static_cast<size_t>(bytes));
+    slotsFreeAt.push(finish);
+    finishes.emplace_back(finish, i);
+  }
+  std::stable_sort(finishes.begin(), finishes.end(),
+                   [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  auto begin = Clock::now();
+  for (const auto& [finish, index] : finishes) {
+    std::this_thread::sleep_until(begin + finish);
+    try {
+      onComplete(index, load(urls[index]));
+    } catch (const std::exception& e) {
+      std::cerr << "Completion handler failed for " << urls[index] << ": " << e.what() << '\n';
+    }
+  }
+}
+
+void ReplayHttpClient::fetchAsync(const std::string& url, bool ifModified,
+                                  ResultHandler onComplete) {
+  // A thread per request keeps concurrent fetches overlapping as they would on the network,
+  // the pool's workers would serialise their simulated latency
+  auto done = std::make_shared<std::atomic<bool>>(false);
+  std::thread thread([this, url, ifModified, done, onComplete = std::move(onComplete)]() {
+    if (ifModified) {
+      onComplete(fetchUrlIfModified(url));
+    } else {
+      auto body = fetchUrl(url);
+      FetchStatus status = body ? FetchStatus::OK : FetchStatus::FAILED;
+      onComplete({status, std::move(body), {}});
+    }
+    done->store(true, std::memory_order_release);
+  });
+
+  std::lock_guard<std::mutex> lock(asyncMutex_);
+  // Threads that have finished only need joining, so a long replay does not pile them up
+  auto finished = std::stable_partition(
+      asyncFetches_.begin(), asyncFetches_.end(),
+      [](const AsyncFetch& fetch) { return !fetch.done->load(std::memory_order_acquire); });
+  for (auto it = finished; it != asyncFetches_.end(); ++it) {
+    it->thread.join();
+  }
+  asyncFetches_.erase(finished, asyncFetches_.end());
+  asyncFetches_.push_back({std::move(thread), std::move(done)});
+}
+
+void ReplayHttpClient::fetchAsync(const std::string& url,
+                                  const CacheValidators& /*validators*/,
+                                  ResultHandler onComplete) {
+  fetchAsync(url, true, std::move(onComplete));
+}
@@ -1,23 +1,201 @@
 #include "Station.hpp"
 #include "HttpClient.hpp"
-#include <TypeUtils.hpp>
 #include <curl/curl.h>
 #include <iostream>
 
+// Stations that were renumbered list old and new values side by side, indexed like "status"
+const FieldSchema<Station> Station::SCHEMA(
+    {
+        {"RLOIid", &Station::RLOIid, "unknown", true},
+        {"catchmentName", &Station::catchmentName, "unknown", true},
+        {"dateOpened", &Station::dateOpened, "unknown", true},
+        {"label", &Station::label, "unknown", true},
+        {"lat", &Station::lat, 0.0, true},
+        {"long", &Station::lon, 0.0, true},
+        {"northing", &Station::northing, int64_t(0), true},
+        {"easting", &Station::easting, int64_t(0), true},
+        {"notation", &Station::notation, "unknown"},
+        {"town", &Station::town, "unknown"},
+        {"riverName", &Station::riverName, "unknown"},
+    },
+    "status");
+
+ParseError Station::decode(const simdjson::dom::element& jsonObj, Station& out) {
+  return SCHEMA.extract(jsonObj, out);
+}
+
 Station Station::fromJson(const simdjson::dom::element& jsonObj) {
   Station station;
+  ParseError error = decode(jsonObj, station);
+  if (error != ParseError::NONE) {
+    throw std::runtime_error(std::string("Invalid station: ") + parseErrorName(error));
+  }
+  return station;
+}
+
+namespace {
+
+// Keys the On-Demand decoder reads, each one a bit in its seen mask
+enum class StationKey : uint8_t {
+  RLOI_ID,
+  CATCHMENT_NAME,
+  DATE_OPENED,
+  LABEL,
+  LAT,
+  LONG,
+  NORTHING,
+  EASTING,
+  NOTATION,
+  TOWN,
+  RIVER_NAME,
+  STATUS,
+  OTHER
+};
+
+StationKey stationKey(std::string_view key) {
+  if (key == "RLOIid") {
+    return StationKey::RLOI_ID;
+  }
+  if (key == "catchmentName") {
+    return StationKey::CATCHMENT_NAME;
+  }
+  if (key == "dateOpened") {
+    return StationKey::DATE_OPENED;
+  }
+  if (key == "label") {
+    return StationKey::LABEL;
+  }
+  if (key == "lat") {
+    return StationKey::LAT;
+  }
+  if (key == "long") {
+    return StationKey::LONG;
+  }
+  if (key == "northing") {
+    return StationKey::NORTHING;
+  }
+  if (key == "easting") {
+    return StationKey::EASTING;
+  }
+  if (key == "notation") {
+    return StationKey::NOTATION;
+  }
+  if (key == "town") {
+    return StationKey::TOWN;
+  }
+  if (key == "riverName") {
+    return StationKey::RIVER_NAME;
+  }
+  if (key == "status") {
+    return StationKey::STATUS;
+  }
+  return StationKey::OTHER;
+}
 
-  station.RLOIid = getActiveValue(jsonObj, "RLOIid", std::string("unknown"));
-  station.catchmentName = getActiveValue(jsonObj, "catchmentName", std::string("unknown"));
-  station.dateOpened = getActiveValue(jsonObj, "dateOpened", std::string("unknown"));
-  station.label = getActiveValue(jsonObj, "label", std::string("unknown"));
-  station.lat = getActiveValue(jsonObj, "lat", 0.0);
-  station.lon = getActiveValue(jsonObj, "long", 0.0);
-  station.northing = getActiveValue(jsonObj, "northing", int64_t(0));
-  station.easting = getActiveValue(jsonObj, "easting", int64_t(0));
-  station.notation = getString(jsonObj, "notation", "unknown");
-  station.town = getString(jsonObj, "town", "unknown");
-  station.riverName = getString(jsonObj, "riverName", "unknown");
+} // namespace
 
+ParseError Station::decode(simdjson::ondemand::object jsonObj, Station& out) {
+  static const InternedString UNKNOWN("unknown");
+  out.notation = "unknown";
+  out.town = UNKNOWN;
+  out.riverName = UNKNOWN;
+
+  ActiveValue<std::string> RLOIid;
+  ActiveValue<InternedString> catchmentName;
+  ActiveValue<std::string> dateOpened;
+  ActiveValue<std::string> label;
+  ActiveValue<double> lat;
+  ActiveValue<double> lon;
+  ActiveValue<int64_t> northing;
+  ActiveValue<int64_t> easting;
+  size_t activeIndex = 0;
+  uint32_t seen = 0;
+
+  for (auto field : jsonObj) {
+    std::string_view key;
+    simdjson::ondemand::value value;
+    if (field.escaped_key().get(key) != simdjson::SUCCESS ||
+        field.value().get(value) != simdjson::SUCCESS) {
+      return ParseError::MALFORMED;
+    }
+
+    // Like the DOM schema, the first of a repeated key wins
+    StationKey code = stationKey(key);
+    uint32_t bit = uint32_t{1} << static_cast<uint8_t>(code);
+    if (code == StationKey::OTHER || (seen & bit) != 0) {
+      continue;
+    }
+    seen |= bit;
+
+    ParseError error = ParseError::NONE;
+    switch (code) {
+      case StationKey::RLOI_ID:
+        error = RLOIid.read(value);
+        break;
+      case StationKey::CATCHMENT_NAME:
+        error = catchmentName.read(value);
+        break;
+      case StationKey::DATE_OPENED:
+        error = dateOpened.read(value);
+        break;
+      case StationKey::LABEL:
+        error = label.read(value);
+        break;
+      case StationKey::LAT:
+        error = lat.read(value);
+        break;
+      case StationKey::LONG:
+        error = lon.read(value);
+        break;
+      case StationKey::NORTHING:
+        error = northing.read(value);
+        break;
+      case StationKey::EASTING:
+        error = easting.read(value);
+        break;
+      case StationKey::NOTATION:
+        error = readString(value, out.notation);
+        break;
+      case StationKey::TOWN:
+        error = readString(value, out.town);
+        break;
+      case StationKey::RIVER_NAME:
+        error = readString(value, out.riverName);
+        break;
+      case StationKey::STATUS:
+        activeIndex = findActiveIndex(value);
+        break;
+      case StationKey::OTHER:
+        break;
+    }
+    if (error != ParseError::NONE) {
+      return error;
+    }
+  }
+
+  // Status may have come last, so array fields are only resolved now
+  for (ParseError error : {
+           RLOIid.resolve(activeIndex, "unknown", out.RLOIid),
+           catchmentName.resolve(activeIndex, UNKNOWN, out.catchmentName),
+           dateOpened.resolve(activeIndex, "unknown", out.dateOpened),
+           label.resolve(activeIndex, "unknown", out.label),
+           lat.resolve(activeIndex, 0.0, out.lat),
+           lon.resolve(activeIndex, 0.0, out.lon),
+           northing.resolve(activeIndex, 0, out.northing),
+           easting.resolve(activeIndex, 0, out.easting),
+       }) {
+    if (error != ParseError::NONE) {
+      return error;
+    }
+  }
+  return ParseError::NONE;
+}
+
+Station Station::fromOnDemand(simdjson::ondemand::object jsonObj) {
+  Station station;
+  ParseError error = decode(jsonObj, station);
+  if (error != ParseError::NONE) {
+    throw std::runtime_error(std::string("Invalid station: ") + parseErrorName(error));
+  }
   return station;
 }
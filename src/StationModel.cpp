@@ -1,4 +1,6 @@
 #include "StationModel.hpp"
+#include "InternedQString.hpp"
+#include "ParserPool.hpp"
 #include <HttpClient.hpp>
 #include <iostream>
 #include <simdjson.h>
@@ -25,7 +27,7 @@ QVariant StationModel::data(const QModelIndex& index, int role) const {
     case StationRoles::LABEL_ROLE:
       return QString::fromStdString(station.getLabel());
     case StationRoles::TOWN_ROLE:
-      return QString::fromStdString(station.getTown());
+      return toQString(station.getTown());
     case StationRoles::LATITUDE_ROLE:
       return station.getLat();
     case StationRoles::LONGITUDE_ROLE:
@@ -33,11 +35,11 @@ QVariant StationModel::data(const QModelIndex& index, int role) const {
     case StationRoles::RLOI_ROLE:
       return QString::fromStdString(station.getRLOIid());
     case StationRoles::CATCHMENT_ROLE:
-      return QString::fromStdString(station.getCatchmentName());
+      return toQString(station.getCatchmentName());
     case StationRoles::DATE_ROLE:
       return QString::fromStdString(station.getDateOpened());
     case StationRoles::RIVER_ROLE:
-      return QString::fromStdString(station.getRiverName());
+      return toQString(station.getRiverName());
     case StationRoles::NOTATION_ROLE:
       return QString::fromStdString(station.getNotation());
     case StationRoles::MEASURES_ROLE: {
@@ -45,11 +47,11 @@ QVariant StationModel::data(const QModelIndex& index, int role) const {
       QVariantList result;
       for (const auto& m : measures) {
         QVariantMap map;
-        map["parameter"] = QString::fromStdString(m.getParameter());
-        map["parameterName"] = QString::fromStdString(m.getParameterName());
-        map["qualifier"] = QString::fromStdString(m.getQualifier());
+        map["parameter"] = toQString(m.getParameter());
+        map["parameterName"] = toQString(m.getParameterName());
+        map["qualifier"] = toQString(m.getQualifier());
         map["latestReading"] = m.getLatestReading();
-        map["unitName"] = QString::fromStdString(m.getUnitName());
+        map["unitName"] = toQString(m.getUnitName());
         result.append(map);
       }
       return result;
@@ -90,9 +92,10 @@ bool StationModel::fetchMeasures(int index) {
   }
 
   try {
-    simdjson::dom::parser parser;
+    // Runs on every station click, so reuse a warm parser rather than allocate a new one
+    auto parser = ParserPool::getInstance().acquire();
     simdjson::dom::element data;
-    auto error = parser.parse(*response).get(data);
+    auto error = parser->parse(*response).get(data);
 
     if (error != 0U) {
       std::cerr << "simdjson Parse Error for measures: " << error << '\n';
@@ -103,8 +106,20 @@ bool StationModel::fetchMeasures(int index) {
     error = data["items"].get(items);
     if (error == 0U) {
       std::vector<Measure> measures;
+      ParseReport report;
       for (auto measureJson : items) {
-        measures.push_back(Measure::fromJson(measureJson));
+        Measure measure;
+        ParseError measureError = Measure::decode(measureJson, measure);
+        if (measureError == ParseError::NONE) {
+          measures.push_back(std::move(measure));
+          report.decoded++;
+        } else {
+          report.recordFailure(report.items, measureError);
+        }
+        report.items++;
+      }
+      if (!report.clean()) {
+        report.log(std::cerr, "measures");
       }
       station.setMeasures(measures);
 
@@ -0,0 +1,39 @@
+#include "StringPool.hpp"
+#include <mutex>
+
+StringPool::StringPool() {
+  entries_.push_back({std::string(), 0});
+  empty_ = &entries_.back();
+  index_.emplace(empty_->value, empty_);
+}
+
+const StringPool::Entry* StringPool::intern(std::string_view value) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = index_.find(value);
+    if (it != index_.end()) {
+      return it->second;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  // Another thread may have added it between the two locks
+  auto it = index_.find(value);
+  if (it != index_.end()) {
+    return it->second;
+  }
+  entries_.push_back({std::string(value), static_cast<uint32_t>(entries_.size())});
+  const Entry* entry = &entries_.back();
+  index_.emplace(entry->value, entry);
+  return entry;
+}
+
+size_t StringPool::size() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return entries_.size();
+}
+
+StringPool& StringPool::getInstance() {
+  static StringPool instance;
+  return instance;
+}
@@ -1,44 +1,37 @@
 #include "TypeUtils.hpp"
 
-std::string getString(const simdjson::dom::element& elem, std::string_view key,
-                      const char* defaultVal) {
-  simdjson::dom::element field;
-  auto error = elem[key].get(field);
-  if (error != 0U) {
-    return defaultVal;
+size_t findActiveIndex(const simdjson::dom::element& status) {
+  simdjson::dom::array statuses;
+  if (status.get(statuses) != simdjson::SUCCESS) {
+    return 0;
   }
 
-  std::string_view sv;
-  if (field.get(sv) != 0U) {
-    throw std::runtime_error("Field is not a string");
+  size_t i = 0;
+  for (auto entry : statuses) {
+    std::string_view statusStr;
+    if (entry.get(statusStr) == simdjson::SUCCESS &&
+        statusStr.find("statusActive") != std::string_view::npos) {
+      return i;
+    }
+    i++;
   }
-  return std::string(sv);
+  return 0;
 }
 
-int getInt(const simdjson::dom::element& elem, std::string_view key, int defaultVal) {
-  simdjson::dom::element field;
-  auto error = elem[key].get(field);
-  if (error != 0U) {
-    return defaultVal;
+size_t findActiveIndex(simdjson::ondemand::value status) {
+  simdjson::ondemand::array statuses;
+  if (status.get_array().get(statuses) != simdjson::SUCCESS) {
+    return 0;
   }
 
-  int64_t val = 0;
-  if (field.get(val) != 0U) {
-    throw std::runtime_error("Field is not an integer");
+  size_t i = 0;
+  for (auto entry : statuses) {
+    std::string_view statusStr;
+    if (entry.get_string().get(statusStr) == simdjson::SUCCESS &&
+        statusStr.find("statusActive") != std::string_view::npos) {
+      return i;
+    }
+    i++;
   }
-  return static_cast<int>(val);
-}
-
-double getDouble(const simdjson::dom::element& elem, std::string_view key, double defaultVal) {
-  simdjson::dom::element field;
-  auto error = elem[key].get(field);
-  if (error != 0U) {
-    return defaultVal;
-  }
-
-  double val = 0.0;
-  if (field.get(val) != 0U) {
-    throw std::runtime_error("Field is not a number");
-  }
-  return val;
+  return 0;
 }
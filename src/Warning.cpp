@@ -5,61 +5,75 @@
 #include <curl/curl.h>
 #include <iostream>
 
+// county and polygon only default when floodArea is there, as a warning without one has no area
+const FieldSchema<Warning> Warning::SCHEMA({
+    {"floodAreaID", &Warning::id, "unknown"},
+    {"description", &Warning::description, "unknown"},
+    {"eaAreaName", &Warning::areaName, "unknown"},
+    {"severity", &Warning::severity, "unknown"},
+    {"severityLevel", &Warning::severityLevel, 0},
+    {"timeMessageChanged", &Warning::timeMessageChanged, ""},
+    {"timeRaised", &Warning::timeRaised, ""},
+    {"timeSeverityChanged", &Warning::timeSeverityChanged, ""},
+    {"message", &Warning::message, ""},
+    {"county", &Warning::county, "unknown", false, "floodArea"},
+    {"polygon", &Warning::polygonUrl, "", false, "floodArea"},
+});
+
+ParseError Warning::decode(const simdjson::dom::element& jsonObj, Warning& out) {
+  return SCHEMA.extract(jsonObj, out);
+}
+
 Warning Warning::fromJson(const simdjson::dom::element& jsonObj) {
   Warning warning;
+  ParseError error = decode(jsonObj, warning);
+  if (error != ParseError::NONE) {
+    throw std::runtime_error(std::string("Invalid warning: ") + parseErrorName(error));
+  }
+  return warning;
+}
 
-  warning.id = getString(jsonObj, "floodAreaID", "unknown");
-  warning.description = getString(jsonObj, "description", "unknown");
-  warning.areaName = getString(jsonObj, "eaAreaName", "unknown");
-  warning.severity = getString(jsonObj, "severity", "unknown");
-  warning.severityLevel = getInt(jsonObj, "severityLevel", 0);
-  warning.timeMessageChanged = getString(jsonObj, "timeMessageChanged", "");
-  warning.timeRaised = getString(jsonObj, "timeRaised", "");
-  warning.timeSeverityChanged = getString(jsonObj, "timeSeverityChanged", "");
-  warning.message = getString(jsonObj, "message", "");
-
-  simdjson::dom::element floodArea;
-  if (jsonObj["floodArea"].get(floodArea) == 0U) {
-    warning.county = getString(floodArea, "county", "unknown");
-    warning.polygonUrl = getString(floodArea, "polygon", "");
+void Warning::setFloodAreaPolygon(std::optional<FlatMultiPolygon> polygon) {
+  geometry.lod.reset();
+  if (polygon) {
+    geometry.polygon = std::make_shared<const FlatMultiPolygon>(std::move(*polygon));
+  } else {
+    geometry.polygon.reset();
   }
+}
 
-  return warning;
+void Warning::buildPolygonLod() {
+  if (geometry.polygon) {
+    geometry.lod = std::make_shared<const GeometryLod>(*geometry.polygon);
+  }
 }
 
-LinearRing Warning::parseLinearRing(const simdjson::dom::array& ringJson) {
-  LinearRing ring;
-  ring.reserve(ringJson.size());
+void Warning::parseLinearRing(const simdjson::dom::array& ringJson, FlatMultiPolygon& out) {
   for (auto coord : ringJson) {
     simdjson::dom::array coordArr;
     if (coord.get(coordArr) == 0U && coordArr.size() >= 2) {
       double lon = NAN;
       double lat = NAN;
       if (coordArr.at(0).get(lon) == 0U && coordArr.at(1).get(lat) == 0U) {
-        ring.emplace_back(lon, lat);
+        out.addPoint(lon, lat);
       }
     }
   }
-  return ring;
+  out.closeRing();
 }
 
-MyPolygon Warning::parsePolygon(const simdjson::dom::array& polygonJson) {
-  MyPolygon polygon;
-  polygon.reserve(polygonJson.size());
+void Warning::parsePolygon(const simdjson::dom::array& polygonJson, FlatMultiPolygon& out) {
   for (auto ringJson : polygonJson) {
     simdjson::dom::array ringArr;
     if (ringJson.get(ringArr) == 0U) {
-      LinearRing ring = parseLinearRing(ringArr);
-      if (!ring.empty()) {
-        polygon.push_back(std::move(ring));
-      }
+      parseLinearRing(ringArr, out);
     }
   }
-  return polygon;
+  out.closePolygon();
 }
 
-MultiPolygon Warning::parseGeoJsonPolygon(const simdjson::dom::element& geoJson) {
-  MultiPolygon result;
+FlatMultiPolygon Warning::parseGeoJsonPolygon(const simdjson::dom::element& geoJson) {
+  FlatMultiPolygon result;
 
   simdjson::dom::array coords;
   if (geoJson["coordinates"].get(coords) != 0U) {
@@ -73,19 +87,13 @@ MultiPolygon Warning::parseGeoJsonPolygon(const simdjson::dom::element& geoJson)
   }
 
   if (type == "Polygon") {
-    MyPolygon polygon = parsePolygon(coords);
-    if (!polygon.empty()) {
-      result.push_back(std::move(polygon));
-    }
+    parsePolygon(coords, result);
   } else if (type == "MultiPolygon") {
-    result.reserve(coords.size());
+    result.reservePolygons(coords.size());
     for (auto polygonCoords : coords) {
       simdjson::dom::array polygonArr;
       if (polygonCoords.get(polygonArr) == 0U) {
-        MyPolygon polygon = parsePolygon(polygonArr);
-        if (!polygon.empty()) {
-          result.push_back(std::move(polygon));
-        }
+        parsePolygon(polygonArr, result);
       }
     }
   } else {
@@ -1,22 +1,127 @@
 #include "WarningModel.hpp"
+#include "InternedQString.hpp"
 #include "MonitoringData.hpp"
+#include "ParserPool.hpp"
 #include <HttpClient.hpp>
 #include <QDateTime>
 #include <QGeoCoordinate>
+#include <ThreadPool.hpp>
 #include <algorithm>
 #include <iostream>
+#include <memory>
 #include <simdjson.h>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+// Warnings converted per pool task, most are small so one each would be mostly overhead
+static constexpr size_t CONVERT_CHUNK_SIZE = 8;
+
+namespace {
+
+QVariantList toPath(const FlatMultiPolygon& multiPolygon) {
+  if (multiPolygon.empty() || multiPolygon[0].empty()) {
+    return {};
+  }
+
+  const auto& exteriorRing = multiPolygon[0][0];
+  QVariantList coordinates;
+  coordinates.reserve(static_cast<qsizetype>(exteriorRing.size()));
+
+  for (const auto& coord : exteriorRing) {
+    // coord.first = longitude, coord.second = latitude
+    coordinates.append(QVariant::fromValue(QGeoCoordinate(coord.second, coord.first)));
+  }
+
+  return coordinates;
+}
+
+// Most severe first, ties by flood area so every refresh lays equal rows out alike
+bool rowBefore(const Warning& a, const Warning& b) {
+  if (a.getSeverityLevel() != b.getSeverityLevel()) {
+    return a.getSeverityLevel() < b.getSeverityLevel();
+  }
+  return a.getId() < b.getId();
+}
+
+// Roles whose values differ between two versions of the same warning
+QList<int> changedRoles(const Warning& current, const Warning& next) {
+  using Roles = WarningModel::WarningRoles;
+  QList<int> roles;
+  auto mark = [&roles](bool changed, Roles role) {
+    if (changed) {
+      roles.append(static_cast<int>(role));
+    }
+  };
+  mark(current.getDescription() != next.getDescription(), Roles::DESCRIPTION_ROLE);
+  mark(current.getSeverity() != next.getSeverity(), Roles::SEVERITY_ROLE);
+  mark(current.getSeverityLevel() != next.getSeverityLevel(), Roles::SEVERITY_LEVEL_ROLE);
+  mark(current.getAreaName() != next.getAreaName(), Roles::EA_AREA_NAME_ROLE);
+  mark(current.getMessage() != next.getMessage(), Roles::MESSAGE_ROLE);
+  // Refreshes share the geometry of areas they already had, so equal pointers are the usual
+  // case. The levels of detail follow the polygon, only whether they exist yet can differ.
+  const FlatMultiPolygon* polygon = current.getFloodAreaPolygon();
+  const FlatMultiPolygon* nextPolygon = next.getFloodAreaPolygon();
+  bool geometryChanged =
+      (polygon != nextPolygon &&
+       (polygon == nullptr || nextPolygon == nullptr || *polygon != *nextPolygon)) ||
+      (current.getPolygonLod() == nullptr) != (next.getPolygonLod() == nullptr);
+  mark(geometryChanged, Roles::POLYGON_PATH_ROLE);
+  return roles;
+}
+
+// Marks the longest increasing run in values, the rows that can stay while the rest move
+std::vector<bool> longestIncreasing(const std::vector<size_t>& values) {
+  static constexpr size_t NONE = SIZE_MAX;
+  std::vector<size_t> tails; // Per run length, the index ending the run with the lowest value
+  std::vector<size_t> previous(values.size(), NONE);
+  for (size_t i = 0; i < values.size(); ++i) {
+    auto tail = std::lower_bound(tails.begin(), tails.end(), values[i],
+                                 [&](size_t index, size_t value) { return values[index] < value; });
+    if (tail != tails.begin()) {
+      previous[i] = *(tail - 1);
+    }
+    if (tail == tails.end()) {
+      tails.push_back(i);
+    } else {
+      *tail = i;
+    }
+  }
+  std::vector<bool> kept(values.size(), false);
+  for (size_t i = tails.empty() ? NONE : tails.back(); i != NONE; i = previous[i]) {
+    kept[i] = true;
+  }
+  return kept;
+}
+
+template <typename T> void moveElement(std::vector<T>& values, size_t from, size_t to) {
+  if (from < to) {
+    std::rotate(values.begin() + from, values.begin() + from + 1, values.begin() + to + 1);
+  } else {
+    std::rotate(values.begin() + to, values.begin() + from, values.begin() + from + 1);
+  }
+}
+
+} // namespace
 
 WarningModel::WarningModel(const std::vector<Warning>& warnings, QObject* parent)
-    : QAbstractListModel(parent), m_warnings(warnings), m_updateTimer(new QTimer(this)) {
+    : QAbstractListModel(parent), m_warnings(warnings), m_updateTimer(new QTimer(this)),
+      m_refreshHandle(std::make_shared<RefreshHandle>(this)) {
   // Sort by severity level (1 = most severe)
-  std::sort(m_warnings.begin(), m_warnings.end(), [](const Warning& a, const Warning& b) {
-    return a.getSeverityLevel() < b.getSeverityLevel();
-  });
+  std::sort(m_warnings.begin(), m_warnings.end(), rowBefore);
+  m_polygonValues = convertPolygons(m_warnings);
 
   connect(m_updateTimer, &QTimer::timeout, this, &WarningModel::fetchWarnings);
 }
 
+WarningModel::~WarningModel() {
+  // A worker still fetching stops at its next stage and drops its result, closing the app never
+  // waits on the network. A result already posted is dropped with the model.
+  m_refreshHandle->cancelled = true;
+  std::lock_guard<std::mutex> lock(m_refreshHandle->mutex);
+  m_refreshHandle->model = nullptr;
+}
+
 int WarningModel::rowCount(const QModelIndex& parent) const {
   if (parent.isValid()) {
     return 0;
@@ -31,18 +136,19 @@ QVariant WarningModel::data(const QModelIndex& index, int role) const {
   }
 
   const auto& warning = m_warnings[index.row()];
+  int level = GeometryLod::levelForZoom(m_zoomLevel);
 
   switch (static_cast<WarningRoles>(role)) {
     case WarningRoles::DESCRIPTION_ROLE:
       return QString::fromStdString(warning.getDescription());
     case WarningRoles::SEVERITY_ROLE:
-      return QString::fromStdString(warning.getSeverity());
+      return toQString(warning.getSeverity());
     case WarningRoles::SEVERITY_LEVEL_ROLE:
       return warning.getSeverityLevel();
     case WarningRoles::EA_AREA_NAME_ROLE:
       return QString::fromStdString(warning.getAreaName());
     case WarningRoles::POLYGON_PATH_ROLE:
-      return getPolygonPath(warning);
+      return m_polygonValues[index.row()].paths[level];
     case WarningRoles::MESSAGE_ROLE:
       return QString::fromStdString(warning.getMessage());
     default:
@@ -65,6 +171,7 @@ void WarningModel::startAutoUpdate() {
   int delayMs = calculateNextUpdateMs();
 
   std::cout << "Starting auto-update, next fetch in " << (delayMs / 1000.0) << " seconds\n";
+  m_autoUpdate = true;
 
   // Schedule first update
   m_updateTimer->setSingleShot(true);
@@ -72,92 +179,270 @@ void WarningModel::startAutoUpdate() {
 }
 
 void WarningModel::stopAutoUpdate() {
+  m_autoUpdate = false;
   m_updateTimer->stop();
   std::cout << "Auto-update stopped\n";
 }
 
+void WarningModel::setZoomLevel(double zoomLevel) {
+  bool levelChanged =
+      GeometryLod::levelForZoom(zoomLevel) != GeometryLod::levelForZoom(m_zoomLevel);
+  m_zoomLevel = zoomLevel;
+  if (levelChanged && !m_warnings.empty()) {
+    emit dataChanged(index(0), index(static_cast<int>(m_warnings.size()) - 1),
+                     {static_cast<int>(WarningRoles::POLYGON_PATH_ROLE)});
+  }
+}
+
 void WarningModel::fetchWarnings() {
+  // A refresh still running on a slow network stands in for this one
+  if (m_refreshing) {
+    return;
+  }
+  m_refreshing = true;
+
   std::cout << "Fetching warnings at "
             << QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss").toStdString() << "\n";
 
-  auto response = HttpClient::getInstance().fetchUrl(
-      "https://environment.data.gov.uk/flood-monitoring/id/floods");
-
-  if (!response) {
-    std::cerr << "Failed to fetch warnings\n";
-    // Retry at next interval
-    m_updateTimer->start(calculateNextUpdateMs());
-    return;
-  }
+  // Download, parse, polygons and conversion all block, so none of it runs on the GUI thread.
+  // The worker gets its own copy of the rows' values, the lists in it are implicitly shared.
+  // It is detached and reaches the model only through the handle, so nothing ever joins it.
+  std::thread([handle = m_refreshHandle, previous = m_polygonValues]() {
+    // Shared, as queued calls copy their functor
+    auto snapshot =
+        std::make_shared<std::optional<Snapshot>>(fetchSnapshot(previous, handle->cancelled));
+    // Held while posting, so the model cannot be destroyed in between
+    std::lock_guard<std::mutex> lock(handle->mutex);
+    WarningModel* model = handle->model;
+    if (model == nullptr) {
+      return;
+    }
+    QMetaObject::invokeMethod(
+        model, [model, snapshot]() { model->finishRefresh(std::move(*snapshot)); },
+        Qt::QueuedConnection);
+  }).detach();
+}
 
+std::optional<WarningModel::Snapshot>
+WarningModel::fetchSnapshot(const std::vector<PolygonValues>& previous,
+                            const std::atomic<bool>& cancelled) {
   try {
-    simdjson::dom::parser parser;
-    simdjson::dom::element data;
-    auto error = parser.parse(*response).get(data);
+    auto result = HttpClient::getInstance().fetchUrlIfModified(
+        "https://environment.data.gov.uk/flood-monitoring/id/floods");
+    if (cancelled) {
+      return std::nullopt;
+    }
 
-    if (error != 0U) {
-      std::cerr << "simdjson Parse Error: " << error << "\n";
-      m_updateTimer->start(calculateNextUpdateMs());
-      return;
+    if (result.status == FetchStatus::NOT_MODIFIED) {
+      // Nothing changed upstream, skip parsing, polygons and model updates
+      std::cout << "Warnings not modified since last fetch\n";
+      return std::nullopt;
     }
 
-    MonitoringData tempData;
-    tempData.parseWarnings(data);
-    tempData.fetchAllPolygonsAsync();
+    const auto& response = result.body;
+    if (!response) {
+      std::cerr << "Failed to fetch warnings\n";
+      return std::nullopt;
+    }
 
-    updateWarnings(tempData.getWarnings());
+    MonitoringData tempData;
+    {
+      auto parser = ParserPool::getInstance().acquire();
+      simdjson::dom::element data;
+      auto error = parser->parse(*response).get(data);
+      if (error != 0U) {
+        std::cerr << "simdjson Parse Error: " << error << "\n";
+        return std::nullopt;
+      }
 
-    std::cout << "Updated: " << m_warnings.size() << " warnings\n";
-    emit warningsUpdated(static_cast<int>(m_warnings.size()));
+      ParseReport report = tempData.parseWarnings(data);
+      if (!report.clean()) {
+        report.log(std::cerr, "warnings");
+      }
+    }
+    if (cancelled) {
+      return std::nullopt;
+    }
+    // Areas the model already shows come from the PolygonStore, only new ones are fetched
+    tempData.fetchAllPolygonsAsync();
+    if (cancelled) {
+      return std::nullopt;
+    }
 
+    return prepareSnapshot(tempData.getWarnings(), previous);
   } catch (const std::exception& e) {
     std::cerr << "Parse Error: " << e.what() << "\n";
+    return std::nullopt;
+  }
+}
+
+void WarningModel::finishRefresh(std::optional<Snapshot> snapshot) {
+  m_refreshing = false;
+
+  if (snapshot) {
+    auto applyStart = std::chrono::steady_clock::now();
+    applySnapshot(std::move(*snapshot));
+    m_lastApplyTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - applyStart);
+
+    std::cout << "Updated: " << m_warnings.size() << " warnings, applied in "
+              << getLastApplyMs() << " ms\n";
+    if (m_lastApplyTime > m_applyBudget) {
+      ++m_applyBudgetOverruns;
+      std::cerr << "Warning refresh took " << getLastApplyMs() << " ms on the GUI thread, over its "
+                << (static_cast<double>(m_applyBudget.count()) / 1000.0) << " ms budget\n";
+    }
+    emit applyTimeChanged();
+    emit warningsUpdated(static_cast<int>(m_warnings.size()));
   }
 
   // Schedule next update
-  m_updateTimer->start(calculateNextUpdateMs());
+  if (m_autoUpdate) {
+    m_updateTimer->start(calculateNextUpdateMs());
+  }
+}
+
+WarningModel::Snapshot WarningModel::prepareSnapshot(std::vector<Warning> warnings,
+                                                     const std::vector<PolygonValues>& previous) {
+  Snapshot snapshot;
+  snapshot.warnings = std::move(warnings);
+  std::sort(snapshot.warnings.begin(), snapshot.warnings.end(), rowBefore);
+  snapshot.polygonValues = convertPolygons(snapshot.warnings, previous);
+  return snapshot;
 }
 
 void WarningModel::updateWarnings(const std::vector<Warning>& newWarnings) {
-  auto sortedNew = newWarnings;
-  std::sort(sortedNew.begin(), sortedNew.end(), [](const Warning& a, const Warning& b) {
-    return a.getSeverityLevel() < b.getSeverityLevel();
-  });
+  applySnapshot(prepareSnapshot(newWarnings, m_polygonValues));
+}
 
-  // Check if data actually changed
-  if (m_warnings.size() == sortedNew.size()) {
-    bool identical = true;
-    for (size_t i = 0; i < m_warnings.size(); ++i) {
-      // Compare by ID or relevant fields
-      if (m_warnings[i].getDescription() != sortedNew[i].getDescription() ||
-          m_warnings[i].getSeverityLevel() != sortedNew[i].getSeverityLevel()) {
-        identical = false;
-        break;
-      }
+void WarningModel::applySnapshot(Snapshot snapshot) {
+  auto& sortedNew = snapshot.warnings;
+  auto& polygonValues = snapshot.polygonValues;
+
+  // Everything slow happened while preparing the snapshot, this is only bookkeeping and signals,
+  // then the map layer merging the meshes it is handed on warningsApplied.
+  // Rows are matched by flood area, views point into sortedNew until rows are moved out of it.
+  std::unordered_map<std::string_view, size_t> targetRows;
+  targetRows.reserve(sortedNew.size());
+  bool keyed = true;
+  for (size_t row = 0; row < sortedNew.size(); ++row) {
+    keyed = targetRows.emplace(sortedNew[row].getId(), row).second && keyed;
+  }
+  std::unordered_set<std::string_view> currentIds;
+  currentIds.reserve(m_warnings.size());
+  for (const auto& warning : m_warnings) {
+    keyed = currentIds.insert(warning.getId()).second && keyed;
+  }
+  if (!keyed) {
+    // A flood area listed twice has no single row to follow
+    beginResetModel();
+    m_warnings = std::move(sortedNew);
+    m_warnings.shrink_to_fit();
+    m_polygonValues = std::move(polygonValues);
+    endResetModel();
+    emit warningsApplied();
+    return;
+  }
+
+  // Where each current row ends up and what changes in it
+  static constexpr size_t REMOVED = SIZE_MAX;
+  std::vector<size_t> targets(m_warnings.size(), REMOVED);
+  std::vector<bool> matched(sortedNew.size(), false);
+  std::vector<QList<int>> roles(sortedNew.size());
+  for (size_t row = 0; row < m_warnings.size(); ++row) {
+    auto target = targetRows.find(m_warnings[row].getId());
+    if (target != targetRows.end()) {
+      targets[row] = target->second;
+      matched[target->second] = true;
+      roles[target->second] = changedRoles(m_warnings[row], sortedNew[target->second]);
+    }
+  }
+  // Remove from the bottom up, a run of adjacent rows at a time
+  for (size_t end = m_warnings.size(); end > 0;) {
+    if (targets[end - 1] != REMOVED) {
+      --end;
+      continue;
+    }
+    size_t begin = end - 1;
+    while (begin > 0 && targets[begin - 1] == REMOVED) {
+      --begin;
     }
+    beginRemoveRows(QModelIndex(), static_cast<int>(begin), static_cast<int>(end - 1));
+    m_warnings.erase(m_warnings.begin() + begin, m_warnings.begin() + end);
+    m_polygonValues.erase(m_polygonValues.begin() + begin, m_polygonValues.begin() + end);
+    targets.erase(targets.begin() + begin, targets.begin() + end);
+    endRemoveRows();
+    end = begin;
+  }
 
-    if (identical) {
-      // No changes, skip update
-      return;
+  // The longest run already in order stays put, every other row moves once, straight after the
+  // row it follows in the new order
+  auto kept = longestIncreasing(targets);
+  std::vector<size_t> order = targets;
+  std::sort(order.begin(), order.end());
+  std::vector<size_t> moving;
+  for (size_t row = 0; row < targets.size(); ++row) {
+    if (!kept[row]) {
+      moving.push_back(targets[row]);
+    }
+  }
+  std::sort(moving.begin(), moving.end());
+  auto rowOf = [&targets](size_t target) {
+    return static_cast<size_t>(std::find(targets.begin(), targets.end(), target) -
+                               targets.begin());
+  };
+  for (size_t target : moving) {
+    auto position = std::lower_bound(order.begin(), order.end(), target);
+    size_t from = rowOf(target);
+    size_t before = position == order.begin() ? 0 : rowOf(*(position - 1)) + 1;
+    if (before == from || before == from + 1) {
+      continue;
     }
+    beginMoveRows(QModelIndex(), static_cast<int>(from), static_cast<int>(from), QModelIndex(),
+                  static_cast<int>(before));
+    size_t to = from < before ? before - 1 : before;
+    moveElement(m_warnings, from, to);
+    moveElement(m_polygonValues, from, to);
+    moveElement(targets, from, to);
+    endMoveRows();
   }
 
-  // Determine if we can use row updates or need full reset
-  bool needsReset = (m_warnings.size() != sortedNew.size());
+  // Rows left in place now sit in their final order, new ones fill the gaps in runs
+  for (size_t row = 0; row < sortedNew.size();) {
+    if (matched[row]) {
+      ++row;
+      continue;
+    }
+    size_t end = row + 1;
+    while (end < sortedNew.size() && !matched[end]) {
+      ++end;
+    }
+    beginInsertRows(QModelIndex(), static_cast<int>(row), static_cast<int>(end - 1));
+    m_warnings.insert(m_warnings.begin() + row, std::make_move_iterator(sortedNew.begin() + row),
+                      std::make_move_iterator(sortedNew.begin() + end));
+    m_polygonValues.insert(m_polygonValues.begin() + row,
+                           std::make_move_iterator(polygonValues.begin() + row),
+                           std::make_move_iterator(polygonValues.begin() + end));
+    endInsertRows();
+    row = end;
+  }
 
-  if (needsReset) {
-    beginResetModel();
-    m_warnings = std::move(sortedNew);
-    m_warnings.shrink_to_fit();
-    endResetModel();
-  } else {
-    // Update rows individually
-    for (size_t i = 0; i < m_warnings.size(); ++i) {
-      m_warnings[i] = sortedNew[i];
-      QModelIndex idx = index(static_cast<int>(i));
-      emit dataChanged(idx, idx);
+  // Kept rows take the new version, only the roles that differ are announced
+  for (size_t row = 0; row < sortedNew.size(); ++row) {
+    if (!matched[row]) {
+      continue;
     }
+    m_warnings[row] = std::move(sortedNew[row]);
+    if (roles[row].isEmpty()) {
+      continue;
+    }
+    if (roles[row].contains(static_cast<int>(WarningRoles::POLYGON_PATH_ROLE))) {
+      m_polygonValues[row] = std::move(polygonValues[row]);
+    }
+    QModelIndex idx = index(static_cast<int>(row));
+    emit dataChanged(idx, idx, roles[row]);
   }
+  emit warningsApplied();
 }
 
 int WarningModel::calculateNextUpdateMs() {
@@ -183,20 +468,56 @@ int WarningModel::calculateNextUpdateMs() {
   return delayMs;
 }
 
-QVariantList WarningModel::getPolygonPath(const Warning& warning) {
-  const auto& multiPolygon = warning.getFloodAreaPolygon();
-  if (!multiPolygon.has_value() || multiPolygon->empty() || (*multiPolygon)[0].empty()) {
-    return {};
+WarningModel::PolygonValues WarningModel::convertPolygon(const Warning& warning) {
+  PolygonValues values;
+  values.source = warning.getGeometry();
+  const FlatMultiPolygon* fullPolygon = warning.getFloodAreaPolygon();
+  if (fullPolygon == nullptr) {
+    return values;
   }
 
-  const auto& exteriorRing = (*multiPolygon)[0][0];
-  QVariantList coordinates;
-  coordinates.reserve(static_cast<qsizetype>(exteriorRing.size()));
+  values.mesh = std::make_shared<const AreaMesh>(values.source);
 
-  for (const auto& coord : exteriorRing) {
-    // coord.first = longitude, coord.second = latitude
-    coordinates.append(QVariant::fromValue(QGeoCoordinate(coord.second, coord.first)));
+  // Serve the simplified levels once they have been built, else full detail at every zoom
+  const GeometryLod* lod = warning.getPolygonLod();
+  if (lod == nullptr) {
+    // QVariantList is implicitly shared, so the levels share one conversion
+    values.paths.fill(toPath(*fullPolygon));
+    return values;
+  }
+  for (int level = 0; level < GeometryLod::LEVELS; ++level) {
+    values.paths[level] = toPath(lod->forZoom(GeometryLod::MIN_ZOOM + level));
+  }
+  return values;
+}
+
+std::vector<WarningModel::PolygonValues>
+WarningModel::convertPolygons(const std::vector<Warning>& warnings,
+                              const std::vector<PolygonValues>& previous) {
+  // Refreshes share the geometry of areas they already had, so most rows find their values by
+  // polygon. previous holds that geometry, so a pointer here cannot belong to another polygon.
+  std::unordered_map<const FlatMultiPolygon*, const PolygonValues*> converted;
+  converted.reserve(previous.size());
+  for (const auto& values : previous) {
+    if (values.source.polygon != nullptr) {
+      converted.emplace(values.source.polygon.get(), &values);
+    }
   }
 
-  return coordinates;
+  std::vector<PolygonValues> values(warnings.size());
+  // Only value types are built, so the work can be shared with the pool
+  auto& pool = ThreadPool::shared();
+  pool.parallelFor(warnings.size(), CONVERT_CHUNK_SIZE, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      auto found = converted.find(warnings[i].getFloodAreaPolygon());
+      // Levels built since the last conversion need converting again
+      if (found != converted.end() &&
+          found->second->source.lod.get() == warnings[i].getPolygonLod()) {
+        values[i] = *found->second;
+      } else {
+        values[i] = convertPolygon(warnings[i]);
+      }
+    }
+  });
+  return values;
 }
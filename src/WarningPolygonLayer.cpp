@@ -0,0 +1,285 @@
+#include "WarningPolygonLayer.hpp"
+#include "WarningModel.hpp"
+#include <QColor>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGTransformNode>
+#include <cmath>
+#include <cstring>
+
+static constexpr float OUTLINE_WIDTH = 3.0F;
+
+namespace {
+
+// Fill and outline colours in bucket order, matching the old MapPolygon delegates
+const std::array<QColor, WarningPolygonLayer::SEVERITY_BUCKETS>& fillColors() {
+  static const std::array<QColor, WarningPolygonLayer::SEVERITY_BUCKETS> colors = {
+      QColor::fromRgbF(0.53F, 0.53F, 0.53F, 0.5F), QColor::fromRgbF(1.0F, 0.87F, 0.27F, 0.5F),
+      QColor::fromRgbF(1.0F, 0.6F, 0.27F, 0.5F), QColor::fromRgbF(1.0F, 0.27F, 0.27F, 0.5F)};
+  return colors;
+}
+
+const std::array<QColor, WarningPolygonLayer::SEVERITY_BUCKETS>& outlineColors() {
+  static const std::array<QColor, WarningPolygonLayer::SEVERITY_BUCKETS> colors = {
+      QColor("#888888"), QColor("#ffdd44"), QColor("#ff9944"), QColor("#ff4444")};
+  return colors;
+}
+
+// Most severe last, so it is drawn on top
+int bucketFor(int severityLevel) {
+  return severityLevel >= 1 && severityLevel <= 3 ? 4 - severityLevel : 0;
+}
+
+// Append one warning's area to a severity's mesh
+void appendToMesh(const AreaMesh::Level& area, std::vector<float>& vertices,
+                  std::vector<uint32_t>& triangles, std::vector<uint32_t>& outlines) {
+  auto base = static_cast<uint32_t>(vertices.size() / 2);
+  for (size_t i = 0; i < area.shape.pointCount(); ++i) {
+    auto [x, y] = area.shape.point(i);
+    vertices.push_back(static_cast<float>(x));
+    vertices.push_back(static_cast<float>(y));
+  }
+  for (uint32_t index : area.triangles) {
+    triangles.push_back(base + index);
+  }
+  for (uint32_t index : area.outlines) {
+    outlines.push_back(base + index);
+  }
+}
+
+QSGGeometry* meshGeometry(const std::vector<float>& vertices, const std::vector<uint32_t>& indices,
+                          QSGGeometry::DrawingMode mode) {
+  auto* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(),
+                                   static_cast<int>(vertices.size() / 2),
+                                   static_cast<int>(indices.size()), QSGGeometry::UnsignedIntType);
+  geometry->setDrawingMode(mode);
+  std::memcpy(geometry->vertexData(), vertices.data(), vertices.size() * sizeof(float));
+  std::memcpy(geometry->indexData(), indices.data(), indices.size() * sizeof(uint32_t));
+  return geometry;
+}
+
+QSGGeometryNode* colorNode(const QColor& color) {
+  auto* node = new QSGGeometryNode;
+  auto* material = new QSGFlatColorMaterial;
+  material->setColor(color);
+  node->setMaterial(material);
+  node->setFlag(QSGNode::OwnsMaterial);
+  node->setGeometry(new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0));
+  node->setFlag(QSGNode::OwnsGeometry);
+  return node;
+}
+
+} // namespace
+
+WarningPolygonLayer::WarningPolygonLayer(QQuickItem* parent) : QQuickItem(parent) {
+  setFlag(ItemHasContents, true);
+}
+
+void WarningPolygonLayer::setModel(WarningModel* model) {
+  if (m_model == model) {
+    return;
+  }
+  if (m_model != nullptr) {
+    disconnect(m_model, nullptr, this, nullptr);
+  }
+  m_model = model;
+  if (m_model != nullptr) {
+    connect(m_model, &QAbstractItemModel::modelReset, this, &WarningPolygonLayer::scheduleRebuild);
+    connect(m_model, &QAbstractItemModel::rowsInserted, this,
+            &WarningPolygonLayer::scheduleRebuild);
+    connect(m_model, &QAbstractItemModel::rowsRemoved, this,
+            &WarningPolygonLayer::scheduleRebuild);
+    connect(m_model, &QAbstractItemModel::rowsMoved, this, &WarningPolygonLayer::scheduleRebuild);
+    connect(m_model, &QAbstractItemModel::layoutChanged, this,
+            &WarningPolygonLayer::scheduleRebuild);
+    // Row signals only mark the layer stale, it catches up once the update is complete
+    connect(m_model, &WarningModel::warningsApplied, this,
+            &WarningPolygonLayer::rebuildIfPending);
+    connect(m_model, &QAbstractItemModel::dataChanged, this,
+            [this](const QModelIndex& topLeft, const QModelIndex& bottomRight,
+                   const QList<int>& roles) {
+              // Text alone changing leaves the meshes as they are
+              auto drawn = [&roles](WarningModel::WarningRoles role) {
+                return roles.contains(static_cast<int>(role));
+              };
+              if (!roles.isEmpty() && !drawn(WarningModel::WarningRoles::SEVERITY_LEVEL_ROLE) &&
+                  !drawn(WarningModel::WarningRoles::POLYGON_PATH_ROLE)) {
+                return;
+              }
+              // The model's zoom also changes polygonPath, leaving the geometry as it was
+              for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+                if (rowChanged(static_cast<size_t>(row))) {
+                  scheduleRebuild();
+                  return;
+                }
+              }
+            });
+  }
+  rebuild();
+  emit modelChanged();
+}
+
+void WarningPolygonLayer::setCenter(const QGeoCoordinate& center) {
+  if (m_center == center) {
+    return;
+  }
+  m_center = center;
+  update();
+  emit centerChanged();
+}
+
+void WarningPolygonLayer::setZoomLevel(double zoomLevel) {
+  if (m_zoomLevel == zoomLevel) {
+    return;
+  }
+  int previous = level();
+  m_zoomLevel = zoomLevel;
+  if (level() != previous) {
+    mergeLevel(level());
+    m_geometryDirty = true;
+  }
+  update();
+  emit zoomLevelChanged();
+}
+
+void WarningPolygonLayer::setBearing(double bearing) {
+  if (m_bearing == bearing) {
+    return;
+  }
+  m_bearing = bearing;
+  update();
+  emit bearingChanged();
+}
+
+int WarningPolygonLayer::warningAt(QPointF point) const {
+  int current = level();
+  // Until the rebuild runs, the rows held here may no longer be the model's
+  if (m_rebuildPending || !m_merged[current]) {
+    return -1;
+  }
+  QPointF projected = viewMatrix().inverted().map(point);
+  // Rows run from most to least severe, the order they are stacked in from the top, and the
+  // grid offers them lowest first
+  return m_grids[current].find(projected.x(), projected.y(), [&](uint32_t row) {
+    return m_rows[row].mesh->contains(current, projected.x(), projected.y());
+  });
+}
+
+// A model update signals row by row, one rebuild after it covers them all. It normally runs on
+// warningsApplied, the queued call covers row signals sent without one.
+void WarningPolygonLayer::scheduleRebuild() {
+  if (m_rebuildPending) {
+    return;
+  }
+  m_rebuildPending = true;
+  QMetaObject::invokeMethod(this, &WarningPolygonLayer::rebuildIfPending, Qt::QueuedConnection);
+}
+
+void WarningPolygonLayer::rebuildIfPending() {
+  if (m_rebuildPending) {
+    rebuild();
+  }
+}
+
+bool WarningPolygonLayer::rowChanged(size_t row) const {
+  if (m_model == nullptr || m_rebuildPending || row >= m_rows.size() ||
+      row >= m_model->getWarnings().size()) {
+    return true;
+  }
+  const Warning& warning = m_model->getWarnings()[row];
+  const Row& drawn = m_rows[row];
+  if (drawn.bucket != bucketFor(warning.getSeverityLevel())) {
+    return true;
+  }
+  return drawn.mesh != m_model->getAreaMesh(row);
+}
+
+// Meshes come from the model ready to draw, so this is only a merge by severity
+void WarningPolygonLayer::rebuild() {
+  m_rebuildPending = false;
+  size_t rows = m_model != nullptr ? m_model->getWarnings().size() : 0;
+  m_rows.assign(rows, Row{});
+  for (size_t row = 0; row < rows; ++row) {
+    m_rows[row].mesh = m_model->getAreaMesh(row);
+    m_rows[row].bucket = bucketFor(m_model->getWarnings()[row].getSeverityLevel());
+  }
+
+  // Other levels are merged when the map zooms to them
+  for (int other = 0; other < GeometryLod::LEVELS; ++other) {
+    m_meshes[other] = {};
+    m_grids[other] = {};
+    m_merged[other] = false;
+  }
+  mergeLevel(level());
+  m_geometryDirty = true;
+  update();
+}
+
+void WarningPolygonLayer::mergeLevel(int level) {
+  if (m_merged[level]) {
+    return;
+  }
+  std::vector<const AreaMesh::Bounds*> bounds(m_rows.size(), nullptr);
+  for (size_t i = 0; i < m_rows.size(); ++i) {
+    const Row& row = m_rows[i];
+    if (row.mesh == nullptr || row.mesh->level(level).shape.empty()) {
+      continue;
+    }
+    const AreaMesh::Level& area = row.mesh->level(level);
+    Mesh& mesh = m_meshes[level][row.bucket];
+    appendToMesh(area, mesh.vertices, mesh.triangles, mesh.outlines);
+    bounds[i] = &area.bounds;
+  }
+  m_grids[level] = AreaGrid(bounds);
+  m_merged[level] = true;
+}
+
+// Projected pixels at zoom 0 around the origin to item pixels, as the map shows them
+QMatrix4x4 WarningPolygonLayer::viewMatrix() const {
+  QPointF center;
+  if (m_center.isValid()) {
+    auto [x, y] = AreaMesh::project(m_center.longitude(), m_center.latitude());
+    center = QPointF(x, y);
+  }
+  auto scale = static_cast<float>(std::exp2(m_zoomLevel));
+  QMatrix4x4 matrix;
+  matrix.translate(static_cast<float>(width() / 2.0), static_cast<float>(height() / 2.0));
+  // The bearing is the compass direction at the top of the map, so the map turns against it
+  matrix.rotate(static_cast<float>(-m_bearing), 0.0F, 0.0F, 1.0F);
+  matrix.scale(scale);
+  matrix.translate(static_cast<float>(-center.x()), static_cast<float>(-center.y()));
+  return matrix;
+}
+
+QSGNode* WarningPolygonLayer::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* /*data*/) {
+  auto* root = static_cast<QSGTransformNode*>(oldNode);
+  if (root == nullptr) {
+    root = new QSGTransformNode;
+    // Per bucket a fill then its outline, least severe first
+    for (int bucket = 0; bucket < SEVERITY_BUCKETS; ++bucket) {
+      root->appendChildNode(colorNode(fillColors()[bucket]));
+      root->appendChildNode(colorNode(outlineColors()[bucket]));
+    }
+    m_geometryDirty = true;
+  }
+  root->setMatrix(viewMatrix());
+
+  if (m_geometryDirty) {
+    auto* node = static_cast<QSGGeometryNode*>(root->firstChild());
+    for (const Mesh& mesh : m_meshes[level()]) {
+      node->setGeometry(
+          meshGeometry(mesh.vertices, mesh.triangles, QSGGeometry::DrawTriangles));
+      node->markDirty(QSGNode::DirtyGeometry);
+      node = static_cast<QSGGeometryNode*>(node->nextSibling());
+
+      QSGGeometry* outline = meshGeometry(mesh.vertices, mesh.outlines, QSGGeometry::DrawLines);
+      // Honoured where the graphics API has wide lines, elsewhere outlines are 1 px
+      outline->setLineWidth(OUTLINE_WIDTH);
+      node->setGeometry(outline);
+      node->markDirty(QSGNode::DirtyGeometry);
+      node = static_cast<QSGGeometryNode*>(node->nextSibling());
+    }
+    m_geometryDirty = false;
+  }
+  return root;
+}
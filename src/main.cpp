@@ -1,11 +1,19 @@
 #include "HttpClient.hpp"
+#include "HttpMetrics.hpp"
 #include "MonitoringData.hpp"
+#include "ParserPool.hpp"
+#include "PolygonCache.hpp"
+#include "RecordingHttpClient.hpp"
+#include "ReplayHttpClient.hpp"
 #include "StationCluster.hpp"
 #include "StationModel.hpp"
 #include "WarningModel.hpp"
+#include "WarningPolygonLayer.hpp"
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <cstdlib>
+#include <filesystem>
 #include <future>
 #include <iostream>
 #include <simdjson.h>
@@ -15,30 +23,80 @@ static inline auto msSince(std::chrono::steady_clock::time_point t) {
       .count();
 }
 
+// Positive integer from the environment, or fallback
+static long envLong(const char* name, long fallback) {
+  const char* value = std::getenv(name); // NOLINT(concurrency-mt-unsafe)
+  if (value != nullptr) {
+    long parsed = std::strtol(value, nullptr, 10);
+    if (parsed > 0) {
+      return parsed;
+    }
+  }
+  return fallback;
+}
+
+// FLOODWATCHER_METRICS_INTERVAL overrides how often HTTP metrics are dumped, in seconds
+static std::chrono::seconds metricsDumpInterval() {
+  return std::chrono::seconds(envLong("FLOODWATCHER_METRICS_INTERVAL", 15 * 60));
+}
+
+// FLOODWATCHER_RECORD_DIR saves every response to a fixture directory and
+// FLOODWATCHER_REPLAY_DIR serves such a recording instead of the network, slowed down by
+// FLOODWATCHER_REPLAY_LATENCY_MS and FLOODWATCHER_REPLAY_BYTES_PER_SECOND when set.
+// FLOODWATCHER_REPLAY_NOT_MODIFIED=1 answers repeated conditional fetches as unchanged. Either
+// way the polygon cache starts empty, so every polygon goes through the client.
+static void installHttpFixtures() {
+  const char* recordDir = std::getenv("FLOODWATCHER_RECORD_DIR"); // NOLINT(concurrency-mt-unsafe)
+  const char* replayDir = std::getenv("FLOODWATCHER_REPLAY_DIR"); // NOLINT(concurrency-mt-unsafe)
+
+  // Function statics, so they outlive the polygon cache's background revalidation
+  if (replayDir != nullptr) {
+    ReplayProfile profile;
+    profile.latency = std::chrono::milliseconds(envLong("FLOODWATCHER_REPLAY_LATENCY_MS", 0));
+    profile.bytesPerSecond =
+        static_cast<uint64_t>(envLong("FLOODWATCHER_REPLAY_BYTES_PER_SECOND", 0));
+    profile.notModifiedOnRepeat = envLong("FLOODWATCHER_REPLAY_NOT_MODIFIED", 0) != 0;
+    static ReplayHttpClient replay(replayDir, profile);
+    std::cout << "Replaying " << replay.size() << " recorded responses from " << replayDir
+              << '\n';
+    HttpClient::setInstance(&replay);
+  } else if (recordDir != nullptr) {
+    static RecordingHttpClient recorder(HttpClient::getInstance(), recordDir);
+    std::cout << "Recording responses to " << recordDir << '\n';
+    HttpClient::setInstance(&recorder);
+  } else {
+    return;
+  }
+
+  static const std::filesystem::path coldCacheDir =
+      std::filesystem::temp_directory_path() / "FloodWatcher" / "fixture-polygons";
+  std::error_code ec;
+  std::filesystem::remove_all(coldCacheDir, ec);
+  static PolygonCache coldCache(coldCacheDir);
+  PolygonCache::setInstance(&coldCache);
+}
+
 int main(int argc, char* argv[]) {
   auto t0 = std::chrono::steady_clock::now();
   std::cout << "startup: " << msSince(t0) << " ms\n";
 
   try {
     QGuiApplication app(argc, argv);
+    installHttpFixtures();
 
     MonitoringData monitoringData;
-    simdjson::dom::parser parser;
 
-    // Fetch stations and warnings concurrently
+    // Fetch stations and warnings concurrently on the HTTP client's network thread
     auto t1 = std::chrono::steady_clock::now();
-    auto stationsFuture = std::async(std::launch::async, []() {
-      return HttpClient::getInstance().fetchUrl(
-          "https://environment.data.gov.uk/flood-monitoring/id/stations?status=Active");
-    });
+    auto stationsFuture = HttpClient::getInstance().fetchUrlAsync(
+        "https://environment.data.gov.uk/flood-monitoring/id/stations?status=Active");
 
-    auto warningsFuture = std::async(std::launch::async, []() {
-      return HttpClient::getInstance().fetchUrl(
-          "https://environment.data.gov.uk/flood-monitoring/id/floods");
-    });
+    // Conditional fetch so the validators are in place for the first WarningModel refresh
+    auto warningsFuture = HttpClient::getInstance().fetchUrlIfModifiedAsync(
+        "https://environment.data.gov.uk/flood-monitoring/id/floods");
 
     auto stationsResponse = stationsFuture.get();
-    auto warningsResponse = warningsFuture.get();
+    auto warningsResponse = warningsFuture.get().body;
     std::cout << "fetch stations and warnings: " << msSince(t1) << " ms\n";
 
     // Stations
@@ -47,22 +105,25 @@ int main(int argc, char* argv[]) {
       return 1;
     }
 
-    std::string readBuffer = *stationsResponse;
+    // Bodies arrive with simdjson padding, so parse them where they are
+    const std::string& stationsBody = *stationsResponse;
 
     auto t2 = std::chrono::steady_clock::now();
     try {
-      simdjson::dom::element data;
-      auto error = parser.parse(readBuffer).get(data);
-      if (error != 0U) {
-        std::cerr << "simdjson Parse Error: " << error << "\n";
-        std::cerr << "Raw response:\n" << readBuffer << '\n';
+      // On-Demand reads the catalogue in one pass without building a DOM first
+      ParseReport report = monitoringData.parseStationsOnDemand(stationsBody);
+      if (!report.ok()) {
+        report.log(std::cerr, "stations");
+        std::cerr << "Raw response:\n" << stationsBody << '\n';
         return 1;
       }
-      monitoringData.parseStations(data);
+      if (!report.clean()) {
+        report.log(std::cerr, "stations");
+      }
       std::cout << "Found " << monitoringData.getStations().size() << " stations\n";
     } catch (const std::exception& e) {
       std::cerr << "Parse Error: " << e.what() << "\n";
-      std::cerr << "Raw response:\n" << readBuffer << '\n';
+      std::cerr << "Raw response:\n" << stationsBody << '\n';
       return 1;
     }
     std::cout << "parse stations: " << msSince(t2) << " ms\n";
@@ -84,30 +145,36 @@ int main(int argc, char* argv[]) {
       return 1;
     }
 
-    readBuffer = *warningsResponse;
+    const std::string& warningsBody = *warningsResponse;
 
     auto t5 = std::chrono::steady_clock::now();
     try {
+      // Handed back to the pool afterwards, warm for the first WarningModel refresh
+      auto parser = ParserPool::getInstance().acquire();
       simdjson::dom::element data;
-      auto error = parser.parse(readBuffer).get(data);
+      auto error = parser->parse(warningsBody).get(data);
       if (error != 0U) {
         std::cerr << "simdjson Parse Error: " << error << "\n";
-        std::cerr << "Raw response:\n" << readBuffer << '\n';
+        std::cerr << "Raw response:\n" << warningsBody << '\n';
         return 1;
       }
-      monitoringData.parseWarnings(data);
+      ParseReport report = monitoringData.parseWarnings(data);
+      if (!report.clean()) {
+        report.log(std::cerr, "warnings");
+      }
       std::cout << "Found " << monitoringData.getWarnings().size() << " warnings\n";
     } catch (const std::exception& e) {
       std::cerr << "Parse Error: " << e.what() << "\n";
-      std::cerr << "Raw response:\n" << readBuffer << '\n';
+      std::cerr << "Raw response:\n" << warningsBody << '\n';
       return 1;
     }
     std::cout << "parse warnings: " << msSince(t5) << " ms\n";
 
     // Polygons
     auto t6 = std::chrono::steady_clock::now();
-    monitoringData.fetchAllPolygonsAsync();
+    PolygonTimings polygonTimings = monitoringData.fetchAllPolygonsAsync();
     std::cout << "fetch polygons: " << msSince(t6) << " ms\n";
+    polygonTimings.log(std::cout);
 
     auto t7 = std::chrono::steady_clock::now();
     WarningModel warningModel(monitoringData.getWarnings());
@@ -116,6 +183,8 @@ int main(int argc, char* argv[]) {
     // Load QML
     auto t8 = std::chrono::steady_clock::now();
     QQmlApplicationEngine engine;
+    qmlRegisterAnonymousType<WarningModel>("FloodMonitor", 1);
+    qmlRegisterType<WarningPolygonLayer>("FloodMonitor", 1, 0, "WarningPolygonLayer");
     engine.setInitialProperties({{"stationModel", QVariant::fromValue(&model)},
                                  {"clusterModel", QVariant::fromValue(&clusterModel)},
                                  {"warningModel", QVariant::fromValue(&warningModel)}});
@@ -125,6 +194,10 @@ int main(int argc, char* argv[]) {
     // Start auto-update after QML is loaded
     warningModel.startAutoUpdate();
     std::cout << "total: " << msSince(t0) << " ms\n";
+
+    // Startup network breakdown now, then a periodic dump for long-running sessions
+    HttpMetrics::getInstance().dump(std::cout);
+    HttpMetrics::getInstance().startPeriodicDump(metricsDumpInterval(), std::cout);
 #ifdef ENABLE_PROFILING_EXIT
     return 0;
 #else
@@ -4,6 +4,7 @@
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class MockHttpClient : public IHttpClient {
@@ -16,6 +17,19 @@ class MockHttpClient : public IHttpClient {
       return std::nullopt;
     }
 
+    FetchResult fetchUrlIfModified(const std::string& url) override {
+      if (notModified_.count(url) != 0U) {
+        return {FetchStatus::NOT_MODIFIED, std::nullopt, {}};
+      }
+      auto body = fetchUrl(url);
+      if (!body) {
+        return {};
+      }
+      auto it = validators_.find(url);
+      return {FetchStatus::OK, std::move(body),
+              it != validators_.end() ? it->second : CacheValidators{}};
+    }
+
     std::vector<std::optional<std::string>>
     fetchUrls(const std::vector<std::string>& urls) override {
       std::vector<std::optional<std::string>> results;
@@ -28,10 +42,65 @@ class MockHttpClient : public IHttpClient {
       return results;
     }
 
+    void fetchUrls(const std::vector<std::string>& urls, const CompletionHandler& onComplete,
+                   const FetchOptions& options) override {
+      lastOptions_ = options;
+      for (size_t i = 0; i < urls.size(); ++i) {
+        onComplete(i, fetchUrl(urls[i]));
+      }
+    }
+
+    // Completes inline so tests stay deterministic
+    void fetchAsync(const std::string& url, bool ifModified, ResultHandler onComplete) override {
+      if (ifModified) {
+        onComplete(fetchUrlIfModified(url));
+        return;
+      }
+      auto body = fetchUrl(url);
+      FetchStatus status = body ? FetchStatus::OK : FetchStatus::FAILED;
+      onComplete({status, std::move(body), {}});
+    }
+
+    // Not-modified URLs only report so when the request carries validators, as a server would
+    void fetchAsync(const std::string& url, const CacheValidators& validators,
+                    ResultHandler onComplete) override {
+      sentValidators_[url] = validators;
+      if (validators.empty() && notModified_.count(url) != 0U) {
+        auto body = fetchUrl(url);
+        FetchStatus status = body ? FetchStatus::OK : FetchStatus::FAILED;
+        onComplete({status, std::move(body), {}});
+        return;
+      }
+      onComplete(fetchUrlIfModified(url));
+    }
+
     void addResponse(const std::string& url, const std::string& response) {
       responses_[url] = response;
     }
 
+    void setNotModified(const std::string& url) {
+      notModified_.insert(url);
+    }
+
+    // Validators sent with OK responses for url
+    void setValidators(const std::string& url, CacheValidators validators) {
+      validators_[url] = std::move(validators);
+    }
+
+    // Validators the last validator-carrying fetchAsync sent for url
+    CacheValidators getSentValidators(const std::string& url) const {
+      auto it = sentValidators_.find(url);
+      return it != sentValidators_.end() ? it->second : CacheValidators{};
+    }
+
+    const FetchOptions& getLastOptions() const {
+      return lastOptions_;
+    }
+
   private:
     std::unordered_map<std::string, std::string> responses_;
+    std::unordered_set<std::string> notModified_;
+    std::unordered_map<std::string, CacheValidators> validators_;
+    std::unordered_map<std::string, CacheValidators> sentValidators_;
+    FetchOptions lastOptions_;
 };
\ No newline at end of file
@@ -0,0 +1,54 @@
+// tests/cpp/unit/AreaGridTest.cpp
+#include "AreaGrid.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+
+auto anyHit = [](uint32_t /*area*/) { return true; };
+
+} // namespace
+
+TEST(AreaGridTest, FindsTheLowestAreaWhoseBoundsHoldThePoint) {
+  AreaMesh::Bounds big{0.0, 0.0, 10.0, 10.0};
+  AreaMesh::Bounds corner{8.0, 8.0, 9.0, 9.0};
+  AreaMesh::Bounds far{50.0, 50.0, 60.0, 60.0};
+  AreaGrid grid({&corner, nullptr, &big, &far});
+
+  EXPECT_EQ(grid.find(8.5, 8.5, anyHit), 0);
+  EXPECT_EQ(grid.find(1.0, 1.0, anyHit), 2);
+  EXPECT_EQ(grid.find(55.0, 55.0, anyHit), 3);
+  // Inside the grid but in no area's bounds, then outside the grid altogether
+  EXPECT_EQ(grid.find(30.0, 30.0, anyHit), -1);
+  EXPECT_EQ(grid.find(-1.0, 5.0, anyHit), -1);
+  EXPECT_EQ(grid.find(61.0, 55.0, anyHit), -1);
+}
+
+TEST(AreaGridTest, FallsThroughToLowerAreasTheHitRejects) {
+  AreaMesh::Bounds first{0.0, 0.0, 4.0, 4.0};
+  AreaMesh::Bounds second{2.0, 2.0, 6.0, 6.0};
+  AreaGrid grid({&first, &second});
+
+  std::vector<uint32_t> offered;
+  int found = grid.find(3.0, 3.0, [&offered](uint32_t area) {
+    offered.push_back(area);
+    return area == 1;
+  });
+
+  EXPECT_EQ(found, 1);
+  EXPECT_EQ(offered, (std::vector<uint32_t>{0, 1}));
+}
+
+TEST(AreaGridTest, BoundsOnTheExtentEdgeAreFound) {
+  AreaMesh::Bounds point{3.0, 3.0, 3.0, 3.0};
+  AreaMesh::Bounds box{0.0, 0.0, 3.0, 3.0};
+  AreaGrid grid({&point, &box});
+
+  EXPECT_EQ(grid.find(3.0, 3.0, anyHit), 0);
+  EXPECT_EQ(grid.find(0.0, 0.0, anyHit), 1);
+}
+
+TEST(AreaGridTest, EmptyGridFindsNothing) {
+  EXPECT_EQ(AreaGrid().find(0.0, 0.0, anyHit), -1);
+  EXPECT_EQ(AreaGrid({nullptr, nullptr}).find(0.0, 0.0, anyHit), -1);
+}
@@ -0,0 +1,82 @@
+// tests/cpp/unit/AreaMeshTest.cpp
+#include "AreaMesh.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace {
+
+// A degree square around (0.5, 51.5) with a square hole in its middle, closed rings
+SharedGeometry squareWithHole() {
+  MultiPolygon mp = {{{{0.0, 51.0}, {1.0, 51.0}, {1.0, 52.0}, {0.0, 52.0}, {0.0, 51.0}},
+                      {{0.4, 51.4}, {0.6, 51.4}, {0.6, 51.6}, {0.4, 51.6}, {0.4, 51.4}}}};
+  SharedGeometry geometry;
+  geometry.polygon = std::make_shared<const FlatMultiPolygon>(mp);
+  return geometry;
+}
+
+} // namespace
+
+TEST(AreaMeshTest, ProjectsTheOriginToZero) {
+  auto [x, y] = AreaMesh::project(-1.4, 53.0);
+  EXPECT_NEAR(x, 0.0, 1e-9);
+  EXPECT_NEAR(y, 0.0, 1e-9);
+
+  // East is right and north is up the screen
+  auto [eastX, eastY] = AreaMesh::project(-0.4, 53.0);
+  auto [northX, northY] = AreaMesh::project(-1.4, 54.0);
+  EXPECT_NEAR(eastX, 256.0 / 360.0, 1e-9);
+  EXPECT_NEAR(eastY, 0.0, 1e-9);
+  EXPECT_NEAR(northX, 0.0, 1e-9);
+  EXPECT_LT(northY, 0.0);
+}
+
+TEST(AreaMeshTest, TriangulatesAndOutlinesEveryRing) {
+  AreaMesh mesh(squareWithHole());
+  const auto& level = mesh.level(0);
+
+  ASSERT_EQ(level.shape.pointCount(), 10U);
+  // A square with a square hole needs eight triangles
+  EXPECT_EQ(level.triangles.size(), 3U * 8);
+  // Four edges per closed ring
+  EXPECT_EQ(level.outlines.size(), 2U * 8);
+  EXPECT_EQ(level.outlines[0], 0U);
+  EXPECT_EQ(level.outlines[8], 5U);
+  for (uint32_t index : level.triangles) {
+    EXPECT_LT(index, level.shape.pointCount());
+  }
+
+  auto [left, top] = AreaMesh::project(0.0, 52.0);
+  auto [right, bottom] = AreaMesh::project(1.0, 51.0);
+  EXPECT_DOUBLE_EQ(level.bounds.minX, left);
+  EXPECT_DOUBLE_EQ(level.bounds.minY, top);
+  EXPECT_DOUBLE_EQ(level.bounds.maxX, right);
+  EXPECT_DOUBLE_EQ(level.bounds.maxY, bottom);
+}
+
+TEST(AreaMeshTest, LevelsShareFullDetailWithoutSimplifiedOnes) {
+  AreaMesh mesh(squareWithHole());
+  EXPECT_EQ(&mesh.level(0), &mesh.level(GeometryLod::LEVELS - 1));
+
+  SharedGeometry geometry = squareWithHole();
+  geometry.lod = std::make_shared<const GeometryLod>(*geometry.polygon);
+  AreaMesh simplified(geometry);
+  EXPECT_NE(&simplified.level(0), &simplified.level(GeometryLod::LEVELS - 1));
+  EXPECT_EQ(simplified.source().lod, geometry.lod);
+}
+
+TEST(AreaMeshTest, ContainsLeavesOutHoles) {
+  AreaMesh mesh(squareWithHole());
+  auto [insideX, insideY] = AreaMesh::project(0.2, 51.2);
+  auto [holeX, holeY] = AreaMesh::project(0.5, 51.5);
+  auto [outsideX, outsideY] = AreaMesh::project(1.5, 51.5);
+
+  EXPECT_TRUE(mesh.contains(0, insideX, insideY));
+  EXPECT_FALSE(mesh.contains(0, holeX, holeY));
+  EXPECT_FALSE(mesh.contains(0, outsideX, outsideY));
+}
+
+TEST(AreaMeshTest, EmptyGeometryHasNothingToDraw) {
+  AreaMesh mesh(SharedGeometry{});
+  EXPECT_TRUE(mesh.level(3).triangles.empty());
+  EXPECT_FALSE(mesh.contains(3, 0.0, 0.0));
+}
@@ -0,0 +1,115 @@
+// tests/cpp/unit/CoordinateDecoderTest.cpp
+#include "CoordinateDecoder.hpp"
+#include "Warning.hpp"
+#include <array>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <random>
+#include <simdjson.h>
+#include <string>
+
+namespace {
+
+// Decode geometry both ways, the DOM parser being the reference
+void expectSameAsDom(const std::string& json) {
+  simdjson::dom::parser domParser;
+  simdjson::dom::element element;
+  ASSERT_EQ(domParser.parse(json).get(element), simdjson::SUCCESS) << json;
+  FlatMultiPolygon expected = Warning::parseGeoJsonPolygon(element);
+
+  FlatMultiPolygon decoded;
+  ASSERT_TRUE(decodeGeometry(json, decoded)) << json;
+
+  EXPECT_EQ(decoded, expected) << json;
+}
+
+std::string format(double value, int precision) {
+  std::array<char, 32> buffer{};
+  std::snprintf(buffer.data(), buffer.size(), "%.*g", precision, value);
+  return buffer.data();
+}
+
+} // namespace
+
+TEST(CoordinateDecoderTest, MatchesDomParser) {
+  expectSameAsDom(R"({"type": "Polygon", "coordinates": [[[0.0, 0.0], [1, 0], [1.5e-1, -2E2],
+      [0.0, 0.0]], [[0.2, 0.2], [0.3, 0.2], [0.2, 0.2]]]})");
+  expectSameAsDom(R"({"type": "MultiPolygon", "bbox": [0, 9], "coordinates": [[[[1, 2], [3, 4]]],
+      [[[5, 6], [7, 8, 9]]]], "type": "Point"})");
+  expectSameAsDom(R"({"type": "Polygon", "coordinates": []})");
+  expectSameAsDom(R"({"type": "Polygon", "coordinates": [[]]})");
+  expectSameAsDom(R"({"type": "MultiPolygon", "coordinates": [[[0, 0], [1, 1]]]})");
+}
+
+TEST(CoordinateDecoderTest, LeavesUnusualGeometryToTheDomParser) {
+  for (const char* json :
+       {R"({"coordinates": [[[1, 2]]], "type": "Polygon"})", R"({"type": "Polygon"})",
+        R"({"type": "MultiPolygon", "coordinates": "not an array"})",
+        R"({"type": "Point", "coordinates": [1, 2]})",
+        R"({"type": "Poly\u0067on", "coordinates": []})",
+        R"({"\u0074ype": "Point", "type": "Polygon", "coordinates": []})"}) {
+    FlatMultiPolygon out;
+    EXPECT_FALSE(decodeGeometry(json, out)) << json;
+  }
+}
+
+TEST(CoordinateDecoderTest, SkipsInvalidMembersLikeDomParser) {
+  expectSameAsDom(R"({"type": "Polygon", "coordinates": [
+      [[0.0, 1.0], "not an array", [2.0], null, [3, "x"], ["[]", 4], [[5], 6], [7, 8, {"a": "]"}]],
+      "ring", 5, {"ring": [[1, 2]]}, [[9, 10]]]})");
+  expectSameAsDom(R"({"type": "MultiPolygon", "coordinates": [true, [], [[]], [[[1, 2]]]]})");
+}
+
+TEST(CoordinateDecoderTest, MatchesDomParserOnLargeRings) {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> lon(-6.0, 2.0);
+  std::uniform_real_distribution<double> lat(49.0, 56.0);
+  std::string json = R"({"type": "MultiPolygon", "coordinates": [)";
+  for (int p = 0; p < 3; ++p) {
+    json += p > 0 ? ", [" : "[";
+    for (int r = 0; r < 2; ++r) {
+      json += r > 0 ? ", [" : "[";
+      for (int i = 0; i < 5000; ++i) {
+        // Short numbers take the fast path, 17 significant digits fall back to from_chars
+        int precision = 6 + (i % 12);
+        json += (i > 0 ? ", [" : "[") + format(lon(rng), precision) + ", " +
+                format(lat(rng), precision);
+        json += i % 7 == 0 ? ", 1e-3]" : "]";
+      }
+      json += "]";
+    }
+    json += "]";
+  }
+  json += "]}";
+  expectSameAsDom(json);
+}
+
+TEST(CoordinateDecoderTest, RejectsMalformedText) {
+  for (const char* text : {"[[[1, 2]", "[[[1, 2]]]]", "[[[1 2]]]", "[[[1, 2],]]", "[[[-, 2]]]",
+                           "[[[1, 2x]]]", "[[[\"1, 2]]]"}) {
+    FlatMultiPolygon out;
+    EXPECT_FALSE(decodeCoordinates(text, GeometryKind::POLYGON, out)) << text;
+  }
+  FlatMultiPolygon out;
+  EXPECT_TRUE(decodeCoordinates(" [ [ [ 1 , 2 ] ] ] ", GeometryKind::POLYGON, out));
+  EXPECT_EQ(out.pointCount(), 1);
+}
+
+TEST(CoordinateDecoderTest, DecodesFirstFeatureGeometry) {
+  // Nothing after the coordinates is read, not even the broken second feature
+  FlatMultiPolygon out;
+  ASSERT_TRUE(decodeFeatureGeometry(R"({"type": "FeatureCollection", "name": "a \"}\" b",
+      "features": [{"properties": {"geometry": 1}, "type": "Feature",
+      "geometry": {"type": "Polygon", "coordinates": [[[1, 2]]]}}, {"broken": ]})",
+                                    out));
+  EXPECT_EQ(out, FlatMultiPolygon(MultiPolygon{{{{1.0, 2.0}}}}));
+
+  for (const char* document :
+       {R"({"features": []})", R"({"features": [{"geometry": null}]})",
+        R"({"features": [[], {"geometry": {}}]})", R"({"type": "FeatureCollection"})",
+        R"([{"geometry": {}}])", R"({"features": [{"geometry": {"type": "Polygon",)",
+        R"({"features": [{"geometry": {"type": "Polygon", "coordinates": [[[1, 2]]}}]})"}) {
+    FlatMultiPolygon rejected;
+    EXPECT_FALSE(decodeFeatureGeometry(document, rejected)) << document;
+  }
+}
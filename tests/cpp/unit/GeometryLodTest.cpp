@@ -0,0 +1,130 @@
+// tests/cpp/unit/GeometryLodTest.cpp
+#include "GeometryLod.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace {
+
+// A closed ring of count points around a circle, in degrees near the middle of England
+LinearRing circle(size_t count, double radius) {
+  LinearRing ring;
+  for (size_t i = 0; i < count; ++i) {
+    double angle = 2.0 * M_PI * static_cast<double>(i) / static_cast<double>(count);
+    ring.emplace_back(-1.5 + (radius * std::cos(angle)), 52.5 + (radius * std::sin(angle)));
+  }
+  ring.push_back(ring.front());
+  return ring;
+}
+
+} // namespace
+
+TEST(GeometryLodTest, LevelsCoverTheMapZoomRange) {
+  EXPECT_EQ(GeometryLod::levelForZoom(6.125), 0);
+  EXPECT_EQ(GeometryLod::levelForZoom(3.0), 0);
+  EXPECT_EQ(GeometryLod::levelForZoom(NAN), 0);
+  EXPECT_EQ(GeometryLod::levelForZoom(10.9), 4);
+  EXPECT_EQ(GeometryLod::levelForZoom(15.0), GeometryLod::LEVELS - 1);
+  EXPECT_EQ(GeometryLod::levelForZoom(20.0), GeometryLod::LEVELS - 1);
+
+  EXPECT_DOUBLE_EQ(GeometryLod::toleranceForZoom(7), GeometryLod::toleranceForZoom(6) / 2);
+}
+
+TEST(GeometryLodTest, CoarserZoomsGetFewerPoints) {
+  FlatMultiPolygon source(MultiPolygon{{circle(4000, 0.05)}});
+  GeometryLod lod(source);
+
+  size_t national = lod.forZoom(6.125).pointCount();
+  size_t town = lod.forZoom(11).pointCount();
+  size_t street = lod.forZoom(15).pointCount();
+  EXPECT_LT(national, town);
+  EXPECT_LT(town, street);
+  EXPECT_LE(street, source.pointCount());
+  EXPECT_GE(national, 4);
+
+  auto ring = lod.forZoom(6.125)[0][0];
+  EXPECT_EQ(ring[0], ring[ring.size() - 1]);
+}
+
+TEST(GeometryLodTest, DropsCollinearPointsAndKeepsCorners) {
+  FlatMultiPolygon square(MultiPolygon{{{{0.0, 0.0},
+                                         {0.5, 0.0},
+                                         {1.0, 0.0},
+                                         {1.0, 0.5},
+                                         {1.0, 1.0},
+                                         {0.5, 1.0},
+                                         {0.0, 1.0},
+                                         {0.0, 0.5},
+                                         {0.0, 0.0}}}});
+  auto simplified = GeometryLod::simplify(square, 1e-6);
+  ASSERT_EQ(simplified.size(), 1);
+  EXPECT_EQ(simplified[0][0].size(), 5);
+}
+
+TEST(GeometryLodTest, ThinRingsKeepAnArea) {
+  FlatMultiPolygon sliver(MultiPolygon{
+      {{{0.0, 0.0}, {1.0, 0.0}, {2.0, 0.001}, {1.0, 0.002}, {0.0, 0.002}, {0.0, 0.0}}}});
+  auto simplified = GeometryLod::simplify(sliver, 1.0);
+  EXPECT_GE(simplified[0][0].size(), 4);
+}
+
+TEST(GeometryLodTest, SimplifiedRingsDoNotCrossHoles) {
+  // A bump in the top edge with a hole straddling its base, straightening the edge would cut
+  // through the hole
+  FlatMultiPolygon source(MultiPolygon{{
+      {{0.0, 0.0}, {1.0, 0.0}, {1.0, 1.0}, {0.6, 1.0}, {0.5, 1.1}, {0.4, 1.0}, {0.0, 1.0},
+       {0.0, 0.0}},
+      {{0.48, 0.95}, {0.52, 0.95}, {0.5, 1.05}, {0.48, 0.95}},
+  }});
+  ASSERT_FALSE(GeometryLod::hasCrossings(source));
+
+  auto simplified = GeometryLod::simplify(source, 0.2);
+  EXPECT_FALSE(GeometryLod::hasCrossings(simplified));
+  ASSERT_EQ(simplified[0].size(), 2);
+  bool keptBump = false;
+  for (const auto& point : simplified[0][0]) {
+    keptBump = keptBump || point == Coordinate(0.5, 1.1);
+  }
+  EXPECT_TRUE(keptBump);
+}
+
+TEST(GeometryLodTest, DetectsSelfIntersection) {
+  MultiPolygon bowtie = {{{{0.0, 0.0}, {1.0, 1.0}, {1.0, 0.0}, {0.0, 1.0}, {0.0, 0.0}}}};
+  MultiPolygon square = {{{{0.0, 0.0}, {1.0, 0.0}, {1.0, 1.0}, {0.0, 1.0}, {0.0, 0.0}}}};
+  EXPECT_TRUE(GeometryLod::hasCrossings(bowtie));
+  EXPECT_FALSE(GeometryLod::hasCrossings(square));
+}
+
+TEST(GeometryLodTest, HolesTouchingTheShellStillSimplify) {
+  // A wavy square whose hole meets it at a corner, a touch already in the source
+  LinearRing shell;
+  for (int i = 0; i < 400; ++i) {
+    double t = static_cast<double>(i % 100) / 100.0;
+    double wave = 0.0005 * std::sin(static_cast<double>(i));
+    int side = i / 100;
+    double x = side == 0 ? t : side == 1 ? 1.0 + wave : side == 2 ? 1.0 - t : wave;
+    double y = side == 0 ? wave : side == 1 ? t : side == 2 ? 1.0 + wave : 1.0 - t;
+    shell.emplace_back(i == 0 ? 0.0 : x, i == 0 ? 0.0 : y);
+  }
+  shell.push_back(shell.front());
+  FlatMultiPolygon source(MultiPolygon{{shell, {{0.0, 0.0}, {0.3, 0.1}, {0.1, 0.3}, {0.0, 0.0}}}});
+  ASSERT_TRUE(GeometryLod::hasCrossings(source));
+
+  GeometryLod lod(source);
+  const auto& national = lod.forZoom(GeometryLod::MIN_ZOOM);
+  EXPECT_LT(national.pointCount(), source.pointCount() / 10);
+  EXPECT_FALSE(GeometryLod::addsContacts(national, source));
+}
+
+TEST(GeometryLodTest, PartsAreNotSimplifiedIntoEachOther) {
+  // Straightening the first part's shallow notch would cover the tip of the second part
+  FlatMultiPolygon source(MultiPolygon{
+      {{{0.0, 0.0}, {1.0, 0.0}, {0.995, 0.5}, {1.0, 1.0}, {0.0, 1.0}, {0.0, 0.0}}},
+      {{{0.997, 0.5}, {1.5, 0.3}, {1.5, 0.7}, {0.997, 0.5}}},
+  });
+  ASSERT_FALSE(GeometryLod::hasCrossings(source));
+
+  auto simplified = GeometryLod::simplify(source, 0.011);
+  EXPECT_FALSE(GeometryLod::hasCrossings(simplified));
+  ASSERT_EQ(simplified.size(), 2);
+  EXPECT_EQ(simplified[0][0].size(), 6);
+}
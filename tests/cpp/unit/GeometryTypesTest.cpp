@@ -0,0 +1,75 @@
+// tests/cpp/unit/GeometryTypesTest.cpp
+#include "GeometryTypes.hpp"
+#include <gtest/gtest.h>
+#include <iterator>
+#include <vector>
+
+TEST(FlatMultiPolygonTest, MatchesNestedLayout) {
+  MultiPolygon nested = {
+      {{{0.0, 51.0}, {1.0, 51.0}, {1.0, 52.0}, {0.0, 51.0}}, {{0.2, 51.2}, {0.4, 51.2}}},
+      {{{2.0, 53.0}, {3.0, 53.0}, {2.0, 53.0}}},
+  };
+  FlatMultiPolygon flat(nested);
+
+  ASSERT_EQ(flat.size(), 2);
+  EXPECT_EQ(flat.ringCount(), 3);
+  EXPECT_EQ(flat.pointCount(), 9);
+  ASSERT_EQ(flat[0].size(), 2);
+  EXPECT_EQ(flat[0][0].size(), 4);
+  EXPECT_EQ(flat[0][1].size(), 2);
+  EXPECT_EQ(flat[1][0].size(), 3);
+  EXPECT_EQ(flat[0][0][2], Coordinate(1.0, 52.0));
+  EXPECT_EQ(flat[1][0][1], Coordinate(3.0, 53.0));
+  EXPECT_EQ(flat[1][0].data()[2], 3.0);
+}
+
+TEST(FlatMultiPolygonTest, IteratesLikeNestedVectors) {
+  MultiPolygon nested = {{{{0.0, 0.0}, {1.0, 0.0}, {1.0, 1.0}}}, {{{5.0, 5.0}, {6.0, 5.0}}}};
+  FlatMultiPolygon flat(nested);
+
+  MultiPolygon rebuilt;
+  for (auto polygon : flat) {
+    MyPolygon& out = rebuilt.emplace_back();
+    for (auto ring : polygon) {
+      out.emplace_back(ring.begin(), ring.end());
+    }
+  }
+  EXPECT_EQ(rebuilt, nested);
+
+  // Iterators keep their own view, so they stay valid past the temporary they came from
+  auto it = flat[0][0].begin();
+  auto end = flat[0][0].end();
+  EXPECT_EQ(std::distance(it, end), 3);
+  EXPECT_EQ(it[2], Coordinate(1.0, 1.0));
+}
+
+TEST(FlatMultiPolygonTest, DropsEmptyRingsAndPolygons) {
+  FlatMultiPolygon flat;
+  flat.closeRing();
+  flat.closePolygon();
+  EXPECT_TRUE(flat.empty());
+
+  flat.addPoint(0.0, 0.0);
+  flat.closeRing();
+  flat.closeRing();
+  flat.closePolygon();
+  flat.closePolygon();
+  EXPECT_EQ(flat.size(), 1);
+  EXPECT_EQ(flat.ringCount(), 1);
+
+  EXPECT_EQ(FlatMultiPolygon(MultiPolygon{{{}}, {}}), FlatMultiPolygon());
+}
+
+TEST(FlatMultiPolygonTest, ReducedPrecisionModes) {
+  MultiPolygon nested = {{{{-1.2345678, 51.7654321}, {179.9999999, -89.9999999}}}};
+  FlatMultiPolygonF single(nested);
+  FixedMultiPolygon fixed(nested);
+
+  EXPECT_NEAR(single[0][0][0].first, -1.2345678, 1e-6);
+  EXPECT_NEAR(single[0][0][0].second, 51.7654321, 1e-5);
+  EXPECT_NEAR(fixed[0][0][0].first, -1.2345678, 1e-7);
+  EXPECT_NEAR(fixed[0][0][0].second, 51.7654321, 1e-7);
+  EXPECT_NEAR(fixed[0][0][1].first, 179.9999999, 1e-7);
+  EXPECT_NEAR(fixed[0][0][1].second, -89.9999999, 1e-7);
+  EXPECT_LT(fixed.memoryBytes(), FlatMultiPolygon(nested).memoryBytes());
+}
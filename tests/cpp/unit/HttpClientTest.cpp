@@ -1,5 +1,6 @@
 // tests/cpp/unit/HttpClientTest.cpp
 #include "HttpClient.hpp"
+#include <chrono>
 #include <gtest/gtest.h>
 #include <thread>
 
@@ -10,6 +11,25 @@ TEST(HttpClientTest, FetchValidUrl) {
   EXPECT_FALSE(result->empty()); // NOLINT(bugprone-unchecked-optional-access,-warnings-as-errors)
 }
 
+TEST(HttpClientTest, FetchedBodyIsPaddedForSimdjson) {
+  auto result = HttpClient::getInstance().fetchUrl("https://www.google.com/");
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_GE(result->capacity() - result->size(), simdjson::SIMDJSON_PADDING);
+}
+
+TEST(HttpClientTest, FetchRecordsTimingMetrics) {
+  auto before = HttpMetrics::getInstance().summary(UrlClass::OTHER);
+  auto result = HttpClient::getInstance().fetchUrl("https://www.example.com/");
+  auto after = HttpMetrics::getInstance().summary(UrlClass::OTHER);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(after.requests, before.requests + 1);
+  EXPECT_GE(after.bytesDown, before.bytesDown + result->size());
+  EXPECT_GT(after.phases[static_cast<size_t>(TimingPhase::TOTAL)].count,
+            before.phases[static_cast<size_t>(TimingPhase::TOTAL)].count);
+}
+
 TEST(HttpClientTest, Fetch404ReturnsNullopt) {
   auto result = HttpClient::getInstance().fetchUrl("https://www.google.com/nonexistent404page");
 
@@ -170,4 +190,174 @@ TEST(HttpClientTest, FetchUrlsResultOrderPreserved) {
   EXPECT_TRUE(results[0].has_value());  // google.com
   EXPECT_TRUE(results[1].has_value());  // example.com
   EXPECT_FALSE(results[2].has_value()); // 404
-}
\ No newline at end of file
+}
+
+TEST(HttpClientTest, FetchUrlsStreamingCallsHandlerOncePerUrl) {
+  std::vector<std::string> urls = {"https://www.google.com/", "https://www.example.com/",
+                                   "https://www.google.com/nonexistent404page"};
+  std::vector<int> calls(urls.size(), 0);
+  std::vector<bool> succeeded(urls.size(), false);
+
+  FetchOptions options;
+  options.maxInFlight = 2;
+  options.maxPerHost = 1;
+  HttpClient::getInstance().fetchUrls(
+      urls,
+      [&](size_t index, std::optional<std::string> body) {
+        calls[index]++;
+        succeeded[index] = body.has_value();
+      },
+      options);
+
+  EXPECT_EQ(calls, std::vector<int>(urls.size(), 1));
+  EXPECT_TRUE(succeeded[0]);
+  EXPECT_TRUE(succeeded[1]);
+  EXPECT_FALSE(succeeded[2]);
+}
+
+TEST(HttpClientTest, FetchUrlsHttp2MultiplexSharesConnection) {
+  HttpClient client(2);
+  std::vector<std::string> urls(20, "https://www.google.com/");
+
+  FetchOptions options;
+  options.http2Multiplex = true;
+  options.maxConcurrentStreams = 10;
+  std::vector<int> calls(urls.size(), 0);
+  client.fetchUrls(
+      urls,
+      [&](size_t index, std::optional<std::string> body) {
+        calls[index]++;
+        EXPECT_TRUE(body.has_value());
+      },
+      options);
+
+  // The window is not capped by the two pooled handles, and streams reuse the connection
+  EXPECT_EQ(calls, std::vector<int>(urls.size(), 1));
+  EXPECT_GE(client.getConnectionsOpened(), 1U);
+  EXPECT_LT(client.getConnectionsOpened(), urls.size());
+
+  // Pooled handles go back to plain fetches afterwards
+  EXPECT_TRUE(client.fetchUrl("https://www.google.com/").has_value());
+}
+
+TEST(HttpClientTest, BackoffDelayGrowsAndIsCapped) {
+  RetryPolicy policy;
+  policy.baseDelay = std::chrono::milliseconds(100);
+  policy.maxDelay = std::chrono::milliseconds(1000);
+
+  // Jitter picks a point in the upper half of the window
+  EXPECT_EQ(HttpClient::backoffDelay(policy, 1, 0.0).count(), 50);
+  EXPECT_EQ(HttpClient::backoffDelay(policy, 1, 0.999).count(), 99);
+  EXPECT_EQ(HttpClient::backoffDelay(policy, 3, 0.0).count(), 200);
+  EXPECT_EQ(HttpClient::backoffDelay(policy, 10, 0.0).count(), 500);
+  EXPECT_LE(HttpClient::backoffDelay(policy, 10, 0.999).count(), 1000);
+}
+
+TEST(HttpClientTest, FetchUrlsRetriesTransientFailures) {
+  HttpClient client(2);
+  // Nothing listens on port 1, so every attempt is refused
+  std::vector<std::string> urls = {"http://127.0.0.1:1/", "invalid://url"};
+  std::vector<int> calls(urls.size(), 0);
+
+  FetchOptions options;
+  options.retry.maxAttempts = 3;
+  options.retry.baseDelay = std::chrono::milliseconds(40);
+  auto start = std::chrono::steady_clock::now();
+  client.fetchUrls(
+      urls,
+      [&](size_t index, std::optional<std::string> body) {
+        calls[index]++;
+        EXPECT_FALSE(body.has_value());
+      },
+      options);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(calls, std::vector<int>(urls.size(), 1));
+  // Two backoffs of at least 20 ms and 40 ms, the bad scheme is not retried at all
+  EXPECT_GE(elapsed, std::chrono::milliseconds(60));
+  EXPECT_EQ(client.getConnectionsOpened(), 0U);
+}
+
+TEST(HttpClientTest, FetchUrlsWithHedgingCallsHandlerOncePerUrl) {
+  HttpClient client(4);
+  std::vector<std::string> urls(30, "https://www.google.com/");
+  std::vector<int> calls(urls.size(), 0);
+
+  FetchOptions options;
+  options.hedge.percentile = 0.5;
+  options.hedge.minDelay = std::chrono::milliseconds(1);
+  // Run twice so the second batch has latency history to hedge against
+  for (int batch = 0; batch < 2; ++batch) {
+    client.fetchUrls(
+        urls,
+        [&](size_t index, std::optional<std::string> body) {
+          calls[index]++;
+          EXPECT_TRUE(body.has_value());
+        },
+        options);
+  }
+
+  EXPECT_EQ(calls, std::vector<int>(urls.size(), 2));
+}
+
+TEST(HttpClientTest, FetchUrlIfModifiedRevalidates) {
+  auto first = HttpClient::getInstance().fetchUrlIfModified("https://www.example.com/");
+
+  ASSERT_EQ(first.status, FetchStatus::OK);
+  EXPECT_TRUE(first.body.has_value());
+
+  // Second request sends the stored validators, so an unchanged page comes back as 304
+  auto second = HttpClient::getInstance().fetchUrlIfModified("https://www.example.com/");
+
+  EXPECT_NE(second.status, FetchStatus::FAILED);
+  if (second.status == FetchStatus::NOT_MODIFIED) {
+    EXPECT_FALSE(second.body.has_value());
+  }
+}
+
+TEST(HttpClientTest, FetchUrlIfModifiedFailure) {
+  auto result = HttpClient::getInstance().fetchUrlIfModified("invalid://url");
+
+  EXPECT_EQ(result.status, FetchStatus::FAILED);
+  EXPECT_FALSE(result.body.has_value());
+}
+
+TEST(HttpClientTest, FetchUrlAsyncReturnsFuture) {
+  auto future = HttpClient::getInstance().fetchUrlAsync("https://www.google.com/");
+
+  auto result = future.get();
+  ASSERT_TRUE(result.has_value());
+  EXPECT_FALSE(result->empty()); // NOLINT(bugprone-unchecked-optional-access,-warnings-as-errors)
+}
+
+TEST(HttpClientTest, FetchUrlAsyncManyConcurrent) {
+  std::vector<std::future<std::optional<std::string>>> futures;
+  futures.reserve(20);
+  for (int i = 0; i < 20; ++i) {
+    futures.push_back(HttpClient::getInstance().fetchUrlAsync("https://www.example.com/"));
+  }
+  auto failed = HttpClient::getInstance().fetchUrlAsync("invalid://url");
+
+  for (auto& future : futures) {
+    EXPECT_TRUE(future.get().has_value());
+  }
+  EXPECT_FALSE(failed.get().has_value());
+}
+
+TEST(HttpClientTest, FetchAsyncCallbackReceivesResult) {
+  std::promise<FetchStatus> status;
+  HttpClient::getInstance().fetchAsync(
+      "https://www.google.com/nonexistent404page", false,
+      [&status](FetchResult result) { status.set_value(result.status); });
+
+  EXPECT_EQ(status.get_future().get(), FetchStatus::FAILED);
+}
+
+TEST(HttpClientTest, FetchUrlIfModifiedAsyncRevalidates) {
+  // Earlier tests may already have stored validators for this URL
+  auto first = HttpClient::getInstance().fetchUrlIfModifiedAsync("https://www.example.com/").get();
+  ASSERT_NE(first.status, FetchStatus::FAILED);
+
+  auto second = HttpClient::getInstance().fetchUrlIfModifiedAsync("https://www.example.com/").get();
+  EXPECT_NE(second.status, FetchStatus::FAILED);
+}
@@ -0,0 +1,118 @@
+// tests/cpp/unit/HttpMetricsTest.cpp
+#include "HttpMetrics.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+TEST(HttpMetricsTest, ClassifiesEnvironmentAgencyUrls) {
+  const std::string base = "https://environment.data.gov.uk/flood-monitoring";
+  EXPECT_EQ(HttpMetrics::classify(base + "/id/stations?status=Active"), UrlClass::STATIONS);
+  EXPECT_EQ(HttpMetrics::classify(base + "/id/stations/E1234/measures"), UrlClass::MEASURES);
+  EXPECT_EQ(HttpMetrics::classify(base + "/id/floods"), UrlClass::FLOODS);
+  EXPECT_EQ(HttpMetrics::classify(base + "/id/floodAreas/065WAF423/polygon"), UrlClass::POLYGON);
+  EXPECT_EQ(HttpMetrics::classify("https://www.example.com/"), UrlClass::OTHER);
+}
+
+TEST(HttpMetricsTest, HistogramPercentilesAreBucketUpperBounds) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(0.5), 0U);
+
+  for (int i = 0; i < 90; ++i) {
+    histogram.record(1000); // Falls in [1024/2, 1024)
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram.record(100000);
+  }
+
+  EXPECT_EQ(histogram.count(), 100U);
+  EXPECT_EQ(histogram.percentile(0.5), 1024U);
+  EXPECT_EQ(histogram.percentile(0.9), 1024U);
+  EXPECT_EQ(histogram.percentile(0.99), 131072U);
+  EXPECT_EQ(histogram.mean(), 10900U);
+}
+
+TEST(HttpMetricsTest, RecordsPhasesPerClass) {
+  HttpMetrics metrics;
+  RequestTiming timing;
+  timing.phases.fill(2000);
+  timing.bytesDown = 500;
+  timing.bytesUp = 100;
+  metrics.record("https://environment.data.gov.uk/flood-monitoring/id/floods", timing);
+
+  timing.failed = true;
+  timing.tls = true;
+  metrics.record("https://environment.data.gov.uk/flood-monitoring/id/floods", timing);
+
+  auto floods = metrics.summary(UrlClass::FLOODS);
+  EXPECT_EQ(floods.requests, 2U);
+  EXPECT_EQ(floods.failures, 1U);
+  EXPECT_EQ(floods.bytesDown, 1000U);
+  EXPECT_EQ(floods.bytesUp, 200U);
+  EXPECT_EQ(floods.phases[static_cast<size_t>(TimingPhase::TOTAL)].count, 2U);
+  // Only the request that made a TLS handshake counts towards that phase
+  EXPECT_EQ(floods.phases[static_cast<size_t>(TimingPhase::TLS)].count, 1U);
+
+  EXPECT_EQ(metrics.summary(UrlClass::POLYGON).requests, 0U);
+}
+
+TEST(HttpMetricsTest, ConcurrentRecordingLosesNothing) {
+  HttpMetrics metrics;
+  RequestTiming timing;
+  timing.phases.fill(50);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&metrics, &timing]() {
+      for (int i = 0; i < 1000; ++i) {
+        metrics.record("https://www.example.com/", timing);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto other = metrics.summary(UrlClass::OTHER);
+  EXPECT_EQ(other.requests, 8000U);
+  EXPECT_EQ(other.phases[static_cast<size_t>(TimingPhase::DNS)].count, 8000U);
+}
+
+TEST(HttpMetricsTest, DumpListsClassesWithTraffic) {
+  HttpMetrics metrics;
+  RequestTiming timing;
+  timing.phases.fill(1500);
+  metrics.record("https://environment.data.gov.uk/flood-monitoring/id/floodAreas/X/polygon",
+                 timing);
+
+  std::ostringstream out;
+  metrics.dump(out);
+  EXPECT_NE(out.str().find("polygon: 1 requests"), std::string::npos);
+  EXPECT_NE(out.str().find("first byte"), std::string::npos);
+  EXPECT_EQ(out.str().find("stations"), std::string::npos);
+}
+
+TEST(HttpMetricsTest, DumpLeavesStreamFormattingAlone) {
+  HttpMetrics metrics;
+  RequestTiming timing;
+  timing.phases.fill(1500);
+  metrics.record("https://environment.data.gov.uk/flood-monitoring/id/stations", timing);
+
+  std::ostringstream out;
+  metrics.dump(out);
+  out.str("");
+  out << 2.5 << ' ' << 1.0 / 3.0;
+  EXPECT_EQ(out.str(), "2.5 0.333333");
+}
+
+TEST(HttpMetricsTest, PeriodicDumpWritesUntilStopped) {
+  HttpMetrics metrics;
+  metrics.record("https://www.example.com/", RequestTiming{});
+
+  std::ostringstream out;
+  metrics.startPeriodicDump(std::chrono::seconds(1), out);
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  metrics.stopPeriodicDump();
+
+  EXPECT_NE(out.str().find("other: 1 requests"), std::string::npos);
+}
@@ -1,9 +1,12 @@
 // tests/unit/MonitoringDataTest.cpp
 #include "MonitoringData.hpp"
 #include "MockHttpClient.hpp"
+#include "PolygonCache.hpp"
 #include <HttpClient.hpp>
+#include <filesystem>
 #include <gtest/gtest.h>
 #include <simdjson.h>
+#include <sstream>
 
 TEST(ParseWarningsTest, ParsesValidItemsArray) {
   std::string jsonStr = R"({
@@ -147,10 +150,120 @@ TEST(ParseStationsTest, CatchesInvalidJsonAndContinues) {
   EXPECT_EQ(data.getStations().size(), 2);
 }
 
+TEST(ParseStationsTest, ReportsBadItemsByKindAndIndex) {
+  std::string jsonStr = R"({
+    "items": [
+      {"RLOIid": "valid station"},
+      {"RLOIid": 5},
+      null,
+      {"RLOIid": ["a", 1], "status": ["x", "statusActive"]},
+      {"RLOIid": "another valid station"}
+    ]
+  })";
+
+  simdjson::dom::parser parser;
+  simdjson::dom::element apiResponse;
+  ASSERT_EQ(parser.parse(jsonStr).get(apiResponse), 0U);
+
+  MonitoringData dom;
+  ParseReport domReport = dom.parseStations(apiResponse);
+  MonitoringData onDemand;
+  ParseReport onDemandReport = onDemand.parseStationsOnDemand(jsonStr);
+
+  for (const ParseReport& report : {domReport, onDemandReport}) {
+    EXPECT_TRUE(report.ok());
+    EXPECT_FALSE(report.clean());
+    EXPECT_EQ(report.items, 5);
+    EXPECT_EQ(report.decoded, 2);
+    EXPECT_EQ(report.failed(), 2);
+    EXPECT_EQ(report.errors[static_cast<size_t>(ParseError::WRONG_TYPE)], 1);
+    EXPECT_EQ(report.errors[static_cast<size_t>(ParseError::BAD_ELEMENT)], 1);
+    EXPECT_EQ(report.samples, (std::vector<size_t>{1, 3}));
+  }
+}
+
+TEST(ParseStationsTest, KeepsOrderAcrossParallelChunks) {
+  // Enough items for several chunks, with a bad entry and a null among them
+  std::string jsonStr = R"({"items": [)";
+  for (int i = 0; i < 2000; ++i) {
+    if (i == 777) {
+      jsonStr += R"({"RLOIid": "bad", "lat": "51.0"},)";
+    }
+    if (i == 1500) {
+      jsonStr += "null,";
+    }
+    jsonStr += R"({"RLOIid": ")" + std::to_string(i) + R"("})";
+    jsonStr += i + 1 < 2000 ? "," : "]}";
+  }
+
+  simdjson::dom::parser parser;
+  simdjson::dom::element apiResponse;
+  ASSERT_EQ(parser.parse(jsonStr).get(apiResponse), 0U);
+
+  MonitoringData dom;
+  dom.parseStations(apiResponse);
+  MonitoringData onDemand;
+  ASSERT_TRUE(onDemand.parseStationsOnDemand(jsonStr).ok());
+
+  for (const MonitoringData* data : {&dom, &onDemand}) {
+    ASSERT_EQ(data->getStations().size(), 2000);
+    for (size_t i = 0; i < 2000; ++i) {
+      ASSERT_EQ(data->getStations()[i].getRLOIid(), std::to_string(i));
+    }
+  }
+}
+
+TEST(ParseStationsOnDemandTest, MatchesDomPath) {
+  std::string jsonStr = R"({
+    "meta": {"version": "0.9"},
+    "items": [
+      {"RLOIid": "station1", "label": "Test Station 1", "lat": 51.5, "long": -0.1},
+      {"RLOIid": "wrong type station", "lat": "48.0", "long": -0.1},
+      null,
+      {"RLOIid": ["a", "b"], "label": ["x", "y"], "status": ["s/statusClosed", "s/statusActive"]},
+      {"RLOIid": "station3", "lat": 53.5, "long": -2.5, "town": "Reading"}
+    ]
+  })";
+
+  simdjson::dom::parser parser;
+  simdjson::dom::element apiResponse;
+  ASSERT_EQ(parser.parse(jsonStr).get(apiResponse), 0U);
+  MonitoringData dom;
+  dom.parseStations(apiResponse);
+
+  MonitoringData onDemand;
+  EXPECT_TRUE(onDemand.parseStationsOnDemand(jsonStr).ok());
+
+  ASSERT_EQ(onDemand.getStations().size(), 3);
+  ASSERT_EQ(onDemand.getStations().size(), dom.getStations().size());
+  for (size_t i = 0; i < dom.getStations().size(); ++i) {
+    const Station& expected = dom.getStations()[i];
+    const Station& actual = onDemand.getStations()[i];
+    EXPECT_EQ(actual.getRLOIid(), expected.getRLOIid());
+    EXPECT_EQ(actual.getLabel(), expected.getLabel());
+    EXPECT_EQ(actual.getLat(), expected.getLat());
+    EXPECT_EQ(actual.getLon(), expected.getLon());
+    EXPECT_EQ(actual.getTown(), expected.getTown());
+  }
+}
+
+TEST(ParseStationsOnDemandTest, HandlesMissingItemsAndBadDocuments) {
+  MonitoringData data;
+  EXPECT_TRUE(data.parseStationsOnDemand("{}").ok());
+  EXPECT_TRUE(data.getStations().empty());
+
+  EXPECT_FALSE(data.parseStationsOnDemand(R"({"items": 5})").ok());
+  EXPECT_FALSE(data.parseStationsOnDemand("").ok());
+  EXPECT_TRUE(data.getStations().empty());
+}
+
 class MonitoringDataTest : public ::testing::Test {
   private:
     MockHttpClient mockClient;
+    MockHttpClient offlineClient;
     MonitoringData data;
+    std::filesystem::path cacheDir;
+    std::unique_ptr<PolygonCache> cache;
 
   protected:
     MonitoringData& getData() {
@@ -160,9 +273,60 @@ class MonitoringDataTest : public ::testing::Test {
       return mockClient;
     }
 
+    // Forget downloaded polygons and cut the network, leaving only the disk cache
+    void goOffline() {
+      for (auto& warning : data.warnings) {
+        warning.setFloodAreaPolygon(std::nullopt);
+      }
+      HttpClient::setInstance(&offlineClient);
+    }
+
+    // The same warnings parsed again by a refresh, before any polygons are fetched
+    MonitoringData refreshed() const {
+      MonitoringData refresh;
+      refresh.warnings = data.warnings;
+      for (auto& warning : refresh.warnings) {
+        warning.setFloodAreaPolygon(std::nullopt);
+      }
+      return refresh;
+    }
+
+    // Name the first warning's flood area a second time
+    void repeatFirstWarning() {
+      data.warnings.push_back(data.warnings.front());
+    }
+
+    // Replace the fixture warnings with count ones whose square polygon starts at x = index
+    void useManyWarnings(size_t count) {
+      simdjson::dom::parser parser;
+      data.warnings.clear();
+      for (size_t i = 0; i < count; ++i) {
+        std::string url = "http://test-polygon-many" + std::to_string(i) + ".com";
+        std::string json = R"({"floodAreaID": "many)" + std::to_string(i) +
+                           R"(", "severityLevel": 2, "floodArea": {"polygon": ")" + url + R"("}})";
+        simdjson::dom::element element;
+        ASSERT_EQ(parser.parse(json).get(element), 0U);
+        data.warnings.push_back(Warning::fromJson(element));
+
+        std::string x = std::to_string(i);
+        std::string x1 = std::to_string(i + 1);
+        std::string ring = "[[" + x + ", 0], [" + x1 + ", 0], [" + x1 + ", 1], [" + x + ", 1], [" +
+                           x + ", 0]]";
+        mockClient.addResponse(url, R"({"features": [{"geometry": {"type": "Polygon", )"
+                                    R"("coordinates": [)" + ring + "]}}]}");
+      }
+    }
+
     void SetUp() override {
       HttpClient::setInstance(&mockClient);
 
+      cacheDir = std::filesystem::temp_directory_path() /
+                 ("floodwatcher_md_" +
+                  std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+      std::filesystem::remove_all(cacheDir);
+      cache = std::make_unique<PolygonCache>(cacheDir);
+      PolygonCache::setInstance(cache.get());
+
       std::string warning1Str = R"({
         "floodAreaID": "test1",
         "description": "Test warning 1",
@@ -191,12 +355,12 @@ class MonitoringDataTest : public ::testing::Test {
       simdjson::dom::element testWarning1;
       simdjson::dom::element testWarning2;
 
+      // Each parse reuses the parser's document, so convert before parsing the next
       auto error1 = parser.parse(warning1Str).get(testWarning1);
       ASSERT_EQ(error1, 0U);
+      auto warning1 = Warning::fromJson(testWarning1);
       auto error2 = parser.parse(warning2Str).get(testWarning2);
       ASSERT_EQ(error2, 0U);
-
-      auto warning1 = Warning::fromJson(testWarning1);
       auto warning2 = Warning::fromJson(testWarning2);
 
       data.warnings = {warning1, warning2};
@@ -223,6 +387,9 @@ class MonitoringDataTest : public ::testing::Test {
 
     void TearDown() override {
       HttpClient::setInstance(nullptr);
+      PolygonCache::setInstance(nullptr);
+      cache.reset();
+      std::filesystem::remove_all(cacheDir);
     }
 };
 
@@ -235,16 +402,101 @@ TEST_F(MonitoringDataTest, FetchAllPolygonsAsync_CompletesSuccessfully) {
   ASSERT_EQ(warnings.size(), 2);
 
   // Verify first warning got its polygon
-  auto opt1 = warnings[0].getFloodAreaPolygon();
-  ASSERT_TRUE(opt1.has_value());
-  const auto& poly1 = opt1.value(); // NOLINT(bugprone-unchecked-optional-access)
+  const FlatMultiPolygon* opt1 = warnings[0].getFloodAreaPolygon();
+  ASSERT_NE(opt1, nullptr);
+  const auto& poly1 = *opt1;
   EXPECT_EQ(poly1.size(), 1);
   EXPECT_EQ(poly1[0].size(), 1);
   EXPECT_EQ(poly1[0][0].size(), 5);
 
   // Verify second warning got its polygon
-  auto opt2 = warnings[1].getFloodAreaPolygon();
-  ASSERT_TRUE(opt2.has_value());
-  const auto& poly2 = opt2.value(); // NOLINT(bugprone-unchecked-optional-access)
+  const FlatMultiPolygon* opt2 = warnings[1].getFloodAreaPolygon();
+  ASSERT_NE(opt2, nullptr);
+  const auto& poly2 = *opt2;
   EXPECT_EQ(poly2.size(), 1);
 }
+
+TEST_F(MonitoringDataTest, FetchAllPolygonsAsync_LimitsConnectionsPerHost) {
+  getData().fetchAllPolygonsAsync();
+
+  EXPECT_GT(getMockClient().getLastOptions().maxPerHost, 0);
+  EXPECT_GT(getMockClient().getLastOptions().retry.maxAttempts, 1);
+  EXPECT_GT(getMockClient().getLastOptions().hedge.percentile, 0.0);
+}
+
+TEST_F(MonitoringDataTest, FetchAllPolygonsAsync_WarmStartServedFromDiskCache) {
+  getData().fetchAllPolygonsAsync();
+  goOffline();
+
+  getData().fetchAllPolygonsAsync();
+
+  const auto& warnings = getData().getWarnings();
+  ASSERT_EQ(warnings.size(), 2);
+  ASSERT_NE(warnings[0].getFloodAreaPolygon(), nullptr);
+  ASSERT_NE(warnings[1].getFloodAreaPolygon(), nullptr);
+  EXPECT_EQ((*warnings[1].getFloodAreaPolygon())[0][0].size(), 5);
+}
+
+TEST_F(MonitoringDataTest, FetchAllPolygonsAsync_ReportsStageTimings) {
+  PolygonTimings first = getData().fetchAllPolygonsAsync();
+  EXPECT_EQ(first.polygons, 2);
+  EXPECT_EQ(first.cached, 0);
+  EXPECT_EQ(first.failed, 0);
+
+  goOffline();
+  PolygonTimings warm = getData().fetchAllPolygonsAsync();
+  EXPECT_EQ(warm.polygons, 2);
+  EXPECT_EQ(warm.cached, 2);
+  EXPECT_EQ(warm.download.count(), 0);
+
+  std::ostringstream out;
+  warm.log(out);
+  EXPECT_EQ(out.str().rfind("polygons: 2 (0 shared, 2 cached, 0 failed), download 0 ms", 0), 0);
+}
+
+TEST_F(MonitoringDataTest, FetchAllPolygonsAsync_ReusesGeometryLiveWarningsHold) {
+  getData().fetchAllPolygonsAsync();
+
+  MonitoringData refresh = refreshed();
+  PolygonTimings timings = refresh.fetchAllPolygonsAsync();
+  EXPECT_EQ(timings.polygons, 2);
+  EXPECT_EQ(timings.shared, 2);
+  EXPECT_EQ(timings.cached, 0);
+  for (size_t i = 0; i < 2; ++i) {
+    EXPECT_NE(refresh.getWarnings()[i].getFloodAreaPolygon(), nullptr);
+    EXPECT_EQ(refresh.getWarnings()[i].getFloodAreaPolygon(),
+              getData().getWarnings()[i].getFloodAreaPolygon());
+    EXPECT_EQ(refresh.getWarnings()[i].getPolygonLod(),
+              getData().getWarnings()[i].getPolygonLod());
+  }
+}
+
+TEST_F(MonitoringDataTest, FetchAllPolygonsAsync_SharesOneCopyPerArea) {
+  repeatFirstWarning();
+
+  PolygonTimings timings = getData().fetchAllPolygonsAsync();
+  EXPECT_EQ(timings.polygons, 3);
+  EXPECT_EQ(timings.shared, 1);
+  EXPECT_EQ(timings.failed, 0);
+
+  const auto& warnings = getData().getWarnings();
+  ASSERT_NE(warnings[0].getFloodAreaPolygon(), nullptr);
+  EXPECT_EQ(warnings[2].getFloodAreaPolygon(), warnings[0].getFloodAreaPolygon());
+  EXPECT_NE(warnings[1].getFloodAreaPolygon(), warnings[0].getFloodAreaPolygon());
+}
+
+TEST_F(MonitoringDataTest, FetchAllPolygonsAsync_DecodesEachPolygonIntoItsOwnWarning) {
+  constexpr size_t COUNT = 64;
+  useManyWarnings(COUNT);
+
+  PolygonTimings timings = getData().fetchAllPolygonsAsync();
+  EXPECT_EQ(timings.failed, 0);
+
+  const auto& warnings = getData().getWarnings();
+  ASSERT_EQ(warnings.size(), COUNT);
+  for (size_t i = 0; i < COUNT; ++i) {
+    const FlatMultiPolygon* polygon = warnings[i].getFloodAreaPolygon();
+    ASSERT_NE(polygon, nullptr) << i;
+    EXPECT_DOUBLE_EQ((*polygon)[0][0][0].first, static_cast<double>(i));
+  }
+}
@@ -0,0 +1,39 @@
+// tests/cpp/unit/ParseReportTest.cpp
+#include "ParseReport.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(ParseReportTest, CountsFailuresAndKeepsFirstSamples) {
+  ParseReport report;
+  report.items = 20;
+  report.decoded = 8;
+  for (size_t i = 0; i < 12; ++i) {
+    report.recordFailure(i + 5, i % 3 == 0 ? ParseError::BAD_ELEMENT : ParseError::WRONG_TYPE);
+  }
+
+  EXPECT_EQ(report.failed(), 12);
+  EXPECT_EQ(report.errors[static_cast<size_t>(ParseError::WRONG_TYPE)], 8);
+  EXPECT_EQ(report.errors[static_cast<size_t>(ParseError::BAD_ELEMENT)], 4);
+  ASSERT_EQ(report.samples.size(), ParseReport::MAX_SAMPLES);
+  EXPECT_EQ(report.samples.front(), 5);
+  EXPECT_TRUE(report.ok());
+  EXPECT_FALSE(report.clean());
+}
+
+TEST(ParseReportTest, LogsOneLine) {
+  ParseReport report;
+  report.items = 3;
+  report.decoded = 2;
+  report.recordFailure(1, ParseError::WRONG_TYPE);
+
+  std::ostringstream out;
+  report.log(out, "stations");
+  EXPECT_EQ(out.str(), "stations: decoded 2 of 3, 1 failed (wrong type: 1), first at [1]\n");
+
+  ParseReport broken;
+  broken.document = ParseError::MALFORMED;
+  std::ostringstream brokenOut;
+  broken.log(brokenOut, "stations");
+  EXPECT_EQ(brokenOut.str(), "stations: document malformed\n");
+  EXPECT_FALSE(broken.ok());
+}
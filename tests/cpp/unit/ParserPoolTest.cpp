@@ -0,0 +1,62 @@
+// tests/cpp/unit/ParserPoolTest.cpp
+#include "ParserPool.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(ParserPoolTest, ReusesReturnedParser) {
+  ParserPool pool;
+  simdjson::dom::parser* first = nullptr;
+  {
+    auto parser = pool.acquire();
+    first = &*parser;
+    simdjson::dom::element doc;
+    ASSERT_EQ(parser->parse(std::string(R"({"a": 1})")).get(doc), simdjson::SUCCESS);
+  }
+  EXPECT_EQ(pool.idle(), 1);
+
+  auto again = pool.acquire();
+  EXPECT_EQ(&*again, first);
+  EXPECT_EQ(pool.idle(), 0);
+}
+
+TEST(ParserPoolTest, ConcurrentLeasesGetDistinctParsers) {
+  ParserPool pool;
+  auto a = pool.acquire();
+  auto b = pool.acquire();
+  EXPECT_NE(&*a, &*b);
+}
+
+TEST(ParserPoolTest, DropsParsersThatGrewPastMaxCapacity) {
+  ParserPool pool(1024);
+  {
+    auto parser = pool.acquire();
+    std::string big = "[" + std::string(4096, ' ') + "1]";
+    simdjson::dom::element doc;
+    ASSERT_EQ(parser->parse(big).get(doc), simdjson::SUCCESS);
+  }
+  EXPECT_EQ(pool.idle(), 0);
+}
+
+TEST(ParserPoolTest, KeepsAtMostMaxIdle) {
+  ParserPool pool(ParserPool::DEFAULT_MAX_CAPACITY, 2);
+  {
+    auto a = pool.acquire();
+    auto b = pool.acquire();
+    auto c = pool.acquire();
+  }
+  EXPECT_EQ(pool.idle(), 2);
+}
+
+TEST(ParserPoolTest, WorksForOnDemandParsers) {
+  OnDemandParserPool pool;
+  {
+    auto parser = pool.acquire();
+    simdjson::padded_string json = R"({"a": 1})"_padded;
+    simdjson::ondemand::document doc;
+    ASSERT_EQ(parser->iterate(json).get(doc), simdjson::SUCCESS);
+    int64_t a = 0;
+    ASSERT_EQ(doc["a"].get(a), simdjson::SUCCESS);
+    EXPECT_EQ(a, 1);
+  }
+  EXPECT_EQ(pool.idle(), 1);
+}
@@ -0,0 +1,195 @@
+// tests/unit/PolygonCacheTest.cpp
+#include "PolygonCache.hpp"
+#include "HttpClient.hpp"
+#include "MockHttpClient.hpp"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+class PolygonCacheTest : public ::testing::Test {
+  private:
+    std::filesystem::path dir;
+
+  protected:
+    const std::filesystem::path& getDir() const {
+      return dir;
+    }
+
+    void SetUp() override {
+      dir = std::filesystem::temp_directory_path() /
+            ("floodwatcher_pc_" +
+             std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+      std::filesystem::remove_all(dir);
+    }
+
+    void TearDown() override {
+      std::filesystem::remove_all(dir);
+    }
+};
+
+TEST_F(PolygonCacheTest, StoreThenLoadRoundTrips) {
+  PolygonCache cache(getDir());
+  cache.store("http://test-polygon.com/a", R"({"features": []})");
+
+  auto entry = cache.load("http://test-polygon.com/a");
+
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->body, R"({"features": []})"); // NOLINT(bugprone-unchecked-optional-access)
+  EXPECT_FALSE(entry->stale);                     // NOLINT(bugprone-unchecked-optional-access)
+}
+
+TEST_F(PolygonCacheTest, StoreKeepsValidators) {
+  PolygonCache cache(getDir());
+  cache.store("http://test-polygon.com/a", "body",
+              {R"("v1")", "Wed, 21 Oct 2015 07:28:00 GMT"});
+
+  auto entry = cache.load("http://test-polygon.com/a");
+
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->body, "body");               // NOLINT(bugprone-unchecked-optional-access)
+  EXPECT_EQ(entry->validators.etag, R"("v1")"); // NOLINT(bugprone-unchecked-optional-access)
+  EXPECT_EQ(entry->validators.lastModified,     // NOLINT(bugprone-unchecked-optional-access)
+            "Wed, 21 Oct 2015 07:28:00 GMT");
+}
+
+TEST_F(PolygonCacheTest, MissingEntryReturnsNullopt) {
+  PolygonCache cache(getDir());
+
+  EXPECT_FALSE(cache.load("http://test-polygon.com/missing").has_value());
+}
+
+TEST_F(PolygonCacheTest, CorruptEntryIsDiscarded) {
+  PolygonCache cache(getDir());
+  cache.store("http://test-polygon.com/a", "original body");
+
+  // Flip the body without updating the checksum
+  for (const auto& item : std::filesystem::directory_iterator(getDir())) {
+    std::fstream file(item.path(), std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(-1, std::ios::end);
+    file.put('X');
+  }
+
+  EXPECT_FALSE(cache.load("http://test-polygon.com/a").has_value());
+  EXPECT_TRUE(std::filesystem::is_empty(getDir()));
+}
+
+TEST_F(PolygonCacheTest, ExpiredEntryIsMarkedStale) {
+  PolygonCache cache(getDir(), PolygonCache::DEFAULT_MAX_BYTES, std::chrono::seconds(-1));
+  cache.store("http://test-polygon.com/a", "body");
+
+  auto entry = cache.load("http://test-polygon.com/a");
+
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_TRUE(entry->stale); // NOLINT(bugprone-unchecked-optional-access)
+}
+
+TEST_F(PolygonCacheTest, SizeLimitEvictsLeastRecentlyUsed) {
+  PolygonCache cache(getDir(), 450); // Room for two entries
+  std::string body(100, 'x');
+  cache.store("http://test-polygon.com/old", body);
+  cache.store("http://test-polygon.com/used", body);
+
+  // Age both entries, then read one of them so it counts as recently used
+  for (const auto& item : std::filesystem::directory_iterator(getDir())) {
+    std::filesystem::last_write_time(item.path(), std::filesystem::file_time_type::clock::now() -
+                                                      std::chrono::hours(1));
+  }
+  ASSERT_TRUE(cache.load("http://test-polygon.com/used").has_value());
+
+  cache.store("http://test-polygon.com/new", body);
+  cache.enforceSizeLimit();
+
+  EXPECT_FALSE(cache.load("http://test-polygon.com/old").has_value());
+  EXPECT_TRUE(cache.load("http://test-polygon.com/used").has_value());
+  EXPECT_TRUE(cache.load("http://test-polygon.com/new").has_value());
+}
+
+TEST_F(PolygonCacheTest, RevalidationKeepsEntriesWhenTheRefetchHasNoGeometry) {
+  const std::string good =
+      R"({"features": [{"geometry": {"type": "Polygon", "coordinates": []}}]})";
+  const std::string fresh =
+      R"({"features": [{"geometry": {"type": "Polygon", "coordinates": [[]]}}]})";
+  MockHttpClient client;
+  client.addResponse("http://test-polygon.com/fresh", fresh);
+  client.addResponse("http://test-polygon.com/html", "<html>Service unavailable</html>");
+  client.addResponse("http://test-polygon.com/cut", fresh.substr(0, fresh.size() / 2));
+  HttpClient::setInstance(&client);
+
+  {
+    PolygonCache cache(getDir());
+    cache.store("http://test-polygon.com/fresh", good);
+    cache.store("http://test-polygon.com/html", good);
+    cache.store("http://test-polygon.com/cut", good);
+    cache.revalidateAsync({{"http://test-polygon.com/fresh", {}},
+                           {"http://test-polygon.com/html", {}},
+                           {"http://test-polygon.com/cut", {}}});
+  } // Waits for the revalidation
+
+  PolygonCache cache(getDir());
+  auto bodyOf = [&cache](const std::string& url) {
+    auto entry = cache.load(url);
+    return entry ? entry->body : std::string();
+  };
+  EXPECT_EQ(bodyOf("http://test-polygon.com/fresh"), fresh);
+  EXPECT_EQ(bodyOf("http://test-polygon.com/html"), good);
+  EXPECT_EQ(bodyOf("http://test-polygon.com/cut"), good);
+  HttpClient::setInstance(nullptr);
+}
+
+TEST_F(PolygonCacheTest, RevalidationOnlyRenewsUnchangedEntries) {
+  namespace fs = std::filesystem;
+  const std::string good =
+      R"({"features": [{"geometry": {"type": "Polygon", "coordinates": []}}]})";
+  const std::string fresh =
+      R"({"features": [{"geometry": {"type": "Polygon", "coordinates": [[]]}}]})";
+  const std::string same = "http://test-polygon.com/same";
+  const std::string moved = "http://test-polygon.com/moved";
+  MockHttpClient client;
+  client.addResponse(same, fresh);
+  client.setNotModified(same);
+  client.addResponse(moved, fresh);
+  client.setValidators(moved, {R"("v2")", ""});
+  HttpClient::setInstance(&client);
+
+  {
+    PolygonCache cache(getDir(), PolygonCache::DEFAULT_MAX_BYTES, std::chrono::hours(1));
+    cache.store(same, good, {R"("v1")", ""});
+    cache.store(moved, good, {R"("v1")", ""});
+
+    // Backdate both entries past maxAge
+    for (const auto& item : fs::directory_iterator(getDir())) {
+      std::fstream file(item.path(), std::ios::in | std::ios::out | std::ios::binary);
+      file.seekp(6); // After "FWPC2 "
+      file << std::string(20, '0');
+    }
+    auto before = cache.load(same);
+    ASSERT_TRUE(before.has_value());
+    EXPECT_TRUE(before->stale); // NOLINT(bugprone-unchecked-optional-access)
+
+    for (const auto& item : fs::directory_iterator(getDir())) {
+      fs::last_write_time(item.path(), fs::file_time_type::clock::now() - std::chrono::hours(2));
+    }
+    cache.revalidateAsync({{same, {R"("v1")", ""}}, {moved, {R"("v1")", ""}}});
+  } // Waits for the revalidation
+
+  // Both count as just used, one renewed in place and one rewritten
+  for (const auto& item : fs::directory_iterator(getDir())) {
+    EXPECT_GT(fs::last_write_time(item.path()),
+              fs::file_time_type::clock::now() - std::chrono::hours(1));
+  }
+  EXPECT_EQ(client.getSentValidators(same).etag, R"("v1")");
+
+  PolygonCache cache(getDir(), PolygonCache::DEFAULT_MAX_BYTES, std::chrono::hours(1));
+  auto unchanged = cache.load(same);
+  ASSERT_TRUE(unchanged.has_value());
+  EXPECT_EQ(unchanged->body, good);                 // NOLINT(bugprone-unchecked-optional-access)
+  EXPECT_FALSE(unchanged->stale);                   // NOLINT(bugprone-unchecked-optional-access)
+  EXPECT_EQ(unchanged->validators.etag, R"("v1")"); // NOLINT(bugprone-unchecked-optional-access)
+
+  auto changed = cache.load(moved);
+  ASSERT_TRUE(changed.has_value());
+  EXPECT_EQ(changed->body, fresh);                // NOLINT(bugprone-unchecked-optional-access)
+  EXPECT_FALSE(changed->stale);                   // NOLINT(bugprone-unchecked-optional-access)
+  EXPECT_EQ(changed->validators.etag, R"("v2")"); // NOLINT(bugprone-unchecked-optional-access)
+  HttpClient::setInstance(nullptr);
+}
@@ -0,0 +1,61 @@
+// tests/cpp/unit/PolygonStoreTest.cpp
+#include "PolygonStore.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+namespace {
+
+SharedGeometry square(double x, bool withLod) {
+  auto polygon = std::make_shared<const FlatMultiPolygon>(
+      MultiPolygon{{{{x, 0}, {x + 1, 0}, {x + 1, 1}, {x, 1}, {x, 0}}}});
+  std::shared_ptr<const GeometryLod> lod;
+  if (withLod) {
+    lod = std::make_shared<const GeometryLod>(*polygon);
+  }
+  return {polygon, lod};
+}
+
+} // namespace
+
+TEST(PolygonStoreTest, FindsGeometryWhileAWarningHoldsIt) {
+  PolygonStore store;
+  EXPECT_EQ(store.find("a", "http://a").polygon, nullptr);
+
+  SharedGeometry held = store.insert("a", "http://a", square(0, true));
+  SharedGeometry found = store.find("a", "http://a");
+  EXPECT_EQ(found.polygon, held.polygon);
+  EXPECT_EQ(found.lod, held.lod);
+  // Both parts of the key must match
+  EXPECT_EQ(store.find("a", "http://b").polygon, nullptr);
+  EXPECT_EQ(store.find("b", "http://a").polygon, nullptr);
+
+  held = {};
+  found = {};
+  EXPECT_EQ(store.find("a", "http://a").polygon, nullptr);
+}
+
+TEST(PolygonStoreTest, KeepsTheFirstLiveCopy) {
+  PolygonStore store;
+  SharedGeometry first = store.insert("a", "http://a", square(0, true));
+  SharedGeometry second = store.insert("a", "http://a", square(5, true));
+  EXPECT_EQ(second.polygon, first.polygon);
+
+  // A copy without levels of detail gives way to one that has them
+  PolygonStore other;
+  SharedGeometry bare = other.insert("a", "http://a", square(0, false));
+  SharedGeometry built = other.insert("a", "http://a", square(0, true));
+  EXPECT_NE(built.polygon, bare.polygon);
+  EXPECT_NE(other.find("a", "http://a").lod, nullptr);
+}
+
+TEST(PolygonStoreTest, SweepsExpiredEntries) {
+  PolygonStore store;
+  SharedGeometry kept = store.insert("kept", "http://kept", square(0, false));
+  for (int i = 0; i < 1000; ++i) {
+    std::string id = std::to_string(i);
+    store.insert(id, "http://" + id, square(i, false));
+  }
+  EXPECT_LT(store.size(), 1000);
+  EXPECT_EQ(store.find("kept", "http://kept").polygon, kept.polygon);
+}
@@ -0,0 +1,98 @@
+// tests/cpp/unit/PolygonTriangulatorTest.cpp
+#include "PolygonTriangulator.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+double ringArea(const LinearRing& ring) {
+  double area = 0.0;
+  for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+    area += (ring[j].first * ring[i].second) - (ring[i].first * ring[j].second);
+  }
+  return std::abs(area) / 2.0;
+}
+
+LinearRing square(double x, double y, double size) {
+  return {{x, y}, {x + size, y}, {x + size, y + size}, {x, y + size}, {x, y}};
+}
+
+// Every triangle turns counter-clockwise and together they cover exactly the rings' area
+void expectCovers(const MyPolygon& rings, size_t expectedTriangles) {
+  FlatMultiPolygon flat(MultiPolygon{rings});
+  auto polygon = flat[0];
+  auto triangles = PolygonTriangulator::triangulate(polygon);
+  ASSERT_EQ(triangles.size(), 3 * expectedTriangles);
+
+  std::vector<Coordinate> points;
+  for (auto ring : polygon) {
+    for (const auto& point : ring) {
+      points.push_back(point);
+    }
+  }
+  double covered = 0.0;
+  for (size_t t = 0; t < triangles.size(); t += 3) {
+    auto [ax, ay] = points.at(triangles[t]);
+    auto [bx, by] = points.at(triangles[t + 1]);
+    auto [cx, cy] = points.at(triangles[t + 2]);
+    double twiceArea = ((bx - ax) * (cy - ay)) - ((by - ay) * (cx - ax));
+    EXPECT_GT(twiceArea, 0.0) << "triangle " << t / 3;
+    covered += twiceArea / 2.0;
+  }
+
+  double expected = ringArea(rings[0]);
+  for (size_t hole = 1; hole < rings.size(); ++hole) {
+    expected -= ringArea(rings[hole]);
+  }
+  EXPECT_NEAR(covered, expected, expected * 1e-9);
+}
+
+} // namespace
+
+TEST(PolygonTriangulatorTest, TriangulatesConvexAndConcaveRings) {
+  expectCovers({square(0, 0, 1)}, 2);
+  // A comb, every tooth a reflex notch
+  expectCovers({{{0, 0}, {5, 0}, {5, 2}, {4, 2}, {4, 1}, {3, 1}, {3, 2}, {2, 2}, {2, 1}, {1, 1},
+                 {1, 2}, {0, 2}, {0, 0}}},
+               10);
+}
+
+TEST(PolygonTriangulatorTest, AcceptsEitherWinding) {
+  LinearRing clockwise = {{0, 0}, {0, 1}, {2, 1}, {1, 0.5}, {2, 0}, {0, 0}};
+  expectCovers({clockwise}, 3);
+}
+
+TEST(PolygonTriangulatorTest, BridgesHoles) {
+  expectCovers({square(0, 0, 10), square(2, 2, 2)}, 8);
+  // Holes overlapping in height, so the later bridges pass close by earlier holes
+  expectCovers({square(0, 0, 10), square(1, 1.3, 2), square(4, 2.1, 2), square(7, 3.7, 2)}, 20);
+  // Bridges lined up with other holes' corners leave flat corners that are dropped
+  expectCovers({square(0, 0, 10), square(1, 1, 2), square(4, 1, 2), square(7, 1, 2)}, 16);
+}
+
+TEST(PolygonTriangulatorTest, SkipsDegenerateRings) {
+  FlatMultiPolygon line(MultiPolygon{{{{0.0, 0.0}, {1.0, 1.0}, {0.0, 0.0}}}});
+  EXPECT_TRUE(PolygonTriangulator::triangulate(line[0]).empty());
+  expectCovers({{{0, 0}, {1, 0}, {2, 0}, {2, 1}, {2, 1}, {0, 1}, {0, 0}}}, 2);
+}
+
+TEST(PolygonTriangulatorTest, TriangulatesLargeRandomStars) {
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<double> radius(0.5, 1.0);
+  LinearRing star;
+  for (int i = 0; i < 5000; ++i) {
+    double angle = 2.0 * M_PI * i / 5000.0;
+    double r = radius(rng);
+    star.emplace_back(r * std::cos(angle), r * std::sin(angle));
+  }
+  star.push_back(star.front());
+  expectCovers({star, square(-0.2, -0.2, 0.1), square(0.1, 0.1, 0.1)}, 5000 + 8 + 4 - 2);
+}
+
+TEST(PolygonTriangulatorTest, ContainsRespectsHoles) {
+  FlatMultiPolygon framed(MultiPolygon{{square(0, 0, 10), square(4, 4, 2)}});
+  EXPECT_TRUE(PolygonTriangulator::contains(framed[0], 1, 1));
+  EXPECT_FALSE(PolygonTriangulator::contains(framed[0], 5, 5));
+  EXPECT_FALSE(PolygonTriangulator::contains(framed[0], 11, 5));
+}
@@ -0,0 +1,167 @@
+// tests/cpp/unit/ReplayHttpClientTest.cpp
+#include "MockHttpClient.hpp"
+#include "RecordingHttpClient.hpp"
+#include "ReplayHttpClient.hpp"
+#include <chrono>
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <gtest/gtest.h>
+
+class ReplayHttpClientTest : public ::testing::Test {
+  private:
+    std::filesystem::path dir;
+
+  protected:
+    MockHttpClient mockClient;
+
+    const std::filesystem::path& getDir() const {
+      return dir;
+    }
+
+    void SetUp() override {
+      dir = std::filesystem::temp_directory_path() /
+            ("floodwatcher_replay_" +
+             std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+      std::filesystem::remove_all(dir);
+
+      mockClient.addResponse("http://test.com/stations", R"({"items": [1, 2, 3]})");
+      mockClient.addResponse("http://test.com/floods", R"({"items": []})");
+      mockClient.addResponse("http://test.com/polygon/1", "polygon one");
+      mockClient.addResponse("http://test.com/polygon/2", "polygon two");
+    }
+
+    void TearDown() override {
+      std::filesystem::remove_all(dir);
+    }
+
+    // Record a small session covering every entry point
+    void recordSession() {
+      RecordingHttpClient recorder(mockClient, getDir());
+      recorder.fetchUrl("http://test.com/stations");
+      recorder.fetchUrl("http://test.com/missing");
+      recorder.fetchUrlIfModified("http://test.com/floods");
+      recorder.fetchUrls({"http://test.com/polygon/1", "http://test.com/polygon/2"},
+                         [](size_t, std::optional<std::string>) {}, FetchOptions{});
+    }
+};
+
+TEST_F(ReplayHttpClientTest, ReplaysRecordedBodies) {
+  recordSession();
+  ReplayHttpClient replay(getDir());
+
+  EXPECT_EQ(replay.size(), 5U);
+  EXPECT_EQ(replay.fetchUrl("http://test.com/stations"), R"({"items": [1, 2, 3]})");
+  EXPECT_EQ(replay.fetchUrl("http://test.com/polygon/2"), "polygon two");
+  // Recorded failures and unrecorded URLs both fail
+  EXPECT_FALSE(replay.fetchUrl("http://test.com/missing").has_value());
+  EXPECT_FALSE(replay.fetchUrl("http://test.com/never-recorded").has_value());
+}
+
+TEST_F(ReplayHttpClientTest, ConditionalFetchServesTheBodyEveryTime) {
+  recordSession();
+  ReplayHttpClient replay(getDir());
+
+  // A refresh loop under replay runs its whole pipeline each time
+  for (int i = 0; i < 2; ++i) {
+    auto result = replay.fetchUrlIfModified("http://test.com/floods");
+    EXPECT_EQ(result.status, FetchStatus::OK);
+    EXPECT_EQ(result.body, R"({"items": []})");
+  }
+}
+
+TEST_F(ReplayHttpClientTest, ConditionalFetchCanReportUnchangedAfterFirstServe) {
+  recordSession();
+  ReplayProfile profile;
+  profile.notModifiedOnRepeat = true;
+  ReplayHttpClient replay(getDir(), profile);
+
+  auto first = replay.fetchUrlIfModified("http://test.com/floods");
+  EXPECT_EQ(first.status, FetchStatus::OK);
+  EXPECT_EQ(first.body, R"({"items": []})");
+
+  auto second = replay.fetchUrlIfModified("http://test.com/floods");
+  EXPECT_EQ(second.status, FetchStatus::NOT_MODIFIED);
+}
+
+TEST_F(ReplayHttpClientTest, BatchCallsHandlerOncePerUrl) {
+  recordSession();
+  ReplayHttpClient replay(getDir());
+
+  std::vector<std::string> urls = {"http://test.com/polygon/1", "http://test.com/missing",
+                                   "http://test.com/polygon/2"};
+  std::vector<int> calls(urls.size(), 0);
+  std::vector<std::optional<std::string>> bodies(urls.size());
+  replay.fetchUrls(
+      urls,
+      [&](size_t index, std::optional<std::string> body) {
+        calls[index]++;
+        bodies[index] = std::move(body);
+      },
+      FetchOptions{});
+
+  EXPECT_EQ(calls, std::vector<int>(urls.size(), 1));
+  EXPECT_EQ(bodies[0], "polygon one");
+  EXPECT_FALSE(bodies[1].has_value());
+  EXPECT_EQ(bodies[2], "polygon two");
+}
+
+TEST_F(ReplayHttpClientTest, ProfileSimulatesLatencyAndConcurrency) {
+  recordSession();
+  ReplayProfile profile;
+  profile.latency = std::chrono::milliseconds(50);
+  ReplayHttpClient replay(getDir(), profile);
+
+  std::vector<std::string> urls(4, "http://test.com/polygon/1");
+  FetchOptions options;
+  options.maxInFlight = 2;
+
+  auto start = std::chrono::steady_clock::now();
+  replay.fetchUrls(urls, [](size_t, std::optional<std::string>) {}, options);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  // Four transfers two at a time take two round trips
+  EXPECT_GE(elapsed, std::chrono::milliseconds(100));
+  EXPECT_LT(elapsed, std::chrono::milliseconds(190));
+}
+
+TEST_F(ReplayHttpClientTest, AsyncFetchesOverlap) {
+  recordSession();
+  ReplayProfile profile;
+  profile.latency = std::chrono::milliseconds(80);
+  ReplayHttpClient replay(getDir(), profile);
+
+  auto start = std::chrono::steady_clock::now();
+  auto stations = replay.fetchUrlAsync("http://test.com/stations");
+  auto floods = replay.fetchUrlIfModifiedAsync("http://test.com/floods");
+
+  EXPECT_TRUE(stations.get().has_value());
+  EXPECT_EQ(floods.get().status, FetchStatus::OK);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(150));
+}
+
+TEST_F(ReplayHttpClientTest, AsyncHandlersCanStartFurtherFetches) {
+  recordSession();
+  std::atomic<int> completed{0};
+  {
+    // Declared first, so it outlives the fetches replay joins on destruction
+    std::function<void(int)> chain;
+    ReplayHttpClient replay(getDir());
+    // Each completion chains the next fetch, the last few still run while replay is destroyed
+    chain = [&](int remaining) {
+      replay.fetchAsync("http://test.com/stations", false, [&, remaining](FetchResult result) {
+        EXPECT_EQ(result.status, FetchStatus::OK);
+        ++completed;
+        if (remaining > 1) {
+          chain(remaining - 1);
+        }
+      });
+    };
+    chain(20);
+    while (completed < 10) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  EXPECT_EQ(completed, 20);
+}
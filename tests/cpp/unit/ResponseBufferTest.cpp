@@ -0,0 +1,47 @@
+// tests/cpp/unit/ResponseBufferTest.cpp
+#include "ResponseBuffer.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(ResponseBufferTest, ReleaseKeepsSimdjsonPadding) {
+  ResponseBuffer buffer;
+  std::string chunk(1000, 'x');
+  for (int i = 0; i < 50; ++i) {
+    buffer.append(chunk.data(), chunk.size());
+    EXPECT_EQ(buffer.size(), chunk.size() * (i + 1));
+  }
+
+  std::string body = buffer.release();
+  EXPECT_EQ(body.size(), chunk.size() * 50);
+  EXPECT_GE(body.capacity() - body.size(), simdjson::SIMDJSON_PADDING);
+  EXPECT_EQ(buffer.size(), 0U);
+}
+
+TEST(ResponseBufferTest, EmptyBodyIsPadded) {
+  ResponseBuffer buffer;
+  std::string body = buffer.release();
+  EXPECT_TRUE(body.empty());
+  EXPECT_GE(body.capacity(), simdjson::SIMDJSON_PADDING);
+}
+
+TEST(ResponseBufferTest, ResetDiscardsPartialBody) {
+  ResponseBuffer buffer;
+  buffer.append("partial", 7);
+  buffer.reset(nullptr);
+  buffer.append("{}", 2);
+  EXPECT_EQ(buffer.release(), "{}");
+}
+
+TEST(ResponseBufferTest, ReleasedBodyParsesInPlace) {
+  ResponseBuffer buffer;
+  std::string json = R"({"items":[1,2,3]})";
+  buffer.append(json.data(), json.size());
+  const std::string body = buffer.release();
+
+  // Enough spare capacity means simdjson reads the string itself rather than a padded copy
+  ASSERT_GE(body.capacity() - body.size(), simdjson::SIMDJSON_PADDING);
+  simdjson::dom::parser parser;
+  simdjson::dom::element data;
+  ASSERT_EQ(parser.parse(body).get(data), simdjson::SUCCESS);
+  EXPECT_EQ(data["items"].get_array().size(), 3U);
+}
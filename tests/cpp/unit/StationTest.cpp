@@ -145,3 +145,122 @@ TEST(StationFromJsonTest, HandlesStatusNotArray) {
 
   EXPECT_EQ(s.getRLOIid(), "10427"); // Fallback to first
 }
+
+TEST(StationFromOnDemandTest, MatchesFromJson) {
+  simdjson::padded_string jsonStr = R"({
+    "RLOIid": "id",
+    "catchmentName": "name",
+    "dateOpened": "date",
+    "label": "l",
+    "lat": 51.874767,
+    "long": -1.740083,
+    "northing": 219610,
+    "easting": 528000,
+    "notation": "n",
+    "town": "t",
+    "riverName": "r",
+    "status": "url/statusActive"
+  })"_padded;
+
+  simdjson::ondemand::parser parser;
+  simdjson::ondemand::document doc;
+  ASSERT_EQ(parser.iterate(jsonStr).get(doc), simdjson::SUCCESS);
+
+  Station m = Station::fromOnDemand(doc.get_object());
+
+  EXPECT_EQ(m.getRLOIid(), "id");
+  EXPECT_EQ(m.getCatchmentName(), "name");
+  EXPECT_EQ(m.getDateOpened(), "date");
+  EXPECT_EQ(m.getLabel(), "l");
+  EXPECT_EQ(m.getLat(), 51.874767);
+  EXPECT_EQ(m.getLon(), -1.740083);
+  EXPECT_EQ(m.getNorthing(), 219610);
+  EXPECT_EQ(m.getEasting(), 528000);
+  EXPECT_EQ(m.getNotation(), "n");
+  EXPECT_EQ(m.getTown(), "t");
+  EXPECT_EQ(m.getRiverName(), "r");
+}
+
+TEST(StationFromOnDemandTest, DefaultsWhenFieldsMissing) {
+  simdjson::padded_string jsonStr = "{}"_padded;
+
+  simdjson::ondemand::parser parser;
+  simdjson::ondemand::document doc;
+  ASSERT_EQ(parser.iterate(jsonStr).get(doc), simdjson::SUCCESS);
+
+  Station m = Station::fromOnDemand(doc.get_object());
+
+  EXPECT_EQ(m.getRLOIid(), "unknown");
+  EXPECT_EQ(m.getLabel(), "unknown");
+  EXPECT_EQ(m.getLat(), 0.0);
+  EXPECT_EQ(m.getNorthing(), 0);
+  EXPECT_EQ(m.getNotation(), "unknown");
+  EXPECT_EQ(m.getRiverName(), "unknown");
+}
+
+TEST(StationFromOnDemandTest, ResolvesArrayFieldsAgainstLaterStatus) {
+  // Status comes after the arrays it selects from
+  simdjson::padded_string jsonStr = R"({
+    "RLOIid": ["10427", "9154"],
+    "lat": [51.5, 52.5],
+    "northing": [100000, 200000],
+    "label": "Erith Deep Wharf",
+    "status": ["url/statusSuspended", "url/statusActive"]
+  })"_padded;
+
+  simdjson::ondemand::parser parser;
+  simdjson::ondemand::document doc;
+  ASSERT_EQ(parser.iterate(jsonStr).get(doc), simdjson::SUCCESS);
+
+  Station s = Station::fromOnDemand(doc.get_object());
+
+  EXPECT_EQ(s.getRLOIid(), "9154");
+  EXPECT_EQ(s.getLat(), 52.5);
+  EXPECT_EQ(s.getNorthing(), 200000);
+  EXPECT_EQ(s.getLabel(), "Erith Deep Wharf");
+}
+
+TEST(StationFromOnDemandTest, ThrowsOnWrongTypeLikeFromJson) {
+  simdjson::padded_string scalar = R"({"lat": "51.5"})"_padded;
+  simdjson::padded_string element =
+      R"({"lat": [51.5, "52.5"], "status": ["a", "statusActive"]})"_padded;
+
+  simdjson::ondemand::parser parser;
+  simdjson::ondemand::document doc;
+  ASSERT_EQ(parser.iterate(scalar).get(doc), simdjson::SUCCESS);
+  EXPECT_THROW(Station::fromOnDemand(doc.get_object()), std::runtime_error);
+
+  ASSERT_EQ(parser.iterate(element).get(doc), simdjson::SUCCESS);
+  EXPECT_THROW(Station::fromOnDemand(doc.get_object()), std::runtime_error);
+}
+
+TEST(StationFromOnDemandTest, KeepsFirstOfRepeatedKeyLikeFromJson) {
+  simdjson::padded_string jsonStr = R"({
+    "label": "first",
+    "lat": 51.5,
+    "town": "Reading",
+    "status": ["url/statusActive", "url/statusSuspended"],
+    "RLOIid": ["10427", "9154"],
+    "label": "second",
+    "lat": "not a number",
+    "town": "Oxford",
+    "status": ["url/statusSuspended", "url/statusActive"]
+  })"_padded;
+
+  simdjson::dom::parser domParser;
+  simdjson::dom::element element;
+  ASSERT_EQ(domParser.parse(jsonStr).get(element), simdjson::SUCCESS);
+  Station fromDom = Station::fromJson(element);
+
+  simdjson::ondemand::parser parser;
+  simdjson::ondemand::document doc;
+  ASSERT_EQ(parser.iterate(jsonStr).get(doc), simdjson::SUCCESS);
+  Station fromOnDemand = Station::fromOnDemand(doc.get_object());
+
+  EXPECT_EQ(fromDom.getLabel(), "first");
+  EXPECT_EQ(fromDom.getRLOIid(), "10427");
+  EXPECT_EQ(fromOnDemand.getLabel(), fromDom.getLabel());
+  EXPECT_EQ(fromOnDemand.getLat(), fromDom.getLat());
+  EXPECT_EQ(fromOnDemand.getTown(), fromDom.getTown());
+  EXPECT_EQ(fromOnDemand.getRLOIid(), fromDom.getRLOIid());
+}
@@ -0,0 +1,59 @@
+// tests/cpp/unit/StringPoolTest.cpp
+#include "StringPool.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(StringPoolTest, EqualValuesShareOneEntry) {
+  StringPool pool;
+  const StringPool::Entry* first = pool.intern("River Thames");
+  const StringPool::Entry* second = pool.intern(std::string("River ") + "Thames");
+  const StringPool::Entry* other = pool.intern("River Kennet");
+
+  EXPECT_EQ(first, second);
+  EXPECT_NE(first, other);
+  EXPECT_EQ(first->value, "River Thames");
+  EXPECT_NE(first->id, other->id);
+  EXPECT_EQ(pool.size(), 3); // Including ""
+  EXPECT_EQ(pool.intern(""), pool.empty());
+  EXPECT_EQ(pool.empty()->id, 0);
+}
+
+TEST(StringPoolTest, InternedStringsCompareByIdentity) {
+  InternedString a("Berkshire");
+  InternedString b(std::string("Berk") + "shire");
+  InternedString c("Oxfordshire");
+
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+  EXPECT_EQ(a.id(), b.id());
+  EXPECT_EQ(a, "Berkshire");
+  EXPECT_NE(a, "Oxfordshire");
+
+  const std::string& asString = a;
+  EXPECT_EQ(asString, "Berkshire");
+  EXPECT_TRUE(InternedString().empty());
+  EXPECT_EQ(sizeof(InternedString), sizeof(void*));
+}
+
+TEST(StringPoolTest, ConcurrentInternsAgree) {
+  StringPool pool;
+  std::vector<std::vector<const StringPool::Entry*>> seen(4);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < seen.size(); ++t) {
+    threads.emplace_back([&pool, &seen, t]() {
+      for (int i = 0; i < 500; ++i) {
+        seen[t].push_back(pool.intern("value " + std::to_string(i % 50)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(pool.size(), 51);
+  for (size_t t = 1; t < seen.size(); ++t) {
+    EXPECT_EQ(seen[t], seen[0]);
+  }
+}
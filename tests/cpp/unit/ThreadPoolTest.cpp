@@ -0,0 +1,57 @@
+// tests/cpp/unit/ThreadPoolTest.cpp
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+TEST(ThreadPoolTest, SubmitReturnsResult) {
+  ThreadPool pool(2);
+  auto answer = pool.submit([]() { return 42; });
+  EXPECT_EQ(answer.get(), 42);
+
+  auto failure = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+  EXPECT_THROW(failure.get(), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, ParallelForCoversEveryIndexOnce) {
+  ThreadPool pool(4);
+  std::vector<int> hits(1000, 0);
+  pool.parallelFor(hits.size(), 7, [&hits](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      hits[i]++;
+    }
+  });
+
+  for (int hit : hits) {
+    EXPECT_EQ(hit, 1);
+  }
+}
+
+TEST(ThreadPoolTest, ParallelForHandlesEmptyAndSingleChunkRanges) {
+  ThreadPool pool(2);
+  int calls = 0;
+  pool.parallelFor(0, 16, [&calls](size_t, size_t) { calls++; });
+  EXPECT_EQ(calls, 0);
+
+  pool.parallelFor(5, 16, [&calls](size_t begin, size_t end) {
+    EXPECT_EQ(begin, 0);
+    EXPECT_EQ(end, 5);
+    calls++;
+  });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ThreadPoolTest, ParallelForRethrowsAfterAllChunksFinish) {
+  ThreadPool pool(3);
+  std::atomic<size_t> done{0};
+  EXPECT_THROW(pool.parallelFor(100, 10,
+                                [&done](size_t begin, size_t /*end*/) {
+                                  if (begin == 50) {
+                                    throw std::runtime_error("bad chunk");
+                                  }
+                                  done++;
+                                }),
+               std::runtime_error);
+  EXPECT_EQ(done.load(), 9);
+}
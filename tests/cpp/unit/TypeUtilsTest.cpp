@@ -0,0 +1,93 @@
+// tests/cpp/unit/TypeUtilsTest.cpp
+#include "TypeUtils.hpp"
+#include <gtest/gtest.h>
+#include <simdjson.h>
+
+namespace {
+
+struct Record {
+    std::string name;
+    double value = 0.0;
+    int level = 0;
+    int64_t code = 0;
+    std::string inner = "untouched";
+};
+
+const FieldSchema<Record> RECORD_SCHEMA(
+    {
+        {"name", &Record::name, "none", true},
+        {"value", &Record::value, -1.0, true},
+        {"level", &Record::level, 7},
+        {"code", &Record::code, int64_t(9)},
+        {"inner", &Record::inner, "missing", false, "outer"},
+    },
+    "status");
+
+ParseError extract(const std::string& json, Record& record) {
+  simdjson::dom::parser parser;
+  simdjson::dom::element doc;
+  EXPECT_EQ(parser.parse(json).get(doc), simdjson::SUCCESS);
+  return RECORD_SCHEMA.extract(doc, record);
+}
+
+Record extract(const std::string& json) {
+  Record record;
+  EXPECT_EQ(extract(json, record), ParseError::NONE);
+  return record;
+}
+
+} // namespace
+
+TEST(FieldSchemaTest, AppliesDefaultsForMissingFields) {
+  Record record = extract("{}");
+  EXPECT_EQ(record.name, "none");
+  EXPECT_EQ(record.value, -1.0);
+  EXPECT_EQ(record.level, 7);
+  EXPECT_EQ(record.code, 9);
+  EXPECT_EQ(record.inner, "untouched"); // No "outer" object, so no default either
+}
+
+TEST(FieldSchemaTest, ResolvesActiveIndexRegardlessOfKeyOrder) {
+  Record record = extract(R"({
+    "name": ["old", "new"],
+    "value": [1.5, 2.5],
+    "level": 3,
+    "status": ["x/statusClosed", "x/statusActive"]
+  })");
+  EXPECT_EQ(record.name, "new");
+  EXPECT_EQ(record.value, 2.5);
+  EXPECT_EQ(record.level, 3);
+}
+
+TEST(FieldSchemaTest, ReadsNestedFieldsOnlyFromTheirParent) {
+  Record withInner = extract(R"({"inner": "top", "outer": {"inner": "nested"}})");
+  EXPECT_EQ(withInner.inner, "nested");
+
+  Record emptyOuter = extract(R"({"outer": {}})");
+  EXPECT_EQ(emptyOuter.inner, "missing");
+
+  Record scalarOuter = extract(R"({"outer": 5})");
+  EXPECT_EQ(scalarOuter.inner, "missing");
+}
+
+TEST(FieldSchemaTest, FirstOccurrenceOfAKeyWins) {
+  Record record = extract(R"({"level": 1, "level": 2})");
+  EXPECT_EQ(record.level, 1);
+}
+
+TEST(FieldSchemaTest, ReportsWrongTypes) {
+  Record record;
+  EXPECT_EQ(extract(R"({"level": "high"})", record), ParseError::WRONG_TYPE);
+  EXPECT_EQ(extract(R"({"code": [1]})", record), ParseError::WRONG_TYPE); // Not an active field
+  EXPECT_EQ(extract(R"({"name": [1, 2]})", record), ParseError::BAD_ELEMENT);
+  EXPECT_EQ(extract(R"({"name": ["a"], "status": ["x", "statusActive"]})", record),
+            ParseError::BAD_ELEMENT);
+  // Only the chosen element of an active array has to be well typed
+  EXPECT_EQ(extract(R"({"name": ["a", 2]})").name, "a");
+}
+
+TEST(FieldSchemaTest, RejectsMismatchedDefaults) {
+  EXPECT_THROW(FieldSchema<Record>({{"name", &Record::name, 1.0}}), std::logic_error);
+  EXPECT_THROW(FieldSchema<Record>({{"name", &Record::name, ""}, {"name", &Record::name, ""}}),
+               std::logic_error);
+}
@@ -6,8 +6,39 @@
 #include <QGeoCoordinate>
 #include <QSignalSpy>
 #include <QTest>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <memory>
 #include <simdjson.h>
 
+namespace {
+
+// Holds the warnings fetch until released, like a stalled network
+class StalledHttpClient : public MockHttpClient {
+  public:
+    FetchResult fetchUrlIfModified(const std::string& url) override {
+      entered = true;
+      released_.wait();
+      FetchResult result = MockHttpClient::fetchUrlIfModified(url);
+      returned = true;
+      return result;
+    }
+
+    void release() {
+      release_.set_value();
+    }
+
+    std::atomic<bool> entered{false};
+    std::atomic<bool> returned{false};
+
+  private:
+    std::promise<void> release_;
+    std::shared_future<void> released_ = release_.get_future().share();
+};
+
+} // namespace
+
 class WarningModelTest : public QObject {
     Q_OBJECT
 
@@ -21,15 +52,22 @@ class WarningModelTest : public QObject {
     static void testSortsBySeverityLevel();
     static void testGetPolygonPath();
     static void testGetPolygonPathEmpty();
+    static void testPolygonPathFollowsZoomLevel();
+    static void testPrepareSnapshotReusesConvertedGeometry();
+    static void testAreaMeshesArriveWithTheRows();
+    static void testApplyTimeIsRecordedAgainstTheBudget();
     static void testUpdateWarningsWithNewData();
     static void testUpdateWarningsWithIdenticalData();
     static void testUpdateWarningsWithDifferentSize();
+    static void testUpdateWarningsMovesKeptRows();
     static void testCalculateNextUpdateMs();
     static void testStartAutoUpdate();
     static void testStopAutoUpdate();
     static void testFetchWarningsSuccess();
     static void testFetchWarningsHttpFailure();
+    static void testDestroyingTheModelDoesNotWaitForARefresh();
     static void testFetchWarningsInvalidJson();
+    static void testFetchWarningsNotModified();
 };
 
 void WarningModelTest::testRowCount() {
@@ -195,6 +233,134 @@ void WarningModelTest::testGetPolygonPathEmpty() {
   QVERIFY(path.isEmpty());
 }
 
+void WarningModelTest::testPolygonPathFollowsZoomLevel() {
+  std::string jsonStr = R"({"floodAreaID": "test", "severityLevel": 1})";
+  simdjson::dom::parser parser;
+  simdjson::dom::element w;
+  QVERIFY(parser.parse(jsonStr).get(w) == 0U);
+  auto warning = Warning::fromJson(w);
+
+  // A dense circle about 10 km across, far more detail than national zoom can show
+  LinearRing ring;
+  for (int i = 0; i < 2000; ++i) {
+    double angle = 2.0 * M_PI * i / 2000.0;
+    ring.emplace_back(-1.5 + (0.07 * std::cos(angle)), 52.5 + (0.045 * std::sin(angle)));
+  }
+  ring.push_back(ring.front());
+  warning.setFloodAreaPolygon(MultiPolygon{{ring}});
+  warning.buildPolygonLod();
+
+  WarningModel model({warning});
+  QSignalSpy spy(&model, &WarningModel::dataChanged);
+  auto pathRole = static_cast<int>(WarningModel::WarningRoles::POLYGON_PATH_ROLE);
+
+  auto national = model.data(model.index(0, 0), pathRole).toList();
+  model.setZoomLevel(6.5); // Same level, rows untouched
+  QCOMPARE(spy.count(), 0);
+
+  model.setZoomLevel(15);
+  QCOMPARE(spy.count(), 1);
+  auto street = model.data(model.index(0, 0), pathRole).toList();
+  QVERIFY(national.size() >= 4);
+  QVERIFY(national.size() < street.size());
+  QVERIFY(street.size() <= static_cast<qsizetype>(ring.size()));
+}
+
+void WarningModelTest::testPrepareSnapshotReusesConvertedGeometry() {
+  std::string jsonStr = R"({"floodAreaID": "test", "severityLevel": 1})";
+  simdjson::dom::parser parser;
+  simdjson::dom::element w;
+  QVERIFY(parser.parse(jsonStr).get(w) == 0U);
+  auto warning = Warning::fromJson(w);
+  MultiPolygon mp = {{{{0.0, 51.0}, {1.0, 51.0}, {1.0, 52.0}, {0.0, 51.0}}}};
+  warning.setFloodAreaPolygon(mp);
+
+  WarningModel model({warning});
+  const QVariantList& path = model.m_polygonValues[0].paths[0];
+
+  // The same shared geometry keeps its converted lists
+  auto same = WarningModel::prepareSnapshot({warning}, model.m_polygonValues);
+  QCOMPARE(same.polygonValues[0].paths[0].constData(), path.constData());
+
+  // Equal coordinates decoded afresh are another polygon, and are converted again
+  auto redecoded = warning;
+  redecoded.setFloodAreaPolygon(mp);
+  auto fresh = WarningModel::prepareSnapshot({redecoded}, model.m_polygonValues);
+  QVERIFY(fresh.polygonValues[0].paths[0].constData() != path.constData());
+  QCOMPARE(fresh.polygonValues[0].paths[0], path);
+
+  // So is geometry whose levels of detail have been built since
+  auto simplified = warning;
+  simplified.buildPolygonLod();
+  auto rebuilt = WarningModel::prepareSnapshot({simplified}, model.m_polygonValues);
+  QVERIFY(rebuilt.polygonValues[0].paths[0].constData() != path.constData());
+}
+
+void WarningModelTest::testAreaMeshesArriveWithTheRows() {
+  simdjson::dom::parser parser;
+  simdjson::dom::element w1;
+  QVERIFY(parser.parse(std::string(R"({"floodAreaID": "a", "severityLevel": 1})")).get(w1) == 0U);
+  auto drawn = Warning::fromJson(w1);
+  MultiPolygon mp = {{{{0.0, 51.0}, {1.0, 51.0}, {1.0, 52.0}, {0.0, 51.0}}}};
+  drawn.setFloodAreaPolygon(mp);
+  simdjson::dom::element w2;
+  QVERIFY(parser.parse(std::string(R"({"floodAreaID": "b", "severityLevel": 2})")).get(w2) == 0U);
+  auto unmapped = Warning::fromJson(w2);
+
+  WarningModel model({drawn, unmapped});
+  QSignalSpy appliedSpy(&model, &WarningModel::warningsApplied);
+  auto mesh = model.getAreaMesh(0);
+  QVERIFY(mesh != nullptr);
+  QCOMPARE(mesh->level(0).triangles.size(), size_t{3});
+  QVERIFY(model.getAreaMesh(1) == nullptr);
+
+  // A refresh with the same geometry hands views the mesh they already have, in one signal
+  model.updateWarnings({unmapped, drawn});
+  QCOMPARE(appliedSpy.count(), 1);
+  QVERIFY(model.getAreaMesh(0) == mesh);
+}
+
+void WarningModelTest::testApplyTimeIsRecordedAgainstTheBudget() {
+  // A nationwide refresh's worth of warnings, each with its own area
+  auto makeWarnings = [](int severityShift) {
+    std::vector<Warning> warnings;
+    simdjson::dom::parser parser;
+    for (int i = 0; i < 2000; ++i) {
+      std::string json = R"({"floodAreaID": ")" + std::to_string(i) + R"(", "severityLevel": )" +
+                         std::to_string(((i + severityShift) % 4) + 1) + "}";
+      simdjson::dom::element w;
+      if (parser.parse(json).get(w) != 0U) {
+        return std::vector<Warning>{};
+      }
+      auto warning = Warning::fromJson(w);
+      double x = i * 0.001;
+      MultiPolygon mp = {{{{x, 51.0}, {x + 0.001, 51.0}, {x + 0.001, 51.001}, {x, 51.0}}}};
+      warning.setFloodAreaPolygon(mp);
+      warnings.push_back(std::move(warning));
+    }
+    return warnings;
+  };
+
+  WarningModel model({});
+  QSignalSpy timeSpy(&model, &WarningModel::applyTimeChanged);
+  // Nothing fits a zero budget, so the overrun is counted deterministically
+  model.setApplyBudget(std::chrono::microseconds(0));
+  model.finishRefresh(WarningModel::prepareSnapshot(makeWarnings(0)));
+
+  QCOMPARE(model.rowCount(), 2000);
+  QCOMPARE(timeSpy.count(), 1);
+  QVERIFY(model.getLastApplyTime() > std::chrono::microseconds(0));
+  QCOMPARE(model.property("lastApplyMs").toDouble(), model.getLastApplyMs());
+  QCOMPARE(model.property("applyBudgetOverruns").toInt(), 1);
+
+  // Every severity changing moves and updates every row, still only bookkeeping on the GUI thread
+  model.setApplyBudget(std::chrono::seconds(1));
+  model.finishRefresh(WarningModel::prepareSnapshot(makeWarnings(1), model.m_polygonValues));
+  QCOMPARE(timeSpy.count(), 2);
+  QVERIFY(model.getLastApplyTime() < std::chrono::seconds(1));
+  QCOMPARE(model.getApplyBudgetOverruns(), 1);
+}
+
 void WarningModelTest::testUpdateWarningsWithNewData() {
   simdjson::dom::parser parser;
   simdjson::dom::element w1;
@@ -244,6 +410,8 @@ void WarningModelTest::testUpdateWarningsWithDifferentSize() {
 
   WarningModel model({Warning::fromJson(w1)});
   QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+  QSignalSpy removedSpy(&model, &QAbstractItemModel::rowsRemoved);
+  QSignalSpy insertedSpy(&model, &QAbstractItemModel::rowsInserted);
 
   simdjson::dom::element w2;
   simdjson::dom::element w3;
@@ -256,7 +424,54 @@ void WarningModelTest::testUpdateWarningsWithDifferentSize() {
   model.updateWarnings({Warning::fromJson(w2), Warning::fromJson(w3)});
 
   QCOMPARE(model.rowCount(), 2);
-  QCOMPARE(resetSpy.count(), 1);
+  QCOMPARE(resetSpy.count(), 0);
+  QCOMPARE(removedSpy.count(), 1);
+  // Both new rows arrive as one run
+  QCOMPARE(insertedSpy.count(), 1);
+  QCOMPARE(insertedSpy.at(0).at(1).toInt(), 0);
+  QCOMPARE(insertedSpy.at(0).at(2).toInt(), 1);
+  QCOMPARE(model.getWarnings()[0].getId(), std::string("2"));
+  QCOMPARE(model.getWarnings()[1].getId(), std::string("3"));
+}
+
+void WarningModelTest::testUpdateWarningsMovesKeptRows() {
+  simdjson::dom::parser parser;
+  // Described by their own id
+  auto warning = [&parser](const std::string& id, int severityLevel) {
+    std::string json = R"({"floodAreaID": ")" + id + R"(", "description": ")" + id +
+                       R"(", "severityLevel": )" + std::to_string(severityLevel) + "}";
+    simdjson::dom::element element;
+    auto error = parser.parse(json).get(element);
+    return error == 0U ? Warning::fromJson(element) : Warning();
+  };
+
+  WarningModel model({warning("a", 2), warning("b", 2), warning("c", 3)});
+  QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+  QSignalSpy removedSpy(&model, &QAbstractItemModel::rowsRemoved);
+  QSignalSpy insertedSpy(&model, &QAbstractItemModel::rowsInserted);
+  QSignalSpy movedSpy(&model, &QAbstractItemModel::rowsMoved);
+  QSignalSpy dataChangedSpy(&model, &QAbstractItemModel::dataChanged);
+
+  // b is gone, c becomes the most severe and d is new, a is left as it was
+  model.updateWarnings({warning("d", 3), warning("a", 2), warning("c", 1)});
+
+  QCOMPARE(resetSpy.count(), 0);
+  QCOMPARE(removedSpy.count(), 1);
+  QCOMPARE(removedSpy.at(0).at(1).toInt(), 1);
+  QCOMPARE(movedSpy.count(), 1);
+  QCOMPARE(insertedSpy.count(), 1);
+  QCOMPARE(insertedSpy.at(0).at(1).toInt(), 2);
+
+  QCOMPARE(model.rowCount(), 3);
+  QCOMPARE(model.data(model.index(0, 0), Qt::UserRole + 1).toString(), QString("c"));
+  QCOMPARE(model.data(model.index(1, 0), Qt::UserRole + 1).toString(), QString("a"));
+  QCOMPARE(model.data(model.index(2, 0), Qt::UserRole + 1).toString(), QString("d"));
+
+  // Only c changed, and only its severity level
+  QCOMPARE(dataChangedSpy.count(), 1);
+  QCOMPARE(dataChangedSpy.at(0).at(0).value<QModelIndex>().row(), 0);
+  auto roles = dataChangedSpy.at(0).at(2).value<QList<int>>();
+  QCOMPARE(roles, QList<int>{Qt::UserRole + 3});
 }
 
 void WarningModelTest::testCalculateNextUpdateMs() {
@@ -336,11 +551,17 @@ void WarningModelTest::testFetchWarningsSuccess() {
 
   QSignalSpy updateSpy(&model, &WarningModel::warningsUpdated);
 
-  // Trigger fetch
+  // Trigger fetch, it runs on the worker and nothing changes until the event loop delivers it
   model.fetchWarnings();
+  QVERIFY(model.isRefreshing());
+  QCOMPARE(updateSpy.count(), 0);
+  QCOMPARE(model.data(model.index(0, 0), Qt::UserRole + 1).toString(), QString("unknown"));
 
   // Verify update signal was emitted
-  QCOMPARE(updateSpy.count(), 1);
+  QTRY_COMPARE(updateSpy.count(), 1);
+  QVERIFY(!model.isRefreshing());
+  // Auto-update was never started, so no next fetch is scheduled
+  QVERIFY(!model.findChild<QTimer*>()->isActive());
   QCOMPARE(updateSpy.at(0).at(0).toInt(), 1); // 1 warning
 
   // Verify model updated
@@ -373,6 +594,7 @@ void WarningModelTest::testFetchWarningsHttpFailure() {
   }
 
   // Should not emit update signal
+  QTRY_VERIFY(!model.isRefreshing());
   QCOMPARE(updateSpy.count(), 0);
 
   // Original data should remain
@@ -381,6 +603,27 @@ void WarningModelTest::testFetchWarningsHttpFailure() {
   HttpClient::setInstance(nullptr);
 }
 
+void WarningModelTest::testDestroyingTheModelDoesNotWaitForARefresh() {
+  // Outlives the test, the stalled worker is still inside it when the model goes
+  static StalledHttpClient stalledClient;
+  HttpClient::setInstance(&stalledClient);
+
+  auto model = std::make_unique<WarningModel>(std::vector<Warning>{});
+  model->fetchWarnings();
+  QTRY_VERIFY(stalledClient.entered);
+
+  auto start = std::chrono::steady_clock::now();
+  model.reset();
+  QVERIFY(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+
+  // The worker finds the refresh cancelled and drops it without touching the model
+  stalledClient.release();
+  QTRY_VERIFY(stalledClient.returned);
+  QTest::qWait(20);
+
+  HttpClient::setInstance(nullptr);
+}
+
 void WarningModelTest::testFetchWarningsInvalidJson() {
   MockHttpClient mockClient;
   HttpClient::setInstance(&mockClient);
@@ -406,11 +649,40 @@ void WarningModelTest::testFetchWarningsInvalidJson() {
   }
 
   // Should not update on parse error
+  QTRY_VERIFY(!model.isRefreshing());
   QCOMPARE(updateSpy.count(), 0);
   QCOMPARE(model.rowCount(), 1);
 
   HttpClient::setInstance(nullptr);
 }
 
+void WarningModelTest::testFetchWarningsNotModified() {
+  MockHttpClient mockClient;
+  HttpClient::setInstance(&mockClient);
+
+  mockClient.setNotModified("https://environment.data.gov.uk/flood-monitoring/id/floods");
+
+  simdjson::dom::parser parser;
+  simdjson::dom::element w;
+  std::string json = R"({"floodAreaID": "1", "description": "Kept", "severityLevel": 2})";
+  auto error = parser.parse(json).get(w);
+  QVERIFY(error == 0U);
+
+  WarningModel model({Warning::fromJson(w)});
+  QSignalSpy updateSpy(&model, &WarningModel::warningsUpdated);
+  QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+  model.fetchWarnings();
+  QTRY_VERIFY(!model.isRefreshing());
+
+  // A 304 skips parsing and leaves the model untouched
+  QCOMPARE(updateSpy.count(), 0);
+  QCOMPARE(resetSpy.count(), 0);
+  QCOMPARE(model.rowCount(), 1);
+  QCOMPARE(model.data(model.index(0, 0), Qt::UserRole + 1).toString(), QString("Kept"));
+
+  HttpClient::setInstance(nullptr);
+}
+
 QTEST_MAIN(WarningModelTest)
 #include "WarningModelTest.moc"
\ No newline at end of file